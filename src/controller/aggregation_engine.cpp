@@ -0,0 +1,137 @@
+#include "aggregation_engine.h"
+#include "../domain/artifact_schema.h"
+#include <QHash>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Counts of one worker, merged into the Aggregation at the end
+struct PartialAggregation {
+    size_t rows = 0;
+    std::array<QHash<QString, size_t>, ArtifactFieldCount> values;
+    QHash<int, size_t> buckets;
+    size_t undated = 0;
+    qint32 firstDay = std::numeric_limits<qint32>::max();
+    qint32 lastDay = std::numeric_limits<qint32>::min();
+};
+
+} // namespace
+
+AggregationEngine::AggregationEngine(const ArtifactTable& table) : m_table(table) {
+}
+
+int AggregationEngine::bucketOf(qint32 julianDay, DateBucket bucket) {
+    int year = QDate::fromJulianDay(julianDay).year();
+    if (bucket == DateBucket::Year) {
+        return year;
+    }
+    return (year >= 0 ? year : year - 9) / 10 * 10; // Rounded down, also before the common era
+}
+
+Aggregation AggregationEngine::aggregate(const RowBitmap& rows, const AggregationRequest& request,
+                                         FilterExecution execution) const {
+    // The getters of the grouped text fields, looked up once instead of per row
+    std::vector<std::pair<size_t, ArtifactSchema::TextGetter>> textFields;
+    for (size_t field = 0; field < ArtifactFieldCount; ++field) {
+        ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(static_cast<ArtifactField>(field));
+        if (getter && (request.groupBy & fieldBit(static_cast<ArtifactField>(field)))) {
+            textFields.emplace_back(field, getter);
+        }
+    }
+    const bool byDate = request.groupBy & fieldBit(ArtifactField::DiscoveryDate);
+    const std::vector<qint32>& days = m_table.julianDays();
+    const std::vector<ArcheologicalArtifact>& artifacts = m_table.artifacts();
+
+    auto accumulate = [&](size_t firstWord, size_t lastWord, PartialAggregation& partial) {
+        const quint64* words = rows.words();
+        for (size_t word = firstWord; word < lastWord; ++word) {
+            for (quint64 bits = words[word]; bits; bits &= bits - 1) {
+                const size_t row = word * 64 + qCountTrailingZeroBits(bits);
+                ++partial.rows;
+                for (const auto& [field, getter] : textFields) {
+                    ++partial.values[field][(artifacts[row].*getter)()];
+                }
+                const qint32 day = days[row];
+                if (day == ArtifactTable::InvalidJulianDay) {
+                    ++partial.undated;
+                    continue;
+                }
+                partial.firstDay = std::min(partial.firstDay, day);
+                partial.lastDay = std::max(partial.lastDay, day);
+                if (byDate) {
+                    ++partial.buckets[bucketOf(day, request.dateBucket)];
+                }
+            }
+        }
+    };
+
+    // One run of whole words per worker, each with its own partial tables
+    QThreadPool* pool = QThreadPool::globalInstance();
+    size_t workers = 1;
+    if (execution == FilterExecution::Parallel) {
+        workers = std::max<size_t>(1, std::min(static_cast<size_t>(std::max(1, pool->maxThreadCount())),
+                                               rows.size() / MinimumChunk));
+    }
+    const size_t wordsPerWorker = (rows.wordCount() + workers - 1) / std::max<size_t>(1, workers);
+    std::vector<PartialAggregation> partials(workers);
+    auto run = [&](size_t worker) {
+        const size_t first = worker * wordsPerWorker;
+        accumulate(first, std::min(rows.wordCount(), first + wordsPerWorker), partials[worker]);
+    };
+    // The calling thread takes the first run instead of idling until the pool is done
+    QSemaphore finished;
+    for (size_t worker = 1; worker < workers; ++worker) {
+        pool->start([&run, &finished, worker]() {
+            run(worker);
+            finished.release();
+        });
+    }
+    run(0);
+    finished.acquire(static_cast<int>(workers - 1));
+
+    // Merge into the first partial, then order the groups
+    PartialAggregation& total = partials.front();
+    for (size_t worker = 1; worker < workers; ++worker) {
+        const PartialAggregation& partial = partials[worker];
+        total.rows += partial.rows;
+        total.undated += partial.undated;
+        total.firstDay = std::min(total.firstDay, partial.firstDay);
+        total.lastDay = std::max(total.lastDay, partial.lastDay);
+        for (const auto& field : textFields) {
+            QHash<QString, size_t>& merged = total.values[field.first];
+            for (auto it = partial.values[field.first].constBegin(); it != partial.values[field.first].constEnd(); ++it) {
+                merged[it.key()] += it.value();
+            }
+        }
+        for (auto it = partial.buckets.constBegin(); it != partial.buckets.constEnd(); ++it) {
+            total.buckets[it.key()] += it.value();
+        }
+    }
+
+    Aggregation result;
+    result.rows = total.rows;
+    result.undated = total.undated;
+    if (total.firstDay <= total.lastDay) {
+        result.earliest = QDate::fromJulianDay(total.firstDay);
+        result.latest = QDate::fromJulianDay(total.lastDay);
+    }
+    for (const auto& field : textFields) {
+        std::vector<std::pair<QString, size_t>>& counts = result.valueCounts[field.first];
+        const QHash<QString, size_t>& values = total.values[field.first];
+        counts.reserve(static_cast<size_t>(values.size()));
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+            counts.emplace_back(it.key(), it.value());
+        }
+        std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    }
+    for (auto it = total.buckets.constBegin(); it != total.buckets.constEnd(); ++it) {
+        result.dateCounts.emplace_back(it.key(), it.value());
+    }
+    std::sort(result.dateCounts.begin(), result.dateCounts.end());
+    return result;
+}
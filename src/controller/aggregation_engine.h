@@ -0,0 +1,59 @@
+#ifndef AGGREGATION_ENGINE_H
+#define AGGREGATION_ENGINE_H
+
+#include "filter.h"
+#include "../index/artifact_table.h"
+#include "../index/row_bitmap.h"
+#include <QDate>
+#include <QString>
+#include <array>
+#include <utility>
+#include <vector>
+
+enum class DateBucket {
+    Year,
+    Decade
+};
+
+// What to group the rows by: any text fields, and the discovery date by bucket
+struct AggregationRequest {
+    ArtifactFieldMask groupBy = fieldBit(ArtifactField::Material) | fieldBit(ArtifactField::Location) |
+                                fieldBit(ArtifactField::DiscoveryDate);
+    DateBucket dateBucket = DateBucket::Decade;
+};
+
+// Group-by counts over a set of rows. The date range covers all rows, grouped by date or not.
+struct Aggregation {
+    size_t rows = 0;
+    // Per grouped text field, indexed by ArtifactField: most frequent value first, ties by value
+    std::array<std::vector<std::pair<QString, size_t>>, ArtifactFieldCount> valueCounts;
+    std::vector<std::pair<int, size_t>> dateCounts; // First year of each bucket, ascending
+    size_t undated = 0;                             // Rows left out of dateCounts
+    QDate earliest; // Invalid when no row has a date
+    QDate latest;
+
+    const std::vector<std::pair<QString, size_t>>& counts(ArtifactField field) const {
+        return valueCounts[static_cast<size_t>(field)];
+    }
+};
+
+// Computes every group-by of a request in one pass over the rows. In parallel, each worker
+// of QThreadPool::globalInstance() fills its own partial tables for a run of whole bitmap
+// words; the partials are merged once all are done, so workers never share a table.
+class AggregationEngine {
+public:
+    static constexpr size_t MinimumChunk = 4096; // Rows per worker below which one thread does it all
+
+    explicit AggregationEngine(const ArtifactTable& table);
+
+    // rows must cover the table
+    Aggregation aggregate(const RowBitmap& rows, const AggregationRequest& request = AggregationRequest(),
+                          FilterExecution execution = FilterExecution::Parallel) const;
+    // First year of the bucket holding a valid day
+    static int bucketOf(qint32 julianDay, DateBucket bucket);
+
+private:
+    const ArtifactTable& m_table;
+};
+
+#endif // AGGREGATION_ENGINE_H
@@ -8,18 +8,24 @@ ArtifactController::ArtifactController(std::unique_ptr<Repository> repo)
         // Consider throwing a more specific exception or logging
         throw std::runtime_error("Repository provided to ArtifactController is null.");
     }
+    
+    m_table.rebuild(m_repository->getAllArtifacts(), searchIndexPath());
+    m_repository->addObserver(&m_table);
 }
 
-ArtifactController::~ArtifactController() = default; // Default destructor is fine with unique_ptr
+ArtifactController::~ArtifactController() {
+    m_repository->removeObserver(&m_table);
+}
 
 void ArtifactController::addArtifact(const QString& id, const QString& name, const QString& description,
-                                     const QString& material, const QDate& discoveryDate, const QString& location) {
+                                     const QString& material, const QDate& discoveryDate, const QString& location,
+                                     const GeoPoint& coordinates) {
     // Basic validation (can be expanded)
     if (id.isEmpty() || name.isEmpty()) {
         throw std::invalid_argument("Artifact ID and Name cannot be empty.");
     }
     
-    ArcheologicalArtifact artifact(id, name, description, material, discoveryDate, location);
+    ArcheologicalArtifact artifact(id, name, description, material, discoveryDate, location, coordinates);
     auto command = std::make_unique<AddArtifactCommand>(m_repository.get(), artifact);
     executeCommand(std::move(command));
 }
@@ -29,24 +35,30 @@ void ArtifactController::removeArtifact(const QString& artifactId) {
         throw std::invalid_argument("Artifact ID cannot be empty for removal.");
     }
     
-    auto command = std::make_unique<RemoveArtifactCommand>(m_repository.get(), artifactId);
+    ArtifactHandle handle = m_repository->handleForId(artifactId);
+    if (handle == InvalidArtifactHandle) {
+        throw std::runtime_error("Artifact with ID '" + artifactId.toStdString() + "' not found.");
+    }
+    
+    auto command = std::make_unique<RemoveArtifactCommand>(m_repository.get(), handle);
     executeCommand(std::move(command));
 }
 
 void ArtifactController::updateArtifact(const QString& originalId, const QString& newId, const QString& name, const QString& description,
-                                        const QString& material, const QDate& discoveryDate, const QString& location) {
+                                        const QString& material, const QDate& discoveryDate, const QString& location,
+                                        const GeoPoint& coordinates) {
     if (originalId.isEmpty() || newId.isEmpty() || name.isEmpty()) {
         throw std::invalid_argument("Artifact IDs and Name cannot be empty for update.");
     }
     
-    ArcheologicalArtifact updatedArtifact(newId, name, description, material, discoveryDate, location);
+    ArcheologicalArtifact updatedArtifact(newId, name, description, material, discoveryDate, location, coordinates);
     
     // Handle ID changes by removing old and adding new if IDs are different
     if (originalId != newId) {
         // For ID changes, we need to ensure the original artifact exists first
         m_repository->findArtifactById(originalId); // This will throw if not found
         removeArtifact(originalId);
-        addArtifact(newId, name, description, material, discoveryDate, location);
+        addArtifact(newId, name, description, material, discoveryDate, location, coordinates);
     } else {
         auto command = std::make_unique<UpdateArtifactCommand>(m_repository.get(), updatedArtifact);
         executeCommand(std::move(command));
@@ -60,45 +72,161 @@ ArcheologicalArtifact ArtifactController::getArtifactById(const QString& artifac
     return m_repository->findArtifactById(artifactId);
 }
 
+ArcheologicalArtifact ArtifactController::getArtifactByHandle(ArtifactHandle handle) const {
+    if (handle == InvalidArtifactHandle) {
+        throw std::invalid_argument("Artifact handle is invalid.");
+    }
+    return m_repository->findArtifactByHandle(handle);
+}
+
 std::vector<ArcheologicalArtifact> ArtifactController::getAllArtifacts() const {
     return m_repository->getAllArtifacts();
 }
 
+ArtifactHandle ArtifactController::handleForId(const QString& artifactId) const {
+    return m_repository->handleForId(artifactId);
+}
+
+QString ArtifactController::idForHandle(ArtifactHandle handle) const {
+    return m_repository->idForHandle(handle);
+}
+
 // Filtering functionality
-std::vector<ArcheologicalArtifact> ArtifactController::filterArtifacts(std::unique_ptr<FilterStrategy> filter) const {
-    ArtifactFilter artifactFilter(std::move(filter));
-    return artifactFilter.filter(getAllArtifacts());
+ArtifactResultSet ArtifactController::filterArtifacts(std::unique_ptr<FilterStrategy> filter,
+                                                     FilterExecution execution) const {
+    // Evaluate over the table's columns rather than a fresh copy of the repository
+    ArtifactFilter artifactFilter(std::move(filter), execution);
+    artifactFilter.setResultCache(&m_filterCache);
+    return ArtifactResultSet(m_table, artifactFilter.select(ArtifactBatch(m_table)));
+}
+
+ArtifactResultSet ArtifactController::filterArtifacts(std::unique_ptr<FilterStrategy> filter,
+                                                     const QueryOptions& options,
+                                                     FilterExecution execution) const {
+    ArtifactFilter artifactFilter(std::move(filter), execution);
+    artifactFilter.setResultCache(&m_filterCache);
+    RowBitmap rows = artifactFilter.select(ArtifactBatch(m_table));
+    m_sortOrders.sync(m_table);
+    std::vector<ArtifactHandle> handles;
+    for (size_t row : selectPage(m_table, rows, options, &m_sortOrders)) {
+        handles.push_back(m_table.handle(row));
+    }
+    return ArtifactResultSet(m_table, std::move(handles));
+}
+
+size_t ArtifactController::countArtifacts(std::unique_ptr<FilterStrategy> filter) const {
+    RoaringBitmap handles;
+    if (filter->selectIndexed(m_table, handles)) {
+        return handles.cardinality();
+    }
+    ArtifactBatch batch(m_table);
+    return QueryPlanner(m_table, &m_filterCache).plan(*filter).execute(batch, &m_filterCache).count();
+}
+
+Aggregation ArtifactController::aggregateArtifacts(std::unique_ptr<FilterStrategy> filter,
+                                                   const AggregationRequest& request,
+                                                   FilterExecution execution) const {
+    ArtifactFilter artifactFilter(std::move(filter), execution);
+    artifactFilter.setResultCache(&m_filterCache);
+    return AggregationEngine(m_table).aggregate(artifactFilter.select(ArtifactBatch(m_table)), request, execution);
+}
+
+QString ArtifactController::explainFilter(const FilterStrategy& filter) const {
+    return QueryPlanner(m_table, &m_filterCache).plan(filter).explain();
+}
+
+const FilterResultCache& ArtifactController::filterCache() const {
+    return m_filterCache;
+}
+
+void ArtifactController::setFoldedFields(ArtifactFieldMask fields) {
+    m_table.setFoldedFields(fields);
+}
+
+size_t ArtifactController::foldedColumnBytes() const {
+    return m_table.foldedColumnBytes();
+}
+
+std::unique_ptr<LiveView> ArtifactController::createLiveView() {
+    // Registered after m_table, so the table has applied each change when the view sees it
+    return std::make_unique<LiveView>(*m_repository, m_table, &m_filterCache);
 }
 
-std::vector<ArcheologicalArtifact> ArtifactController::filterArtifactsByName(const QString& name, bool caseSensitive) const {
+ArtifactResultSet ArtifactController::searchDescriptions(const QString& query, size_t limit) const {
+    std::vector<ArtifactHandle> handles;
+    for (const FullTextIndex::Hit& hit : DescriptionSearch(query).rank(m_table, limit)) {
+        handles.push_back(hit.handle);
+    }
+    return ArtifactResultSet(m_table, std::move(handles));
+}
+
+QString ArtifactController::searchIndexPath() const {
+    QString path = m_repository->storagePath();
+    return path.isEmpty() ? path : path + ".fts";
+}
+
+bool ArtifactController::saveSearchIndex() const {
+    QString path = searchIndexPath();
+    return !path.isEmpty() && m_table.saveFullTextIndex(path);
+}
+
+QStringList ArtifactController::suggestValues(ArtifactField field, const QString& prefix, size_t limit) const {
+    QStringList values;
+    if (const RadixTrie* trie = m_table.completionTrie(field)) {
+        for (const auto& completion : trie->complete(prefix, limit)) {
+            values << completion.first;
+        }
+    }
+    return values;
+}
+
+ArtifactResultSet ArtifactController::nearestArtifacts(const GeoPoint& center, size_t k, double maxDistanceKm) const {
+    if (!center.isValid()) {
+        throw std::invalid_argument("Nearest-neighbour queries need valid coordinates.");
+    }
+    std::vector<ArtifactHandle> handles;
+    for (const RTree::Neighbour& neighbour : m_table.spatialIndex().nearest(center, k, maxDistanceKm)) {
+        handles.push_back(neighbour.handle);
+    }
+    return ArtifactResultSet(m_table, std::move(handles));
+}
+
+NearDuplicateReport ArtifactController::findNearDuplicates(double minSimilarity) const {
+    return DuplicateDetector(m_table).detect(minSimilarity);
+}
+
+ArtifactResultSet ArtifactController::filterArtifactsByName(const QString& name, bool caseSensitive) const {
     auto filter = std::make_unique<NameFilter>(name, caseSensitive);
     return filterArtifacts(std::move(filter));
 }
 
-std::vector<ArcheologicalArtifact> ArtifactController::filterArtifactsByMaterial(const QString& material, bool caseSensitive) const {
+ArtifactResultSet ArtifactController::filterArtifactsByMaterial(const QString& material, bool caseSensitive) const {
     auto filter = std::make_unique<MaterialFilter>(material, caseSensitive);
     return filterArtifacts(std::move(filter));
 }
 
-std::vector<ArcheologicalArtifact> ArtifactController::filterArtifactsByLocation(const QString& location, bool caseSensitive) const {
+ArtifactResultSet ArtifactController::filterArtifactsByLocation(const QString& location, bool caseSensitive) const {
     auto filter = std::make_unique<LocationFilter>(location, caseSensitive);
     return filterArtifacts(std::move(filter));
 }
 
-std::vector<ArcheologicalArtifact> ArtifactController::filterArtifactsByDateRange(const QDate& startDate, const QDate& endDate) const {
-    auto filter = std::make_unique<DateRangeFilter>(startDate, endDate);
-    return filterArtifacts(std::move(filter));
+ArtifactResultSet ArtifactController::filterArtifactsByDateRange(const QDate& startDate, const QDate& endDate) const {
+    // Scans the Julian-day column instead of comparing QDates artifact by artifact
+    return ArtifactResultSet(m_table, m_table.selectDateRange(startDate, endDate));
 }
 
 // Undo/Redo functionality
 void ArtifactController::executeCommand(std::unique_ptr<Command> command) {
     command->execute();
-    m_undoStack.push(std::move(command));
+    m_historyBytes += command->memoryUsage();
+    m_undoStack.push_back(std::move(command));
     
     // Clear redo stack when a new command is executed
-    while (!m_redoStack.empty()) {
-        m_redoStack.pop();
+    for (const auto& redone : m_redoStack) {
+        m_historyBytes -= redone->memoryUsage();
     }
+    m_redoStack.clear();
+    enforceHistoryLimits();
 }
 
 bool ArtifactController::canUndo() const {
@@ -107,10 +235,10 @@ bool ArtifactController::canUndo() const {
 
 void ArtifactController::undo() {
     if (canUndo()) {
-        auto command = std::move(const_cast<std::unique_ptr<Command>&>(m_undoStack.top()));
-        m_undoStack.pop();
+        auto command = std::move(m_undoStack.back());
+        m_undoStack.pop_back();
         command->undo();
-        m_redoStack.push(std::move(command));
+        m_redoStack.push_back(std::move(command));
     }
 }
 
@@ -120,18 +248,53 @@ bool ArtifactController::canRedo() const {
 
 void ArtifactController::redo() {
     if (canRedo()) {
-        auto command = std::move(const_cast<std::unique_ptr<Command>&>(m_redoStack.top()));
-        m_redoStack.pop();
+        auto command = std::move(m_redoStack.back());
+        m_redoStack.pop_back();
         command->execute();
-        m_undoStack.push(std::move(command));
+        m_undoStack.push_back(std::move(command));
     }
 }
 
 void ArtifactController::clearHistory() {
-    while (!m_undoStack.empty()) {
-        m_undoStack.pop();
+    m_undoStack.clear();
+    m_redoStack.clear();
+    m_historyBytes = 0;
+}
+
+void ArtifactController::setHistoryLimits(size_t maxEntries, size_t maxBytes) {
+    m_maxHistoryEntries = maxEntries;
+    m_maxHistoryBytes = maxBytes;
+    enforceHistoryLimits();
+}
+
+size_t ArtifactController::historyEntryLimit() const {
+    return m_maxHistoryEntries;
+}
+
+size_t ArtifactController::historyMemoryLimit() const {
+    return m_maxHistoryBytes;
+}
+
+size_t ArtifactController::historySize() const {
+    return m_undoStack.size() + m_redoStack.size();
+}
+
+size_t ArtifactController::historyMemoryUsage() const {
+    return m_historyBytes;
+}
+
+void ArtifactController::enforceHistoryLimits() {
+    auto overLimits = [this]() {
+        return (m_maxHistoryEntries && historySize() > m_maxHistoryEntries) ||
+               (m_maxHistoryBytes && m_historyBytes > m_maxHistoryBytes);
+    };
+    // The oldest undo steps go first, then the redo steps farthest from the present
+    while (overLimits() && m_undoStack.size() > 1) {
+        m_historyBytes -= m_undoStack.front()->memoryUsage();
+        m_undoStack.pop_front();
     }
-    while (!m_redoStack.empty()) {
-        m_redoStack.pop();
+    while (overLimits() && !m_redoStack.empty()) {
+        m_historyBytes -= m_redoStack.front()->memoryUsage();
+        m_redoStack.pop_front();
     }
 }
@@ -6,10 +6,20 @@
 #include "../domain/artifact.h"
 #include "command.h"
 #include "filter.h"
+#include "query_planner.h"
+#include "filter_result_cache.h"
+#include "live_view.h"
+#include "query_options.h"
+#include "artifact_result_set.h"
+#include "aggregation_engine.h"
+#include "duplicate_detector.h"
+#include "../index/artifact_table.h"
 #include <vector>
 #include <memory> // For std::unique_ptr to hold the repository
-#include <stack>
+#include <deque>
+#include <limits>
 #include <QString>
+#include <QStringList>
 #include <QDate>
 
 class ArtifactController {
@@ -19,34 +29,99 @@ public:
     ~ArtifactController();
 
     void addArtifact(const QString& id, const QString& name, const QString& description,
-                     const QString& material, const QDate& discoveryDate, const QString& location);
+                     const QString& material, const QDate& discoveryDate, const QString& location,
+                     const GeoPoint& coordinates = GeoPoint());
     void removeArtifact(const QString& artifactId);    void updateArtifact(const QString& originalId, const QString& newId, const QString& name, const QString& description,
-                        const QString& material, const QDate& discoveryDate, const QString& location);
+                        const QString& material, const QDate& discoveryDate, const QString& location,
+                        const GeoPoint& coordinates = GeoPoint());
     
     ArcheologicalArtifact getArtifactById(const QString& artifactId) const;
+    ArcheologicalArtifact getArtifactByHandle(ArtifactHandle handle) const;
     std::vector<ArcheologicalArtifact> getAllArtifacts() const;
 
-    // Filtering functionality
-    std::vector<ArcheologicalArtifact> filterArtifacts(std::unique_ptr<FilterStrategy> filter) const;
-    std::vector<ArcheologicalArtifact> filterArtifactsByName(const QString& name, bool caseSensitive = false) const;
-    std::vector<ArcheologicalArtifact> filterArtifactsByMaterial(const QString& material, bool caseSensitive = false) const;
-    std::vector<ArcheologicalArtifact> filterArtifactsByLocation(const QString& location, bool caseSensitive = false) const;
-    std::vector<ArcheologicalArtifact> filterArtifactsByDateRange(const QDate& startDate, const QDate& endDate) const;
+    // ID <-> handle translation (handles are stable for the controller's lifetime)
+    ArtifactHandle handleForId(const QString& artifactId) const;
+    QString idForHandle(ArtifactHandle handle) const;
+
+    // Filtering functionality; results hold handles and read the artifacts on access
+    // Parallel spreads large tables over the global thread pool; small ones stay serial
+    ArtifactResultSet filterArtifacts(std::unique_ptr<FilterStrategy> filter,
+                                      FilterExecution execution = FilterExecution::Serial) const;
+    // The page of the matches that options select, in their sort order; nullptr matches everything.
+    // Key lists sorted by repeatedly keep their full order until the artifacts change.
+    ArtifactResultSet filterArtifacts(std::unique_ptr<FilterStrategy> filter, const QueryOptions& options,
+                                      FilterExecution execution = FilterExecution::Serial) const;
+    // Number of matches; answered from the value bitmaps alone when the filter is fully indexable
+    size_t countArtifacts(std::unique_ptr<FilterStrategy> filter) const;
+    // Group-by counts and the date range of the matches, all in one pass; nullptr summarizes everything
+    Aggregation aggregateArtifacts(std::unique_ptr<FilterStrategy> filter,
+                                   const AggregationRequest& request = AggregationRequest(),
+                                   FilterExecution execution = FilterExecution::Parallel) const;
+    // The plan filterArtifacts() would run for the filter, one node per line
+    QString explainFilter(const FilterStrategy& filter) const;
+    // Results of earlier filters and their subtrees, dropped on every change to the artifacts
+    const FilterResultCache& filterCache() const;
+    // Text fields kept in case-folded copies for case-insensitive filters (all by default);
+    // 0 trades that speed for the memory, reported by foldedColumnBytes()
+    void setFoldedFields(ArtifactFieldMask fields);
+    size_t foldedColumnBytes() const;
+    // A view of every artifact that follows later changes; narrow it with LiveView::setFilter().
+    // The view must be destroyed before the controller.
+    std::unique_ptr<LiveView> createLiveView();
+    // Artifacts whose descriptions hold every word of the query (see DescriptionSearch), most
+    // relevant first, at most limit of them
+    static constexpr size_t DefaultSearchLimit = 50;
+    ArtifactResultSet searchDescriptions(const QString& query, size_t limit = DefaultSearchLimit) const;
+    // The description index is loaded from searchIndexPath() when it matches the repository;
+    // saveSearchIndex() writes it there (an empty path means the repository has no file)
+    QString searchIndexPath() const;
+    bool saveSearchIndex() const;
+    // Values of a field that start with prefix, ignoring case, most frequent first; empty for
+    // fields without completion (see ArtifactTable::CompletionFields)
+    static constexpr size_t DefaultSuggestionLimit = 10;
+    QStringList suggestValues(ArtifactField field, const QString& prefix, size_t limit = DefaultSuggestionLimit) const;
+    // The k artifacts closest to center along the earth's surface, nearest first, none farther than
+    // maxDistanceKm; found through the R-tree, so artifacts without coordinates never appear
+    ArtifactResultSet nearestArtifacts(const GeoPoint& center, size_t k,
+                                       double maxDistanceKm = std::numeric_limits<double>::infinity()) const;
+    // Pairs and groups of artifacts whose names and descriptions are near-duplicates, from the
+    // MinHash signatures the table keeps current; minSimilarity must lie in (0, 1]
+    NearDuplicateReport findNearDuplicates(double minSimilarity = DuplicateDetector::DefaultMinSimilarity) const;
+    ArtifactResultSet filterArtifactsByName(const QString& name, bool caseSensitive = false) const;
+    ArtifactResultSet filterArtifactsByMaterial(const QString& material, bool caseSensitive = false) const;
+    ArtifactResultSet filterArtifactsByLocation(const QString& location, bool caseSensitive = false) const;
+    ArtifactResultSet filterArtifactsByDateRange(const QDate& startDate, const QDate& endDate) const;
 
     // Undo/Redo functionality
     void undo();
     void redo();
     bool canUndo() const;
     bool canRedo() const;    void clearHistory();
+    // The oldest history is dropped once it holds more than maxEntries commands or maxBytes of
+    // them (see Command::memoryUsage()); 0 lifts a limit. The last undoable command always stays.
+    static constexpr size_t DefaultHistoryEntries = 1000;
+    static constexpr size_t DefaultHistoryBytes = 64 * 1024 * 1024;
+    void setHistoryLimits(size_t maxEntries, size_t maxBytes);
+    size_t historyEntryLimit() const;
+    size_t historyMemoryLimit() const;
+    size_t historySize() const;        // Undoable and redoable commands together
+    size_t historyMemoryUsage() const; // Their bytes
 
 private:
     std::unique_ptr<Repository> m_repository;
+    ArtifactTable m_table; // Columnar mirror of the repository, kept current through change sets
+    mutable FilterResultCache m_filterCache; // Filtering is const but fills the cache
+    mutable SortOrderCache m_sortOrders;     // Same
     
-    // Command pattern for undo/redo
-    std::stack<std::unique_ptr<Command>> m_undoStack;
-    std::stack<std::unique_ptr<Command>> m_redoStack;
+    // Command pattern for undo/redo; the newest command of each is at the back
+    std::deque<std::unique_ptr<Command>> m_undoStack;
+    std::deque<std::unique_ptr<Command>> m_redoStack;
+    size_t m_historyBytes = 0;
+    size_t m_maxHistoryEntries = DefaultHistoryEntries;
+    size_t m_maxHistoryBytes = DefaultHistoryBytes;
     
     void executeCommand(std::unique_ptr<Command> command);
+    void enforceHistoryLimits();
 };
 
 #endif // ARTIFACT_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "artifact_result_set.h"
+#include <stdexcept>
+
+ArtifactResultSet::ArtifactResultSet(const ArtifactTable& table, std::vector<ArtifactHandle> handles)
+    : m_table(&table), m_handles(std::move(handles)) {
+}
+
+ArtifactResultSet::ArtifactResultSet(const ArtifactTable& table, const RowBitmap& rows) : m_table(&table) {
+    m_handles.reserve(rows.count());
+    rows.forEachSetBit([this](size_t row) {
+        m_handles.push_back(m_table->handle(row));
+    });
+}
+
+const ArcheologicalArtifact& ArtifactResultSet::artifact(size_t position) const {
+    int row = m_table->rowOf(m_handles[position]);
+    if (row < 0 || !m_table->isLive(static_cast<size_t>(row))) {
+        throw std::runtime_error("Artifact no longer exists.");
+    }
+    return m_table->artifact(static_cast<size_t>(row));
+}
+
+std::vector<ArcheologicalArtifact> ArtifactResultSet::materialize() const {
+    std::vector<ArcheologicalArtifact> artifacts;
+    artifacts.reserve(m_handles.size());
+    for (const ArcheologicalArtifact& artifact : *this) {
+        artifacts.push_back(artifact);
+    }
+    return artifacts;
+}
@@ -0,0 +1,62 @@
+#ifndef ARTIFACT_RESULT_SET_H
+#define ARTIFACT_RESULT_SET_H
+
+#include "../domain/artifact.h"
+#include "../index/artifact_table.h"
+#include "../index/row_bitmap.h"
+#include <iterator>
+#include <vector>
+
+// Result of a query as the handles of the matching artifacts, in result order. Entries are
+// read from the table on access, so building a result copies no strings; materialize() makes
+// the copies for callers that need them. Handles survive later changes to the artifacts: an
+// entry reads its artifact as it is now, and reading one that has since been removed throws.
+// The result must not outlive the table.
+class ArtifactResultSet {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ArcheologicalArtifact;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ArcheologicalArtifact*;
+        using reference = const ArcheologicalArtifact&;
+
+        const_iterator(const ArtifactResultSet* result, size_t position) : m_result(result), m_position(position) {}
+
+        reference operator*() const { return m_result->artifact(m_position); }
+        pointer operator->() const { return &m_result->artifact(m_position); }
+        const_iterator& operator++() { ++m_position; return *this; }
+        const_iterator operator++(int) { const_iterator previous = *this; ++m_position; return previous; }
+        bool operator==(const const_iterator& other) const { return m_position == other.m_position; }
+        bool operator!=(const const_iterator& other) const { return m_position != other.m_position; }
+
+    private:
+        const ArtifactResultSet* m_result;
+        size_t m_position;
+    };
+
+    explicit ArtifactResultSet(const ArtifactTable& table, std::vector<ArtifactHandle> handles = {});
+    // The rows set in rows, in table order
+    ArtifactResultSet(const ArtifactTable& table, const RowBitmap& rows);
+
+    size_t size() const { return m_handles.size(); }
+    bool empty() const { return m_handles.empty(); }
+    ArtifactHandle handle(size_t position) const { return m_handles[position]; }
+    const std::vector<ArtifactHandle>& handles() const { return m_handles; }
+
+    // Throws std::runtime_error if the artifact was removed after the query
+    const ArcheologicalArtifact& artifact(size_t position) const;
+    const ArcheologicalArtifact& operator[](size_t position) const { return artifact(position); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_handles.size()); }
+
+    // Copies of every entry; the only place a result copies artifacts
+    std::vector<ArcheologicalArtifact> materialize() const;
+
+private:
+    const ArtifactTable* m_table; // Not owned
+    std::vector<ArtifactHandle> m_handles;
+};
+
+#endif // ARTIFACT_RESULT_SET_H
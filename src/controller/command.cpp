@@ -17,17 +17,21 @@ std::unique_ptr<Command> AddArtifactCommand::clone() const {
     return std::make_unique<AddArtifactCommand>(m_repository, m_artifact);
 }
 
+size_t AddArtifactCommand::memoryUsage() const {
+    return sizeof(*this) + m_artifact.textBytes();
+}
+
 // RemoveArtifactCommand Implementation
-RemoveArtifactCommand::RemoveArtifactCommand(Repository* repository, const QString& artifactId)
-    : m_repository(repository), m_artifactId(artifactId) {}
+RemoveArtifactCommand::RemoveArtifactCommand(Repository* repository, ArtifactHandle handle)
+    : m_repository(repository), m_handle(handle) {}
 
 void RemoveArtifactCommand::execute() {
     if (!m_executed) {
         // Store the artifact before removing it for undo
-        m_removedArtifact = m_repository->findArtifactById(m_artifactId);
+        m_removedArtifact = m_repository->findArtifactByHandle(m_handle);
         m_executed = true;
     }
-    m_repository->removeArtifact(m_artifactId);
+    m_repository->removeArtifact(m_removedArtifact.getId());
 }
 
 void RemoveArtifactCommand::undo() {
@@ -37,7 +41,7 @@ void RemoveArtifactCommand::undo() {
 }
 
 std::unique_ptr<Command> RemoveArtifactCommand::clone() const {
-    auto clone = std::make_unique<RemoveArtifactCommand>(m_repository, m_artifactId);
+    auto clone = std::make_unique<RemoveArtifactCommand>(m_repository, m_handle);
     if (m_executed) {
         clone->m_removedArtifact = m_removedArtifact;
         clone->m_executed = m_executed;
@@ -45,30 +49,49 @@ std::unique_ptr<Command> RemoveArtifactCommand::clone() const {
     return clone;
 }
 
+size_t RemoveArtifactCommand::memoryUsage() const {
+    return sizeof(*this) + m_removedArtifact.textBytes();
+}
+
 // UpdateArtifactCommand Implementation
 UpdateArtifactCommand::UpdateArtifactCommand(Repository* repository, const ArcheologicalArtifact& newArtifact)
     : m_repository(repository), m_newArtifact(newArtifact) {}
 
 void UpdateArtifactCommand::execute() {
-    if (!m_executed) {
-        // Store the old artifact before updating for undo
-        m_oldArtifact = m_repository->findArtifactById(m_newArtifact.getId());
-        m_executed = true;
+    if (!m_change) {
+        // Keep only the fields that differ; undo and redo write them over the stored artifact
+        m_change = ArtifactChangeSet::updated(m_repository->findArtifactById(m_newArtifact.getId()), m_newArtifact);
+        m_newArtifact = ArcheologicalArtifact();
     }
-    m_repository->updateArtifact(m_newArtifact);
+    write(true);
 }
 
 void UpdateArtifactCommand::undo() {
-    if (m_executed) {
-        m_repository->updateArtifact(m_oldArtifact);
+    if (m_change) {
+        write(false);
     }
 }
 
 std::unique_ptr<Command> UpdateArtifactCommand::clone() const {
     auto clone = std::make_unique<UpdateArtifactCommand>(m_repository, m_newArtifact);
-    if (m_executed) {
-        clone->m_oldArtifact = m_oldArtifact;
-        clone->m_executed = m_executed;
-    }
+    clone->m_change = m_change;
     return clone;
 }
+
+size_t UpdateArtifactCommand::memoryUsage() const {
+    return sizeof(*this) + (m_change ? m_change->memoryUsage() : m_newArtifact.textBytes());
+}
+
+void UpdateArtifactCommand::write(bool forward) {
+    if (m_change->isEmpty()) {
+        return;
+    }
+    // The artifact comes back clean, so the repository compares only the fields written here
+    ArcheologicalArtifact artifact = m_repository->findArtifactByHandle(m_change->handle());
+    if (forward) {
+        m_change->apply(artifact);
+    } else {
+        m_change->revert(artifact);
+    }
+    m_repository->updateArtifact(artifact);
+}
@@ -4,6 +4,7 @@
 #include "../repository/repository.h"
 #include "../domain/artifact.h"
 #include <memory>
+#include <optional>
 
 // Abstract Command interface
 class Command {
@@ -12,6 +13,8 @@ public:
     virtual void execute() = 0;
     virtual void undo() = 0;
     virtual std::unique_ptr<Command> clone() const = 0;
+    // Approximate bytes the command holds for undo and redo, the text of artifacts included
+    virtual size_t memoryUsage() const = 0;
 };
 
 // Add Artifact Command
@@ -22,6 +25,7 @@ public:
     void execute() override;
     void undo() override;
     std::unique_ptr<Command> clone() const override;
+    size_t memoryUsage() const override;
 
 private:
     Repository* m_repository;
@@ -31,15 +35,16 @@ private:
 // Remove Artifact Command
 class RemoveArtifactCommand : public Command {
 public:
-    RemoveArtifactCommand(Repository* repository, const QString& artifactId);
+    RemoveArtifactCommand(Repository* repository, ArtifactHandle handle);
     
     void execute() override;
     void undo() override;
     std::unique_ptr<Command> clone() const override;
+    size_t memoryUsage() const override;
 
 private:
     Repository* m_repository;
-    QString m_artifactId;
+    ArtifactHandle m_handle;
     ArcheologicalArtifact m_removedArtifact; // Store for undo
     bool m_executed = false;
 };
@@ -52,12 +57,14 @@ public:
     void execute() override;
     void undo() override;
     std::unique_ptr<Command> clone() const override;
+    size_t memoryUsage() const override;
 
 private:
+    void write(bool forward); // The new values of m_change over the stored artifact, or the old ones
+
     Repository* m_repository;
-    ArcheologicalArtifact m_newArtifact;
-    ArcheologicalArtifact m_oldArtifact; // Store for undo
-    bool m_executed = false;
+    ArcheologicalArtifact m_newArtifact; // Until the first execute, which turns it into m_change
+    std::optional<ArtifactChangeSet> m_change; // Only the fields that differ, for undo and redo
 };
 
 #endif // COMMAND_H
@@ -0,0 +1,141 @@
+#include "duplicate_detector.h"
+#include <QHash>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+size_t findRoot(std::vector<size_t>& parents, size_t node) {
+    while (parents[node] != node) {
+        parents[node] = parents[parents[node]]; // Path halving
+        node = parents[node];
+    }
+    return node;
+}
+
+} // namespace
+
+QString NearDuplicateReport::toText() const {
+    QString text = QString("%1 near-duplicate pairs in %2 groups at %3% similarity "
+                           "(%4 artifacts compared, %5 candidate pairs)\n")
+                       .arg(pairs.size())
+                       .arg(groups.size())
+                       .arg(qRound(minSimilarity * 100))
+                       .arg(comparedArtifacts)
+                       .arg(candidatePairs);
+    // Pairs by group, so each group lists what links its members
+    QHash<QString, size_t> groupOf;
+    for (size_t group = 0; group < groups.size(); ++group) {
+        for (const QString& id : groups[group]) {
+            groupOf.insert(id, group);
+        }
+    }
+    std::vector<std::vector<const NearDuplicatePair*>> pairsOf(groups.size());
+    for (const NearDuplicatePair& pair : pairs) {
+        pairsOf[groupOf.value(pair.firstId)].push_back(&pair);
+    }
+    for (size_t group = 0; group < groups.size(); ++group) {
+        text += QString("\nGroup %1: %2\n").arg(group + 1).arg(groups[group].join(", "));
+        for (const NearDuplicatePair* pair : pairsOf[group]) {
+            text += QString("  %1 ~ %2  %3%\n").arg(pair->firstId, pair->secondId).arg(qRound(pair->similarity * 100));
+        }
+    }
+    return text;
+}
+
+DuplicateDetector::DuplicateDetector(const ArtifactTable& table) : m_table(table) {
+}
+
+NearDuplicateReport DuplicateDetector::detect(double minSimilarity) const {
+    if (!(minSimilarity > 0.0 && minSimilarity <= 1.0)) {
+        throw std::invalid_argument("Near-duplicate similarity must lie between 0 and 1.");
+    }
+    const MinHashIndex& index = m_table.nearDuplicateIndex();
+    NearDuplicateReport report;
+    report.minSimilarity = minSimilarity;
+    report.comparedArtifacts = index.size();
+
+    const std::vector<MinHashIndex::Candidate> candidates =
+        index.candidates(minSimilarity - EstimateSlack, &report.candidatePairs);
+    QHash<ArtifactHandle, std::vector<quint64>> shingles; // Of the candidates, each computed once
+    auto shinglesOf = [&](ArtifactHandle handle) -> const std::vector<quint64>& {
+        auto found = shingles.find(handle);
+        if (found == shingles.end()) {
+            const ArcheologicalArtifact& artifact = m_table.artifact(static_cast<size_t>(m_table.rowOf(handle)));
+            found = shingles.insert(handle, MinHashIndex::shingles(ArtifactTable::nearDuplicateText(artifact)));
+        }
+        return found.value();
+    };
+    std::vector<std::pair<int, int>> rows; // Of each pair, in repository order
+    for (const MinHashIndex::Candidate& candidate : candidates) {
+        const double similarity = MinHashIndex::jaccard(shinglesOf(candidate.first), shinglesOf(candidate.second));
+        if (similarity < minSimilarity) {
+            continue;
+        }
+        int first = m_table.rowOf(candidate.first);
+        int second = m_table.rowOf(candidate.second);
+        if (second < first) {
+            std::swap(first, second);
+        }
+        rows.emplace_back(first, second);
+        report.pairs.push_back({m_table.artifact(first).getId(), m_table.artifact(second).getId(),
+                                m_table.handle(first), m_table.handle(second), similarity});
+    }
+
+    std::vector<size_t> order(report.pairs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (report.pairs[a].similarity != report.pairs[b].similarity) {
+            return report.pairs[a].similarity > report.pairs[b].similarity;
+        }
+        return rows[a] < rows[b];
+    });
+    std::vector<NearDuplicatePair> sorted;
+    sorted.reserve(order.size());
+    for (size_t position : order) {
+        sorted.push_back(report.pairs[position]);
+    }
+    report.pairs = std::move(sorted);
+
+    // Union-find over the rows of the pairs; each root collects one group
+    QHash<int, size_t> nodeOf;
+    std::vector<int> rowOfNode;
+    auto node = [&](int row) {
+        auto found = nodeOf.find(row);
+        if (found == nodeOf.end()) {
+            found = nodeOf.insert(row, rowOfNode.size());
+            rowOfNode.push_back(row);
+        }
+        return found.value();
+    };
+    std::vector<size_t> parents;
+    for (const auto& pair : rows) {
+        const size_t first = node(pair.first);
+        const size_t second = node(pair.second);
+        while (parents.size() < rowOfNode.size()) {
+            parents.push_back(parents.size());
+        }
+        parents[findRoot(parents, first)] = findRoot(parents, second);
+    }
+    QHash<size_t, std::vector<int>> members;
+    for (size_t i = 0; i < rowOfNode.size(); ++i) {
+        members[findRoot(parents, i)].push_back(rowOfNode[i]);
+    }
+    std::vector<std::vector<int>> groups;
+    for (auto group = members.begin(); group != members.end(); ++group) {
+        std::sort(group.value().begin(), group.value().end());
+        groups.push_back(std::move(group.value()));
+    }
+    std::sort(groups.begin(), groups.end(), [](const std::vector<int>& a, const std::vector<int>& b) {
+        return a.size() != b.size() ? a.size() > b.size() : a.front() < b.front();
+    });
+    for (const std::vector<int>& group : groups) {
+        QStringList ids;
+        for (int row : group) {
+            ids << m_table.artifact(static_cast<size_t>(row)).getId();
+        }
+        report.groups.push_back(ids);
+    }
+    return report;
+}
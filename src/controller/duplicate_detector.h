@@ -0,0 +1,48 @@
+#ifndef DUPLICATE_DETECTOR_H
+#define DUPLICATE_DETECTOR_H
+
+#include "../index/artifact_table.h"
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+struct NearDuplicatePair {
+    QString firstId; // Earlier in repository order
+    QString secondId;
+    ArtifactHandle first;
+    ArtifactHandle second;
+    double similarity; // Jaccard similarity of the shingle sets, from the texts themselves
+};
+
+// Near-duplicates found at one threshold. Pairs link artifacts into groups, so a find entered
+// three times gives one group of three.
+struct NearDuplicateReport {
+    double minSimilarity = 0.0;
+    size_t comparedArtifacts = 0; // Those with any words in their name or description
+    size_t candidatePairs = 0;    // Pairs the LSH buckets proposed, before verification
+    std::vector<NearDuplicatePair> pairs;  // Most similar first, ties in repository order
+    std::vector<QStringList> groups;       // IDs in repository order; largest group first
+
+    // A plain-text summary: the counts, then each group with the similarities of its pairs
+    QString toText() const;
+};
+
+// Finds near-duplicate names and descriptions from the table's MinHash index: the candidate
+// pairs of the LSH bands whose signature estimate comes within EstimateSlack of the threshold
+// are verified against their exact shingle sets, so the report holds no false positives. The
+// bands are tuned for the default threshold; lower ones miss more pairs (see MinHashIndex).
+class DuplicateDetector {
+public:
+    static constexpr double DefaultMinSimilarity = 0.8;
+    static constexpr double EstimateSlack = 0.1; // About three standard deviations of the estimate
+
+    explicit DuplicateDetector(const ArtifactTable& table);
+
+    // minSimilarity must lie in (0, 1]
+    NearDuplicateReport detect(double minSimilarity = DefaultMinSimilarity) const;
+
+private:
+    const ArtifactTable& m_table;
+};
+
+#endif // DUPLICATE_DETECTOR_H
@@ -0,0 +1,89 @@
+#include "facet_counts.h"
+#include "../domain/artifact_schema.h"
+#include <algorithm>
+
+FacetCounts::FacetCounts(const AggregationRequest& request) : m_request(request) {
+}
+
+void FacetCounts::membersReset(const LiveView& view) {
+    m_rows = 0;
+    for (QHash<QString, size_t>& values : m_values) {
+        values.clear();
+    }
+    m_days.clear();
+    m_undated = 0;
+    for (size_t position = 0; position < view.size(); ++position) {
+        count(view.artifact(position), true);
+    }
+}
+
+void FacetCounts::memberEntered(const ArcheologicalArtifact& artifact) {
+    count(artifact, true);
+}
+
+void FacetCounts::memberLeft(const ArcheologicalArtifact& artifact) {
+    count(artifact, false);
+}
+
+Aggregation FacetCounts::aggregation() const {
+    Aggregation result;
+    result.rows = m_rows;
+    result.undated = m_undated;
+    if (!m_days.empty()) {
+        result.earliest = QDate::fromJulianDay(m_days.begin()->first);
+        result.latest = QDate::fromJulianDay(m_days.rbegin()->first);
+    }
+    for (size_t field = 0; field < ArtifactFieldCount; ++field) {
+        std::vector<std::pair<QString, size_t>>& counts = result.valueCounts[field];
+        counts.reserve(static_cast<size_t>(m_values[field].size()));
+        for (auto it = m_values[field].constBegin(); it != m_values[field].constEnd(); ++it) {
+            counts.emplace_back(it.key(), it.value());
+        }
+        std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    }
+    if (m_request.groupBy & fieldBit(ArtifactField::DiscoveryDate)) {
+        // Days are ascending, and so are their buckets
+        for (const auto& [day, members] : m_days) {
+            const int bucket = AggregationEngine::bucketOf(day, m_request.dateBucket);
+            if (result.dateCounts.empty() || result.dateCounts.back().first != bucket) {
+                result.dateCounts.emplace_back(bucket, 0);
+            }
+            result.dateCounts.back().second += members;
+        }
+    }
+    return result;
+}
+
+void FacetCounts::count(const ArcheologicalArtifact& artifact, bool enter) {
+    // Counts that drop to zero are erased, so a value no member has leaves the facets
+    m_rows = enter ? m_rows + 1 : m_rows - 1;
+    for (size_t field = 0; field < ArtifactFieldCount; ++field) {
+        ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(static_cast<ArtifactField>(field));
+        if (!getter || !(m_request.groupBy & fieldBit(static_cast<ArtifactField>(field)))) {
+            continue;
+        }
+        auto value = m_values[field].find((artifact.*getter)());
+        if (enter) {
+            if (value == m_values[field].end()) {
+                m_values[field].insert((artifact.*getter)(), 1);
+            } else {
+                ++value.value();
+            }
+        } else if (value != m_values[field].end() && --value.value() == 0) {
+            m_values[field].erase(value);
+        }
+    }
+    const qint32 day = ArtifactTable::toJulianDay(artifact.getDiscoveryDate());
+    if (day == ArtifactTable::InvalidJulianDay) {
+        m_undated = enter ? m_undated + 1 : m_undated - 1;
+    } else if (enter) {
+        ++m_days[day];
+    } else {
+        auto members = m_days.find(day);
+        if (members != m_days.end() && --members->second == 0) {
+            m_days.erase(members);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef FACET_COUNTS_H
+#define FACET_COUNTS_H
+
+#include "aggregation_engine.h"
+#include "live_view.h"
+#include <QHash>
+#include <QString>
+#include <array>
+#include <map>
+
+// The group-by counts of a LiveView's members, kept current from the artifacts entering and
+// leaving it: an edit adjusts the counts of its old and new values, so only a reset of the
+// view counts every member again.
+class FacetCounts : public LiveViewMemberListener {
+public:
+    explicit FacetCounts(const AggregationRequest& request = AggregationRequest());
+
+    void membersReset(const LiveView& view) override;
+    void memberEntered(const ArcheologicalArtifact& artifact) override;
+    void memberLeft(const ArcheologicalArtifact& artifact) override;
+
+    // In the same form and order as AggregationEngine::aggregate() over the members
+    Aggregation aggregation() const;
+
+private:
+    void count(const ArcheologicalArtifact& artifact, bool enter);
+
+    AggregationRequest m_request;
+    size_t m_rows = 0;
+    std::array<QHash<QString, size_t>, ArtifactFieldCount> m_values; // Indexed by ArtifactField
+    std::map<qint32, size_t> m_days; // Members per Julian day, for the buckets and the date range
+    size_t m_undated = 0;
+};
+
+#endif // FACET_COUNTS_H
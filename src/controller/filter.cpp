@@ -1,4 +1,57 @@
 #include "filter.h"
+#include "query_planner.h"
+#include "../index/artifact_table.h"
+#include "../domain/artifact_schema.h"
+#include <QThreadPool>
+#include <QSemaphore>
+#include <algorithm>
+#include <stdexcept>
+
+void FilterStrategy::accept(FilterVisitor& visitor) const {
+    visitor.visitOther(*this);
+}
+
+RowBitmap FilterStrategy::matchBatch(const ArtifactBatch& batch) const {
+    return refineBatch(batch, batch.liveRows());
+}
+
+namespace {
+
+// Shared by the leaves over bitmap-indexed fields
+bool selectFromBitmapIndex(const ArtifactTable& table, ArtifactField field, const QString& needle, TextMatch match,
+                           bool caseSensitive, RoaringBitmap& handles) {
+    const BitmapIndex* index = table.bitmapIndex(field);
+    if (!index) {
+        return false;
+    }
+    Qt::CaseSensitivity sensitivity = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    if (match == TextMatch::Equals) {
+        handles = index->equalTo(needle, sensitivity);
+        return true;
+    }
+    // A substring test runs once per distinct value, which only pays off while they are few
+    if (!index->isLowCardinality(table.artifactCount())) {
+        return false;
+    }
+    handles = index->containing(needle, sensitivity);
+    return true;
+}
+
+} // namespace
+
+bool FilterStrategy::selectIndexed(const ArtifactTable& /*table*/, RoaringBitmap& /*handles*/) const {
+    return false;
+}
+
+RowBitmap FilterStrategy::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    RowBitmap rows(batch.size());
+    candidates.forEachSetBit([&](size_t row) {
+        if (matches(batch.artifact(row))) {
+            rows.set(row);
+        }
+    });
+    return rows;
+}
 
 // NameFilter Implementation
 NameFilter::NameFilter(const QString& name, bool caseSensitive)
@@ -16,11 +69,23 @@ std::unique_ptr<FilterStrategy> NameFilter::clone() const {
     return std::make_unique<NameFilter>(m_name, m_caseSensitive);
 }
 
+void NameFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap NameFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    return batch.selectText(ArtifactField::Name, m_name, TextMatch::Contains,
+                            m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive, candidates);
+}
+
 // MaterialFilter Implementation
-MaterialFilter::MaterialFilter(const QString& material, bool caseSensitive)
-    : m_material(material), m_caseSensitive(caseSensitive) {}
+MaterialFilter::MaterialFilter(const QString& material, bool caseSensitive, TextMatch match)
+    : m_material(material), m_caseSensitive(caseSensitive), m_match(match) {}
 
 bool MaterialFilter::matches(const ArcheologicalArtifact& artifact) const {
+    if (m_match == TextMatch::Equals) {
+        return artifact.getMaterial().compare(m_material, m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive) == 0;
+    }
     if (m_caseSensitive) {
         return artifact.getMaterial().contains(m_material);
     } else {
@@ -29,14 +94,37 @@ bool MaterialFilter::matches(const ArcheologicalArtifact& artifact) const {
 }
 
 std::unique_ptr<FilterStrategy> MaterialFilter::clone() const {
-    return std::make_unique<MaterialFilter>(m_material, m_caseSensitive);
+    return std::make_unique<MaterialFilter>(m_material, m_caseSensitive, m_match);
+}
+
+void MaterialFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap MaterialFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    // Prefer the value bitmaps unless the candidates are already fewer than the handles they give
+    RoaringBitmap handles;
+    if (batch.table() && selectIndexed(*batch.table(), handles) && handles.cardinality() <= candidates.count()) {
+        RowBitmap rows = batch.rowsOf(handles);
+        rows &= candidates;
+        return rows;
+    }
+    return batch.selectText(ArtifactField::Material, m_material, m_match,
+                            m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive, candidates);
+}
+
+bool MaterialFilter::selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const {
+    return selectFromBitmapIndex(table, ArtifactField::Material, m_material, m_match, m_caseSensitive, handles);
 }
 
 // LocationFilter Implementation
-LocationFilter::LocationFilter(const QString& location, bool caseSensitive)
-    : m_location(location), m_caseSensitive(caseSensitive) {}
+LocationFilter::LocationFilter(const QString& location, bool caseSensitive, TextMatch match)
+    : m_location(location), m_caseSensitive(caseSensitive), m_match(match) {}
 
 bool LocationFilter::matches(const ArcheologicalArtifact& artifact) const {
+    if (m_match == TextMatch::Equals) {
+        return artifact.getLocation().compare(m_location, m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive) == 0;
+    }
     if (m_caseSensitive) {
         return artifact.getLocation().contains(m_location);
     } else {
@@ -45,7 +133,52 @@ bool LocationFilter::matches(const ArcheologicalArtifact& artifact) const {
 }
 
 std::unique_ptr<FilterStrategy> LocationFilter::clone() const {
-    return std::make_unique<LocationFilter>(m_location, m_caseSensitive);
+    return std::make_unique<LocationFilter>(m_location, m_caseSensitive, m_match);
+}
+
+void LocationFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap LocationFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    // Prefer the value bitmaps unless the candidates are already fewer than the handles they give
+    RoaringBitmap handles;
+    if (batch.table() && selectIndexed(*batch.table(), handles) && handles.cardinality() <= candidates.count()) {
+        RowBitmap rows = batch.rowsOf(handles);
+        rows &= candidates;
+        return rows;
+    }
+    return batch.selectText(ArtifactField::Location, m_location, m_match,
+                            m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive, candidates);
+}
+
+bool LocationFilter::selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const {
+    return selectFromBitmapIndex(table, ArtifactField::Location, m_location, m_match, m_caseSensitive, handles);
+}
+
+// DescriptionFilter Implementation
+DescriptionFilter::DescriptionFilter(const QString& description, bool caseSensitive)
+    : m_description(description), m_caseSensitive(caseSensitive) {}
+
+bool DescriptionFilter::matches(const ArcheologicalArtifact& artifact) const {
+    if (m_caseSensitive) {
+        return artifact.getDescription().contains(m_description);
+    } else {
+        return artifact.getDescription().contains(m_description, Qt::CaseInsensitive);
+    }
+}
+
+std::unique_ptr<FilterStrategy> DescriptionFilter::clone() const {
+    return std::make_unique<DescriptionFilter>(m_description, m_caseSensitive);
+}
+
+void DescriptionFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap DescriptionFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    return batch.selectText(ArtifactField::Description, m_description, TextMatch::Contains,
+                            m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive, candidates);
 }
 
 // DateRangeFilter Implementation
@@ -61,6 +194,17 @@ std::unique_ptr<FilterStrategy> DateRangeFilter::clone() const {
     return std::make_unique<DateRangeFilter>(m_startDate, m_endDate);
 }
 
+void DateRangeFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap DateRangeFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    // A full SIMD scan of the day column is cheaper than visiting candidates one by one
+    RowBitmap rows = batch.selectDateRange(m_startDate, m_endDate);
+    rows &= candidates;
+    return rows;
+}
+
 // IdFilter Implementation
 IdFilter::IdFilter(const QString& id, bool caseSensitive)
     : m_id(id), m_caseSensitive(caseSensitive) {}
@@ -77,6 +221,185 @@ std::unique_ptr<FilterStrategy> IdFilter::clone() const {
     return std::make_unique<IdFilter>(m_id, m_caseSensitive);
 }
 
+void IdFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap IdFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    return batch.selectText(ArtifactField::Id, m_id, TextMatch::Contains,
+                            m_caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive, candidates);
+}
+
+// FuzzyNameFilter Implementation
+FuzzyNameFilter::FuzzyNameFilter(const QString& name, int maxEdits)
+    : m_name(name), m_search(name, maxEdits) {}
+
+int FuzzyNameFilter::suggestedEdits(const QString& name) {
+    if (name.size() < 4) {
+        return 0;
+    }
+    return name.size() < 6 ? 1 : 2;
+}
+
+bool FuzzyNameFilter::matches(const ArcheologicalArtifact& artifact) const {
+    return m_search.contains(artifact.getName());
+}
+
+std::unique_ptr<FilterStrategy> FuzzyNameFilter::clone() const {
+    return std::make_unique<FuzzyNameFilter>(m_name, m_search.maxEdits());
+}
+
+void FuzzyNameFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap FuzzyNameFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    return batch.selectApproximate(ArtifactField::Name, m_search, candidates);
+}
+
+// DescriptionSearch Implementation
+DescriptionSearch::DescriptionSearch(const QString& query)
+    : m_text(query), m_query(FullTextQuery::parse(query)) {}
+
+bool DescriptionSearch::matches(const ArcheologicalArtifact& artifact) const {
+    return m_query.matches(artifact.getDescription());
+}
+
+std::unique_ptr<FilterStrategy> DescriptionSearch::clone() const {
+    return std::make_unique<DescriptionSearch>(m_text);
+}
+
+void DescriptionSearch::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap DescriptionSearch::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    RoaringBitmap handles;
+    if (!batch.table() || !selectIndexed(*batch.table(), handles)) {
+        return FilterStrategy::refineBatch(batch, candidates);
+    }
+    RowBitmap rows = batch.rowsOf(handles);
+    rows &= candidates;
+    return rows;
+}
+
+bool DescriptionSearch::selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const {
+    handles = RoaringBitmap();
+    for (ArtifactHandle handle : table.fullTextIndex().matching(m_query)) {
+        handles.add(handle);
+    }
+    return true;
+}
+
+std::vector<FullTextIndex::Hit> DescriptionSearch::rank(const ArtifactTable& table, size_t limit) const {
+    return table.fullTextIndex().search(m_query, limit);
+}
+
+// RegexFilter Implementation
+RegexFilter::RegexFilter(ArtifactField field, const QString& pattern, bool caseSensitive)
+    : m_field(field), m_search(pattern, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive) {
+    if (!m_search.isValid()) {
+        throw std::invalid_argument("Invalid regular expression: " + m_search.errorString().toStdString());
+    }
+    if (!ArtifactSchema::textGetter(field)) {
+        throw std::invalid_argument("Regular expressions only apply to text fields.");
+    }
+}
+
+bool RegexFilter::matches(const ArcheologicalArtifact& artifact) const {
+    return m_search.contains((artifact.*ArtifactSchema::textGetter(m_field))());
+}
+
+std::unique_ptr<FilterStrategy> RegexFilter::clone() const {
+    return std::make_unique<RegexFilter>(m_field, pattern(), caseSensitive());
+}
+
+void RegexFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap RegexFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    return batch.selectRegex(m_field, m_search, candidates);
+}
+
+// BoundingBoxFilter Implementation
+BoundingBoxFilter::BoundingBoxFilter(const GeoBox& box) : m_box(box) {
+    if (!m_box.isValid()) {
+        throw std::invalid_argument("A bounding box needs south <= north and coordinates in range.");
+    }
+}
+
+bool BoundingBoxFilter::matches(const ArcheologicalArtifact& artifact) const {
+    return m_box.contains(artifact.getCoordinates());
+}
+
+std::unique_ptr<FilterStrategy> BoundingBoxFilter::clone() const {
+    return std::make_unique<BoundingBoxFilter>(m_box);
+}
+
+void BoundingBoxFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap BoundingBoxFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    RoaringBitmap handles;
+    if (batch.table() && selectIndexed(*batch.table(), handles) && handles.cardinality() <= candidates.count()) {
+        RowBitmap rows = batch.rowsOf(handles);
+        rows &= candidates;
+        return rows;
+    }
+    return FilterStrategy::refineBatch(batch, candidates);
+}
+
+bool BoundingBoxFilter::selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const {
+    handles.clear();
+    for (ArtifactHandle handle : table.spatialIndex().inBox(m_box)) {
+        handles.add(handle);
+    }
+    return true;
+}
+
+// RadiusFilter Implementation
+RadiusFilter::RadiusFilter(const GeoPoint& center, double radiusKm) : m_center(center), m_radiusKm(radiusKm) {
+    if (!m_center.isValid()) {
+        throw std::invalid_argument("The center of a radius filter needs valid coordinates.");
+    }
+    if (!(m_radiusKm >= 0.0)) {
+        throw std::invalid_argument("The radius cannot be negative.");
+    }
+}
+
+bool RadiusFilter::matches(const ArcheologicalArtifact& artifact) const {
+    const GeoPoint& coordinates = artifact.getCoordinates();
+    return coordinates.isValid() && m_center.distanceKm(coordinates) <= m_radiusKm;
+}
+
+std::unique_ptr<FilterStrategy> RadiusFilter::clone() const {
+    return std::make_unique<RadiusFilter>(m_center, m_radiusKm);
+}
+
+void RadiusFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+RowBitmap RadiusFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    RoaringBitmap handles;
+    if (batch.table() && selectIndexed(*batch.table(), handles) && handles.cardinality() <= candidates.count()) {
+        RowBitmap rows = batch.rowsOf(handles);
+        rows &= candidates;
+        return rows;
+    }
+    return FilterStrategy::refineBatch(batch, candidates);
+}
+
+bool RadiusFilter::selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const {
+    handles.clear();
+    for (ArtifactHandle handle : table.spatialIndex().withinRadius(m_center, m_radiusKm)) {
+        handles.add(handle);
+    }
+    return true;
+}
+
 // AndFilter Implementation
 void AndFilter::addFilter(std::unique_ptr<FilterStrategy> filter) {
     m_filters.push_back(std::move(filter));
@@ -99,6 +422,59 @@ std::unique_ptr<FilterStrategy> AndFilter::clone() const {
     return clone;
 }
 
+void AndFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+bool AndFilter::selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const {
+    if (m_filters.empty()) {
+        handles.clear();
+        return true;
+    }
+    if (!m_filters.front()->selectIndexed(table, handles)) {
+        return false;
+    }
+    RoaringBitmap child;
+    for (size_t i = 1; i < m_filters.size(); ++i) {
+        if (!m_filters[i]->selectIndexed(table, child)) {
+            return false;
+        }
+        handles &= child;
+    }
+    return true;
+}
+
+RowBitmap AndFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    if (m_filters.empty()) {
+        return RowBitmap(batch.size()); // Matches nothing, as in matches()
+    }
+    
+    // Fully indexable: intersect the value bitmaps and never look at the rows
+    RoaringBitmap handles;
+    if (batch.table() && selectIndexed(*batch.table(), handles)) {
+        RowBitmap rows = batch.rowsOf(handles);
+        rows &= candidates;
+        return rows;
+    }
+    // Date ranges drive: the ordered date index answers them without touching other columns,
+    // so they run first and the remaining children only verify the rows in range
+    std::vector<const FilterStrategy*> order;
+    order.reserve(m_filters.size());
+    for (const auto& filter : m_filters) {
+        order.push_back(filter.get());
+    }
+    std::stable_partition(order.begin(), order.end(), [](const FilterStrategy* filter) {
+        return dynamic_cast<const DateRangeFilter*>(filter) != nullptr;
+    });
+    
+    // Each child only sees the rows every earlier child accepted
+    RowBitmap rows = candidates;
+    for (size_t i = 0; i < order.size() && !rows.none(); ++i) {
+        rows &= order[i]->refineBatch(batch, rows);
+    }
+    return rows;
+}
+
 // OrFilter Implementation
 void OrFilter::addFilter(std::unique_ptr<FilterStrategy> filter) {
     m_filters.push_back(std::move(filter));
@@ -121,25 +497,176 @@ std::unique_ptr<FilterStrategy> OrFilter::clone() const {
     return clone;
 }
 
+void OrFilter::accept(FilterVisitor& visitor) const {
+    visitor.visit(*this);
+}
+
+bool OrFilter::selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const {
+    handles.clear();
+    RoaringBitmap child;
+    for (const auto& filter : m_filters) {
+        if (!filter->selectIndexed(table, child)) {
+            return false;
+        }
+        handles |= child;
+    }
+    return true;
+}
+
+RowBitmap OrFilter::refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const {
+    // Fully indexable: union the value bitmaps and never look at the rows
+    RoaringBitmap handles;
+    if (batch.table() && selectIndexed(*batch.table(), handles)) {
+        RowBitmap rows = batch.rowsOf(handles);
+        rows &= candidates;
+        return rows;
+    }
+    
+    // Rows an earlier child accepted are not offered to later ones
+    RowBitmap rows(batch.size());
+    RowBitmap remaining = candidates;
+    for (size_t i = 0; i < m_filters.size() && !remaining.none(); ++i) {
+        RowBitmap accepted = m_filters[i]->refineBatch(batch, remaining);
+        rows |= accepted;
+        remaining.andNot(accepted);
+    }
+    return rows;
+}
+
 // ArtifactFilter Implementation
-ArtifactFilter::ArtifactFilter(std::unique_ptr<FilterStrategy> strategy)
-    : m_strategy(std::move(strategy)) {}
+ArtifactFilter::ArtifactFilter(std::unique_ptr<FilterStrategy> strategy, FilterExecution execution)
+    : m_strategy(std::move(strategy)), m_execution(execution) {}
 
 void ArtifactFilter::setStrategy(std::unique_ptr<FilterStrategy> strategy) {
     m_strategy = std::move(strategy);
 }
 
+void ArtifactFilter::setExecution(FilterExecution execution) {
+    m_execution = execution;
+}
+
+void ArtifactFilter::setParallelThreshold(size_t rows) {
+    m_parallelThreshold = std::max<size_t>(rows, 1);
+}
+
+void ArtifactFilter::setResultCache(FilterResultCache* cache) {
+    m_cache = cache;
+}
+
 std::vector<ArcheologicalArtifact> ArtifactFilter::filter(const std::vector<ArcheologicalArtifact>& artifacts) const {
     if (!m_strategy) {
         return artifacts; // Return all if no strategy is set
     }
     
+    return filter(ArtifactBatch(artifacts));
+}
+
+std::vector<ArcheologicalArtifact> ArtifactFilter::filter(const ArtifactBatch& batch) const {
     std::vector<ArcheologicalArtifact> result;
-    for (const auto& artifact : artifacts) {
-        if (m_strategy->matches(artifact)) {
-            result.push_back(artifact);
+    if (!m_strategy) {
+        RowBitmap rows = batch.liveRows();
+        result.reserve(rows.count());
+        rows.forEachSetBit([&batch, &result](size_t row) {
+            result.push_back(batch.artifact(row));
+        });
+        return result;
+    }
+    
+    std::unique_ptr<QueryPlan> plan = planFor(batch);
+    if (m_execution == FilterExecution::Parallel && batch.size() >= m_parallelThreshold) {
+        // Each chunk copies its own matches so the copying is parallel too
+        std::vector<std::vector<ArcheologicalArtifact>> parts;
+        selectParallel(batch, plan.get(), &parts);
+        
+        // Stitch the chunks back together in row order
+        size_t total = 0;
+        for (const auto& part : parts) {
+            total += part.size();
+        }
+        result.reserve(total);
+        for (auto& part : parts) {
+            std::move(part.begin(), part.end(), std::back_inserter(result));
         }
+        return result;
     }
     
+    // One bitmap for the whole batch; AND/OR combine child bitmaps word by word
+    RowBitmap rows = plan ? plan->execute(batch, m_cache) : m_strategy->matchBatch(batch);
+    result.reserve(rows.count());
+    rows.forEachSetBit([&batch, &result](size_t row) {
+        result.push_back(batch.artifact(row));
+    });
     return result;
 }
+
+RowBitmap ArtifactFilter::select(const ArtifactBatch& batch) const {
+    if (!m_strategy) {
+        return batch.liveRows();
+    }
+    
+    std::unique_ptr<QueryPlan> plan = planFor(batch);
+    if (m_execution == FilterExecution::Parallel && batch.size() >= m_parallelThreshold) {
+        return selectParallel(batch, plan.get(), nullptr);
+    }
+    return plan ? plan->execute(batch, m_cache) : m_strategy->matchBatch(batch);
+}
+
+std::unique_ptr<QueryPlan> ArtifactFilter::planFor(const ArtifactBatch& batch) const {
+    // Over a table, plan once: conjuncts by selectivity, index paths where they pay off
+    if (const ArtifactTable* table = batch.table()) {
+        return std::make_unique<QueryPlan>(QueryPlanner(*table, m_cache).plan(*m_strategy));
+    }
+    return nullptr;
+}
+
+RowBitmap ArtifactFilter::selectParallel(const ArtifactBatch& batch, const QueryPlan* plan,
+                                         std::vector<std::vector<ArcheologicalArtifact>>* parts) const {
+    QThreadPool* pool = QThreadPool::globalInstance();
+    
+    // A few chunks per worker evens out uneven rows; chunks are whole bitmap words
+    const size_t workers = static_cast<size_t>(std::max(1, pool->maxThreadCount()));
+    const size_t minimumChunk = 1024;
+    size_t chunkRows = std::max(minimumChunk, (batch.size() + workers * 4 - 1) / (workers * 4));
+    chunkRows = (chunkRows + 63) / 64 * 64;
+    const size_t chunkCount = (batch.size() + chunkRows - 1) / chunkRows;
+    
+    // Chunks do not touch the cache; the whole result is stored once they are done.
+    // Chunks are whole words, so each one writes its own words of the merged bitmap.
+    const bool store = m_cache && plan && batch.coversTable() && !plan->root().key.isEmpty() &&
+                       plan->root().path != AccessPath::Cache;
+    RowBitmap merged(store || !parts ? batch.size() : 0);
+    if (parts) {
+        parts->assign(chunkCount, {});
+    }
+    
+    auto evaluate = [this, &batch, &merged, plan, parts, chunkRows](size_t chunk) {
+        size_t begin = chunk * chunkRows;
+        ArtifactBatch slice(batch, begin, std::min(chunkRows, batch.size() - begin));
+        RowBitmap rows = plan ? plan->execute(slice) : m_strategy->matchBatch(slice);
+        if (merged.size()) {
+            std::copy(rows.words(), rows.words() + rows.wordCount(), merged.words() + begin / 64);
+        }
+        if (parts) {
+            std::vector<ArcheologicalArtifact>& part = (*parts)[chunk];
+            part.reserve(rows.count());
+            rows.forEachSetBit([&slice, &part](size_t row) {
+                part.push_back(slice.artifact(row));
+            });
+        }
+    };
+    
+    // The calling thread takes chunk 0 instead of idling until the pool is done
+    QSemaphore finished;
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+        pool->start([&evaluate, &finished, chunk]() {
+            evaluate(chunk);
+            finished.release();
+        });
+    }
+    evaluate(0);
+    finished.acquire(static_cast<int>(chunkCount - 1));
+    if (store) {
+        m_cache->insert(plan->root().key, merged);
+    }
+    return merged;
+}
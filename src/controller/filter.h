@@ -2,17 +2,36 @@
 #define FILTER_H
 
 #include "../domain/artifact.h"
+#include "../index/artifact_batch.h"
+#include "../index/roaring_bitmap.h"
+#include "../index/approximate_search.h"
+#include "../index/full_text_index.h"
+#include "../index/regex_search.h"
 #include <vector>
 #include <memory>
 #include <QString>
 #include <QDate>
 
+class FilterVisitor;
+class QueryPlan;
+class FilterResultCache;
+
 // Strategy interface for filtering
 class FilterStrategy {
 public:
     virtual ~FilterStrategy() = default;
     virtual bool matches(const ArcheologicalArtifact& artifact) const = 0;
     virtual std::unique_ptr<FilterStrategy> clone() const = 0;
+    // Lets compilers/planners inspect the tree; unknown strategies are reported through visitOther()
+    virtual void accept(FilterVisitor& visitor) const;
+    // Evaluates the filter for every row of the batch at once; bit i is set when row i matches
+    RowBitmap matchBatch(const ArtifactBatch& batch) const;
+    // Same, restricted to the candidate rows: the result is a subset of candidates and rows
+    // outside them need not be evaluated. The default calls matches() per candidate row.
+    virtual RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const;
+    // Answers the filter from the table's value indexes alone, as a set of handles.
+    // Returns false (leaving handles unspecified) when some part of the filter is not indexable.
+    virtual bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const;
 };
 
 // Concrete filter strategies
@@ -21,6 +40,11 @@ public:
     explicit NameFilter(const QString& name, bool caseSensitive = false);
     bool matches(const ArcheologicalArtifact& artifact) const override;
     std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+
+    const QString& name() const { return m_name; }
+    bool caseSensitive() const { return m_caseSensitive; }
 
 private:
     QString m_name;
@@ -29,24 +53,56 @@ private:
 
 class MaterialFilter : public FilterStrategy {
 public:
-    explicit MaterialFilter(const QString& material, bool caseSensitive = false);
+    explicit MaterialFilter(const QString& material, bool caseSensitive = false, TextMatch match = TextMatch::Contains);
     bool matches(const ArcheologicalArtifact& artifact) const override;
     std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+    bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const override;
+
+    const QString& material() const { return m_material; }
+    bool caseSensitive() const { return m_caseSensitive; }
+    TextMatch match() const { return m_match; }
 
 private:
     QString m_material;
     bool m_caseSensitive;
+    TextMatch m_match;
 };
 
 class LocationFilter : public FilterStrategy {
 public:
-    explicit LocationFilter(const QString& location, bool caseSensitive = false);
+    explicit LocationFilter(const QString& location, bool caseSensitive = false, TextMatch match = TextMatch::Contains);
     bool matches(const ArcheologicalArtifact& artifact) const override;
     std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+    bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const override;
+
+    const QString& location() const { return m_location; }
+    bool caseSensitive() const { return m_caseSensitive; }
+    TextMatch match() const { return m_match; }
 
 private:
     QString m_location;
     bool m_caseSensitive;
+    TextMatch m_match;
+};
+
+class DescriptionFilter : public FilterStrategy {
+public:
+    explicit DescriptionFilter(const QString& description, bool caseSensitive = false);
+    bool matches(const ArcheologicalArtifact& artifact) const override;
+    std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+
+    const QString& description() const { return m_description; }
+    bool caseSensitive() const { return m_caseSensitive; }
+
+private:
+    QString m_description;
+    bool m_caseSensitive;
 };
 
 class DateRangeFilter : public FilterStrategy {
@@ -54,6 +110,11 @@ public:
     DateRangeFilter(const QDate& startDate, const QDate& endDate);
     bool matches(const ArcheologicalArtifact& artifact) const override;
     std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+
+    const QDate& startDate() const { return m_startDate; }
+    const QDate& endDate() const { return m_endDate; }
 
 private:
     QDate m_startDate;
@@ -65,18 +126,128 @@ public:
     explicit IdFilter(const QString& id, bool caseSensitive = false);
     bool matches(const ArcheologicalArtifact& artifact) const override;
     std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+
+    const QString& id() const { return m_id; }
+    bool caseSensitive() const { return m_caseSensitive; }
 
 private:
     QString m_id;
     bool m_caseSensitive;
 };
 
+// Names holding the given name within maxEdits insertions, deletions or substitutions, ignoring
+// case, so that misspellings still match: "amfora" finds "Amphora" with two edits.
+class FuzzyNameFilter : public FilterStrategy {
+public:
+    explicit FuzzyNameFilter(const QString& name, int maxEdits = 1);
+    // Edit budget for a typed name: none below four characters, where anything would match
+    static int suggestedEdits(const QString& name);
+    bool matches(const ArcheologicalArtifact& artifact) const override;
+    std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+
+    const QString& name() const { return m_name; }
+    int maxEdits() const { return m_search.maxEdits(); }
+
+private:
+    QString m_name;
+    ApproximateSearch m_search;
+};
+
+// Descriptions holding every word of the query, quoted phrases word for word, with words as
+// FullTextIndex splits them. Over a table the full-text index answers it, and rank() orders
+// the matches by relevance.
+class DescriptionSearch : public FilterStrategy {
+public:
+    explicit DescriptionSearch(const QString& query);
+    bool matches(const ArcheologicalArtifact& artifact) const override;
+    std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+    bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const override;
+
+    // The limit best matches in the table by BM25, best first
+    std::vector<FullTextIndex::Hit> rank(const ArtifactTable& table, size_t limit) const;
+
+    const QString& text() const { return m_text; }
+    const FullTextQuery& query() const { return m_query; }
+
+private:
+    QString m_text;
+    FullTextQuery m_query;
+};
+
+// Text of any field that a regular expression (QRegularExpression syntax) matches somewhere.
+// The pattern is compiled once per filter; see RegexSearch for the literal prefilter.
+// Throws std::invalid_argument for a pattern that does not compile.
+class RegexFilter : public FilterStrategy {
+public:
+    RegexFilter(ArtifactField field, const QString& pattern, bool caseSensitive = false);
+    bool matches(const ArcheologicalArtifact& artifact) const override;
+    std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+
+    ArtifactField field() const { return m_field; }
+    const QString& pattern() const { return m_search.pattern(); }
+    bool caseSensitive() const { return m_search.sensitivity() == Qt::CaseSensitive; }
+    const RegexSearch& search() const { return m_search; }
+
+private:
+    ArtifactField m_field;
+    RegexSearch m_search;
+};
+
+// Artifacts whose coordinates lie in a latitude/longitude box; those without coordinates never match.
+// Over a table the box is read from its R-tree instead of scanning.
+class BoundingBoxFilter : public FilterStrategy {
+public:
+    explicit BoundingBoxFilter(const GeoBox& box); // Throws std::invalid_argument for a null box
+    bool matches(const ArcheologicalArtifact& artifact) const override;
+    std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+    bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const override;
+
+    const GeoBox& box() const { return m_box; }
+
+private:
+    GeoBox m_box;
+};
+
+// Artifacts within a great-circle distance of a point, read from the table's R-tree like the box
+class RadiusFilter : public FilterStrategy {
+public:
+    // Throws std::invalid_argument for a null center or a negative radius
+    RadiusFilter(const GeoPoint& center, double radiusKm);
+    bool matches(const ArcheologicalArtifact& artifact) const override;
+    std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+    bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const override;
+
+    const GeoPoint& center() const { return m_center; }
+    double radiusKm() const { return m_radiusKm; }
+
+private:
+    GeoPoint m_center;
+    double m_radiusKm;
+};
+
 // Composite filters for AND/OR operations
 class AndFilter : public FilterStrategy {
 public:
     void addFilter(std::unique_ptr<FilterStrategy> filter);
     bool matches(const ArcheologicalArtifact& artifact) const override;
     std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+    bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const override;
+
+    const std::vector<std::unique_ptr<FilterStrategy>>& filters() const { return m_filters; }
 
 private:
     std::vector<std::unique_ptr<FilterStrategy>> m_filters;
@@ -87,22 +258,77 @@ public:
     void addFilter(std::unique_ptr<FilterStrategy> filter);
     bool matches(const ArcheologicalArtifact& artifact) const override;
     std::unique_ptr<FilterStrategy> clone() const override;
+    void accept(FilterVisitor& visitor) const override;
+    RowBitmap refineBatch(const ArtifactBatch& batch, const RowBitmap& candidates) const override;
+    bool selectIndexed(const ArtifactTable& table, RoaringBitmap& handles) const override;
+
+    const std::vector<std::unique_ptr<FilterStrategy>>& filters() const { return m_filters; }
 
 private:
     std::vector<std::unique_ptr<FilterStrategy>> m_filters;
 };
 
+// Visitor over the filter tree. Each visit defaults to visitOther(), so a visitor
+// only overrides the node types it understands.
+class FilterVisitor {
+public:
+    virtual ~FilterVisitor() = default;
+    virtual void visit(const NameFilter& filter) { visitOther(filter); }
+    virtual void visit(const MaterialFilter& filter) { visitOther(filter); }
+    virtual void visit(const LocationFilter& filter) { visitOther(filter); }
+    virtual void visit(const DescriptionFilter& filter) { visitOther(filter); }
+    virtual void visit(const DateRangeFilter& filter) { visitOther(filter); }
+    virtual void visit(const IdFilter& filter) { visitOther(filter); }
+    virtual void visit(const FuzzyNameFilter& filter) { visitOther(filter); }
+    virtual void visit(const DescriptionSearch& filter) { visitOther(filter); }
+    virtual void visit(const RegexFilter& filter) { visitOther(filter); }
+    virtual void visit(const BoundingBoxFilter& filter) { visitOther(filter); }
+    virtual void visit(const RadiusFilter& filter) { visitOther(filter); }
+    virtual void visit(const AndFilter& filter) { visitOther(filter); }
+    virtual void visit(const OrFilter& filter) { visitOther(filter); }
+    virtual void visitOther(const FilterStrategy& filter) = 0;
+};
+
+// How ArtifactFilter evaluates a batch. Parallel splits the rows into chunks on
+// QThreadPool::globalInstance() and is still serial below the parallel threshold.
+// Strategies must then be safe to call concurrently through their const interface,
+// which all strategies in this file are.
+enum class FilterExecution {
+    Serial,
+    Parallel
+};
+
 // Filter context that applies the strategy
 class ArtifactFilter {
 public:
+    static constexpr size_t DefaultParallelThreshold = 16384; // Rows
+
     ArtifactFilter() = default;
-    explicit ArtifactFilter(std::unique_ptr<FilterStrategy> strategy);
+    explicit ArtifactFilter(std::unique_ptr<FilterStrategy> strategy,
+                            FilterExecution execution = FilterExecution::Serial);
     
     void setStrategy(std::unique_ptr<FilterStrategy> strategy);
+    void setExecution(FilterExecution execution);
+    void setParallelThreshold(size_t rows); // At least 1, so an empty batch never goes to the pool
+    // Results over a table are looked up in and stored to the cache; nullptr disables it.
+    // The cache is not owned and must outlive the filter.
+    void setResultCache(FilterResultCache* cache);
     std::vector<ArcheologicalArtifact> filter(const std::vector<ArcheologicalArtifact>& artifacts) const;
+    std::vector<ArcheologicalArtifact> filter(const ArtifactBatch& batch) const;
+    // Same, as the matching rows of the batch; without a strategy every row matches
+    RowBitmap select(const ArtifactBatch& batch) const;
 
 private:
+    std::unique_ptr<QueryPlan> planFor(const ArtifactBatch& batch) const; // nullptr unless over a table
+    // Evaluates the chunks on the thread pool. With parts, each chunk also copies its matches
+    // into its part; the merged bitmap is only built when returned or cached (empty otherwise).
+    RowBitmap selectParallel(const ArtifactBatch& batch, const QueryPlan* plan,
+                             std::vector<std::vector<ArcheologicalArtifact>>* parts) const;
+
     std::unique_ptr<FilterStrategy> m_strategy;
+    FilterExecution m_execution = FilterExecution::Serial;
+    size_t m_parallelThreshold = DefaultParallelThreshold;
+    FilterResultCache* m_cache = nullptr;
 };
 
 #endif // FILTER_H
@@ -0,0 +1,275 @@
+#include "filter_program.h"
+#include <QStringList>
+
+namespace {
+
+struct Exit {
+    int instruction;
+    bool onTrue;
+};
+
+// Code emitted for one subtree: an entry point plus the dangling exits still to be patched.
+// A folded subtree emits no code and only carries its constant.
+struct Fragment {
+    int entry = -1;
+    int constant = -1; // -1: not constant, 0: always false, 1: always true
+    std::vector<Exit> trueExits;
+    std::vector<Exit> falseExits;
+};
+
+Fragment constantFragment(bool value) {
+    Fragment fragment;
+    fragment.constant = value ? 1 : 0;
+    return fragment;
+}
+
+QString fieldName(ArtifactField field) {
+    switch (field) {
+    case ArtifactField::Id: return "id";
+    case ArtifactField::Name: return "name";
+    case ArtifactField::Description: return "description";
+    case ArtifactField::Material: return "material";
+    case ArtifactField::DiscoveryDate: return "discoveryDate";
+    case ArtifactField::Location: return "location";
+    case ArtifactField::Coordinates: return "coordinates";
+    }
+    return QString();
+}
+
+QString targetName(int target) {
+    if (target == -1) return "accept";
+    if (target == -2) return "reject";
+    return QString::number(target);
+}
+
+} // namespace
+
+class FilterCompiler : public FilterVisitor {
+public:
+    explicit FilterCompiler(FilterProgram& program) : m_program(program) {}
+
+    Fragment compile(const FilterStrategy& filter) {
+        filter.accept(*this);
+        return m_result;
+    }
+
+    void patch(const std::vector<Exit>& exits, int target) {
+        for (const Exit& exit : exits) {
+            FilterProgram::Instruction& instruction = m_program.m_code[exit.instruction];
+            (exit.onTrue ? instruction.onTrue : instruction.onFalse) = target;
+        }
+    }
+
+    void visit(const NameFilter& filter) override {
+        text(ArtifactField::Name, &ArcheologicalArtifact::getName, filter.name(), filter.caseSensitive());
+    }
+    void visit(const MaterialFilter& filter) override {
+        text(ArtifactField::Material, &ArcheologicalArtifact::getMaterial, filter.material(), filter.caseSensitive(),
+             filter.match());
+    }
+    void visit(const LocationFilter& filter) override {
+        text(ArtifactField::Location, &ArcheologicalArtifact::getLocation, filter.location(), filter.caseSensitive(),
+             filter.match());
+    }
+    void visit(const DescriptionFilter& filter) override {
+        text(ArtifactField::Description, &ArcheologicalArtifact::getDescription, filter.description(),
+             filter.caseSensitive());
+    }
+    void visit(const IdFilter& filter) override {
+        text(ArtifactField::Id, &ArcheologicalArtifact::getId, filter.id(), filter.caseSensitive());
+    }
+
+    void visit(const DateRangeFilter& filter) override {
+        // QDate compares Julian days, invalid dates included, so this is the same test
+        qint64 low = filter.startDate().toJulianDay();
+        qint64 high = filter.endDate().toJulianDay();
+        if (low > high) {
+            m_result = constantFragment(false);
+            return;
+        }
+        FilterProgram::Instruction instruction = blank(FilterProgram::Op::DateInRange, ArtifactField::DiscoveryDate);
+        instruction.low = low;
+        instruction.high = high;
+        m_result = leaf(instruction);
+    }
+
+    void visit(const AndFilter& filter) override { composite(filter.filters(), true); }
+    void visit(const OrFilter& filter) override { composite(filter.filters(), false); }
+
+    void visitOther(const FilterStrategy& filter) override {
+        FilterProgram::Instruction instruction = blank(FilterProgram::Op::CallStrategy, ArtifactField::Id);
+        instruction.operand = static_cast<quint32>(m_program.m_calls.size());
+        m_program.m_calls.push_back(&filter);
+        m_result = leaf(instruction);
+    }
+
+private:
+    FilterProgram::Instruction blank(FilterProgram::Op op, ArtifactField field) const {
+        return FilterProgram::Instruction{op, field, nullptr, 0, 0, 0, FilterProgram::Reject, FilterProgram::Reject};
+    }
+
+    Fragment leaf(const FilterProgram::Instruction& instruction) {
+        Fragment fragment;
+        fragment.entry = static_cast<int>(m_program.m_code.size());
+        fragment.trueExits.push_back({fragment.entry, true});
+        fragment.falseExits.push_back({fragment.entry, false});
+        m_program.m_code.push_back(instruction);
+        return fragment;
+    }
+
+    void text(ArtifactField field, const QString& (ArcheologicalArtifact::*accessor)() const,
+              const QString& needle, bool caseSensitive, TextMatch match = TextMatch::Contains) {
+        if (needle.isEmpty() && match == TextMatch::Contains) {
+            m_result = constantFragment(true); // Every string contains the empty string
+            return;
+        }
+        FilterProgram::Op op;
+        if (match == TextMatch::Equals) {
+            op = caseSensitive ? FilterProgram::Op::Equals : FilterProgram::Op::EqualsCaseInsensitive;
+        } else {
+            op = caseSensitive ? FilterProgram::Op::Contains : FilterProgram::Op::ContainsCaseInsensitive;
+        }
+        FilterProgram::Instruction instruction = blank(op, field);
+        instruction.text = accessor;
+        instruction.operand = static_cast<quint32>(m_program.m_constants.size());
+        m_program.m_constants.push_back(needle);
+        m_result = leaf(instruction);
+    }
+
+    // AND chains children through their true exits, OR through their false exits.
+    // A child that folds to the absorbing constant discards the code emitted so far.
+    void composite(const std::vector<std::unique_ptr<FilterStrategy>>& children, bool isAnd) {
+        if (children.empty()) {
+            m_result = constantFragment(false); // Matches AndFilter/OrFilter with no children
+            return;
+        }
+
+        const size_t mark = m_program.m_code.size();
+        Fragment combined;
+        bool haveCode = false;
+        for (const auto& child : children) {
+            Fragment fragment = compile(*child);
+            if (fragment.constant >= 0) {
+                if ((fragment.constant == 1) != isAnd) {
+                    m_program.m_code.resize(mark);
+                    m_result = constantFragment(!isAnd);
+                    return;
+                }
+                continue; // Identity element, nothing to chain
+            }
+
+            if (!haveCode) {
+                combined = fragment;
+                haveCode = true;
+                continue;
+            }
+
+            std::vector<Exit>& chained = isAnd ? combined.trueExits : combined.falseExits;
+            patch(chained, fragment.entry);
+            chained = isAnd ? fragment.trueExits : fragment.falseExits;
+            std::vector<Exit>& passed = isAnd ? combined.falseExits : combined.trueExits;
+            const std::vector<Exit>& more = isAnd ? fragment.falseExits : fragment.trueExits;
+            passed.insert(passed.end(), more.begin(), more.end());
+        }
+
+        m_result = haveCode ? combined : constantFragment(isAnd);
+    }
+
+    FilterProgram& m_program;
+    Fragment m_result;
+};
+
+FilterProgram FilterProgram::compile(const FilterStrategy& filter) {
+    FilterProgram program;
+    program.m_source = filter.clone();
+
+    FilterCompiler compiler(program);
+    Fragment root = compiler.compile(*program.m_source);
+    if (root.constant >= 0) {
+        program.m_code.clear();
+        program.m_constantResult = root.constant == 1;
+    } else {
+        program.m_entry = root.entry;
+        compiler.patch(root.trueExits, Accept);
+        compiler.patch(root.falseExits, Reject);
+    }
+    return program;
+}
+
+bool FilterProgram::matches(const ArcheologicalArtifact& artifact) const {
+    if (m_code.empty()) {
+        return m_constantResult;
+    }
+
+    int pc = m_entry;
+    while (pc >= 0) {
+        const Instruction& instruction = m_code[pc];
+        bool result = false;
+        switch (instruction.op) {
+        case Op::Contains:
+            result = (artifact.*instruction.text)().contains(m_constants[instruction.operand], Qt::CaseSensitive);
+            break;
+        case Op::ContainsCaseInsensitive:
+            result = (artifact.*instruction.text)().contains(m_constants[instruction.operand], Qt::CaseInsensitive);
+            break;
+        case Op::Equals:
+            result = (artifact.*instruction.text)().compare(m_constants[instruction.operand], Qt::CaseSensitive) == 0;
+            break;
+        case Op::EqualsCaseInsensitive:
+            result = (artifact.*instruction.text)().compare(m_constants[instruction.operand], Qt::CaseInsensitive) == 0;
+            break;
+        case Op::DateInRange: {
+            qint64 day = artifact.getDiscoveryDate().toJulianDay();
+            result = day >= instruction.low && day <= instruction.high;
+            break;
+        }
+        case Op::CallStrategy:
+            result = m_calls[instruction.operand]->matches(artifact);
+            break;
+        }
+        pc = result ? instruction.onTrue : instruction.onFalse;
+    }
+    return pc == Accept;
+}
+
+size_t FilterProgram::instructionCount() const {
+    return m_code.size();
+}
+
+bool FilterProgram::isConstant() const {
+    return m_code.empty();
+}
+
+QString FilterProgram::disassemble() const {
+    if (m_code.empty()) {
+        return m_constantResult ? "const true" : "const false";
+    }
+
+    QStringList lines;
+    for (size_t i = 0; i < m_code.size(); ++i) {
+        const Instruction& instruction = m_code[i];
+        QString test;
+        switch (instruction.op) {
+        case Op::Contains:
+            test = QString("%1 contains '%2'").arg(fieldName(instruction.field), m_constants[instruction.operand]);
+            break;
+        case Op::ContainsCaseInsensitive:
+            test = QString("%1 icontains '%2'").arg(fieldName(instruction.field), m_constants[instruction.operand]);
+            break;
+        case Op::Equals:
+            test = QString("%1 == '%2'").arg(fieldName(instruction.field), m_constants[instruction.operand]);
+            break;
+        case Op::EqualsCaseInsensitive:
+            test = QString("%1 i== '%2'").arg(fieldName(instruction.field), m_constants[instruction.operand]);
+            break;
+        case Op::DateInRange:
+            test = QString("discoveryDate in [%1, %2]").arg(instruction.low).arg(instruction.high);
+            break;
+        case Op::CallStrategy:
+            test = QString("call #%1").arg(instruction.operand);
+            break;
+        }
+        lines << QString("%1: %2 ? %3 : %4").arg(i).arg(test, targetName(instruction.onTrue), targetName(instruction.onFalse));
+    }
+    return lines.join("\n");
+}
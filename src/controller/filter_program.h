@@ -0,0 +1,61 @@
+#ifndef FILTER_PROGRAM_H
+#define FILTER_PROGRAM_H
+
+#include "filter.h"
+#include "../domain/artifact.h"
+#include <vector>
+#include <memory>
+#include <QString>
+
+// A FilterStrategy tree lowered to a flat decision program.
+// Every instruction is a single leaf test with one jump target per outcome, so
+// AndFilter/OrFilter nodes disappear: AND chains children on true, OR on false.
+// Field accessors and constants are resolved at compile time and evaluation does
+// not allocate. Strategies the compiler does not know are still called virtually.
+class FilterProgram {
+public:
+    static FilterProgram compile(const FilterStrategy& filter);
+
+    bool matches(const ArcheologicalArtifact& artifact) const;
+
+    size_t instructionCount() const;
+    bool isConstant() const; // The whole tree folded to always-true or always-false
+    QString disassemble() const;
+
+private:
+    friend class FilterCompiler;
+
+    enum class Op : quint8 {
+        Contains,                // Case-sensitive substring test
+        ContainsCaseInsensitive,
+        Equals,                  // Whole-value comparison
+        EqualsCaseInsensitive,
+        DateInRange,             // Julian day in [low, high]
+        CallStrategy             // Fallback: virtual matches() of an unknown leaf
+    };
+
+    static constexpr int Accept = -1;
+    static constexpr int Reject = -2;
+
+    struct Instruction {
+        Op op;
+        ArtifactField field;
+        const QString& (ArcheologicalArtifact::*text)() const; // Accessor for the Contains ops
+        quint32 operand;                                       // Constant or strategy index
+        qint64 low;
+        qint64 high;
+        int onTrue;
+        int onFalse;
+    };
+
+    FilterProgram() = default;
+
+    std::vector<Instruction> m_code;
+    int m_entry = 0;
+    std::vector<QString> m_constants;
+    std::vector<const FilterStrategy*> m_calls; // Point into m_source
+    std::unique_ptr<FilterStrategy> m_source;
+    bool m_constantResult = false; // Result when m_code is empty
+};
+
+#endif // FILTER_PROGRAM_H
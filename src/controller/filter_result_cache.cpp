@@ -0,0 +1,60 @@
+#include "filter_result_cache.h"
+
+FilterResultCache::FilterResultCache(size_t capacity) : m_capacity(capacity) {}
+
+void FilterResultCache::sync(const ArtifactTable& table) {
+    if (m_table != &table || m_version != table.version()) {
+        clear();
+        m_table = &table;
+        m_version = table.version();
+    }
+}
+
+std::shared_ptr<const RowBitmap> FilterResultCache::lookup(const QString& key) {
+    auto entry = m_index.constFind(key);
+    if (entry == m_index.constEnd()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, entry.value());
+    return m_entries.front().second;
+}
+
+void FilterResultCache::insert(const QString& key, RowBitmap rows) {
+    if (m_capacity == 0) {
+        return;
+    }
+    auto entry = m_index.constFind(key);
+    if (entry != m_index.constEnd()) {
+        m_entries.erase(entry.value());
+    }
+    m_entries.emplace_front(key, std::make_shared<const RowBitmap>(std::move(rows)));
+    m_index.insert(key, m_entries.begin());
+    evict();
+}
+
+void FilterResultCache::clear() {
+    m_entries.clear();
+    m_index.clear();
+}
+
+size_t FilterResultCache::size() const {
+    return m_entries.size();
+}
+
+size_t FilterResultCache::capacity() const {
+    return m_capacity;
+}
+
+void FilterResultCache::setCapacity(size_t capacity) {
+    m_capacity = capacity;
+    evict();
+}
+
+void FilterResultCache::evict() {
+    while (m_entries.size() > m_capacity) {
+        m_index.remove(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
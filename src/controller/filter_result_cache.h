@@ -0,0 +1,51 @@
+#ifndef FILTER_RESULT_CACHE_H
+#define FILTER_RESULT_CACHE_H
+
+#include "../index/artifact_table.h"
+#include "../index/row_bitmap.h"
+#include <QHash>
+#include <QString>
+#include <list>
+#include <memory>
+#include <utility>
+
+// LRU cache of filter results over one ArtifactTable, keyed by the canonical form of a
+// filter tree (QueryPlan::Node::key). Results are the matching table rows and are only
+// valid at the table version they were computed for; sync() drops them once the table
+// has changed. Not thread-safe: plans copy the entries they use, so workers never touch it.
+class FilterResultCache {
+public:
+    static constexpr size_t DefaultCapacity = 64; // Entries
+
+    explicit FilterResultCache(size_t capacity = DefaultCapacity);
+
+    // Empties the cache unless its entries were computed for this table at its current version
+    void sync(const ArtifactTable& table);
+
+    // nullptr on a miss; a hit becomes the most recently used entry
+    std::shared_ptr<const RowBitmap> lookup(const QString& key);
+    // Evicts the least recently used entry when full. rows must cover the synced table.
+    void insert(const QString& key, RowBitmap rows);
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const;
+    void setCapacity(size_t capacity);
+    size_t hits() const { return m_hits; }
+    size_t misses() const { return m_misses; }
+
+private:
+    using Entry = std::pair<QString, std::shared_ptr<const RowBitmap>>;
+
+    void evict();
+
+    std::list<Entry> m_entries; // Most recently used first
+    QHash<QString, std::list<Entry>::iterator> m_index;
+    size_t m_capacity;
+    const ArtifactTable* m_table = nullptr;
+    quint64 m_version = 0;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+};
+
+#endif // FILTER_RESULT_CACHE_H
@@ -0,0 +1,169 @@
+#include "live_view.h"
+#include <algorithm>
+
+LiveView::LiveView(Repository& repository, const ArtifactTable& table, FilterResultCache* cache)
+    : m_repository(repository), m_table(table), m_cache(cache) {
+    m_repository.addObserver(this);
+    setFilter(nullptr);
+}
+
+LiveView::~LiveView() {
+    m_repository.removeObserver(this);
+}
+
+void LiveView::setFilter(std::unique_ptr<FilterStrategy> filter, FilterExecution execution) {
+    if (m_listener) {
+        m_listener->beginReset();
+    }
+    // The table is filtered once as a whole; from then on only changed rows are evaluated
+    m_program = filter ? std::make_unique<FilterProgram>(FilterProgram::compile(*filter)) : nullptr;
+    ArtifactFilter artifactFilter(std::move(filter), execution);
+    artifactFilter.setResultCache(m_cache);
+    RowBitmap rows = artifactFilter.select(ArtifactBatch(m_table));
+
+    m_handles.clear();
+    m_handles.reserve(rows.count());
+    m_member.assign(m_member.size(), false);
+    rows.forEachSetBit([this](size_t row) {
+        m_handles.push_back(m_table.handle(row));
+        setMember(m_handles.back(), true);
+    });
+    if (m_memberListener) {
+        m_memberListener->membersReset(*this);
+    }
+    if (m_listener) {
+        m_listener->endReset();
+    }
+}
+
+void LiveView::setListener(LiveViewListener* listener) {
+    m_listener = listener;
+}
+
+void LiveView::setMemberListener(LiveViewMemberListener* listener) {
+    m_memberListener = listener;
+    if (m_memberListener) {
+        m_memberListener->membersReset(*this);
+    }
+}
+
+size_t LiveView::size() const {
+    return m_handles.size();
+}
+
+ArtifactHandle LiveView::handle(size_t position) const {
+    return m_handles[position];
+}
+
+const ArcheologicalArtifact& LiveView::artifact(size_t position) const {
+    return m_table.artifact(static_cast<size_t>(m_table.rowOf(m_handles[position])));
+}
+
+int LiveView::positionOf(ArtifactHandle handle) const {
+    if (!isMember(handle)) {
+        return -1;
+    }
+    return static_cast<int>(insertionPoint(m_table.rowOf(handle)));
+}
+
+void LiveView::onArtifactChanged(const ArtifactChangeSet& change) {
+    const ArtifactHandle handle = change.handle();
+    switch (change.kind()) {
+    case ArtifactChangeSet::Kind::Added: {
+        // The table appends, so a matching artifact comes last
+        int row = m_table.rowOf(handle);
+        if (row >= 0 && matches(m_table.artifact(static_cast<size_t>(row)))) {
+            if (m_memberListener) {
+                m_memberListener->memberEntered(m_table.artifact(static_cast<size_t>(row)));
+            }
+            insertAt(insertionPoint(row), handle);
+        }
+        break;
+    }
+    case ArtifactChangeSet::Kind::Removed: {
+        if (isMember(handle)) {
+            // The table leaves a tombstone in the row, so the others keep theirs around it
+            size_t position = insertionPoint(m_table.rowOf(handle));
+            if (m_memberListener) {
+                ArcheologicalArtifact removed; // Removed change sets carry every old value
+                change.revert(removed);
+                m_memberListener->memberLeft(removed);
+            }
+            removeAt(position);
+        }
+        break;
+    }
+    case ArtifactChangeSet::Kind::Updated: {
+        int row = m_table.rowOf(handle);
+        if (row < 0) {
+            break;
+        }
+        const ArcheologicalArtifact& artifact = m_table.artifact(static_cast<size_t>(row));
+        bool wasMember = isMember(handle);
+        bool member = matches(artifact);
+        size_t position = insertionPoint(row);
+        if (m_memberListener && wasMember) {
+            ArcheologicalArtifact before = artifact;
+            change.revert(before);
+            m_memberListener->memberLeft(before);
+        }
+        if (m_memberListener && member) {
+            m_memberListener->memberEntered(artifact);
+        }
+        if (wasMember && member) {
+            if (m_listener) {
+                m_listener->rowChanged(position);
+            }
+        } else if (wasMember) {
+            removeAt(position);
+        } else if (member) {
+            insertAt(position, handle);
+        }
+        break;
+    }
+    }
+}
+
+bool LiveView::matches(const ArcheologicalArtifact& artifact) const {
+    return !m_program || m_program->matches(artifact);
+}
+
+bool LiveView::isMember(ArtifactHandle handle) const {
+    return handle < m_member.size() && m_member[handle];
+}
+
+void LiveView::setMember(ArtifactHandle handle, bool member) {
+    if (handle >= m_member.size()) {
+        m_member.resize(handle + 1, false);
+    }
+    m_member[handle] = member;
+}
+
+size_t LiveView::insertionPoint(int row) const {
+    auto it = std::lower_bound(m_handles.begin(), m_handles.end(), row, [this](ArtifactHandle member, int value) {
+        return m_table.rowOf(member) < value;
+    });
+    return static_cast<size_t>(it - m_handles.begin());
+}
+
+void LiveView::insertAt(size_t position, ArtifactHandle handle) {
+    if (m_listener) {
+        m_listener->beginInsert(position);
+    }
+    m_handles.insert(m_handles.begin() + static_cast<std::ptrdiff_t>(position), handle);
+    setMember(handle, true);
+    if (m_listener) {
+        m_listener->endInsert();
+    }
+}
+
+void LiveView::removeAt(size_t position) {
+    if (m_listener) {
+        m_listener->beginRemove(position);
+    }
+    setMember(m_handles[position], false);
+    m_handles.erase(m_handles.begin() + static_cast<std::ptrdiff_t>(position));
+    if (m_listener) {
+        m_listener->endRemove();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef LIVE_VIEW_H
+#define LIVE_VIEW_H
+
+#include "filter.h"
+#include "filter_program.h"
+#include "filter_result_cache.h"
+#include "../repository/repository.h"
+#include "../index/artifact_table.h"
+#include <vector>
+#include <memory>
+
+// Receives the row-level edits of a LiveView, e.g. to forward them to a Qt item model.
+// Each begin call comes before the view changes and its end call after.
+class LiveViewListener {
+public:
+    virtual ~LiveViewListener() = default;
+    virtual void beginInsert(size_t position) = 0;
+    virtual void endInsert() = 0;
+    virtual void beginRemove(size_t position) = 0;
+    virtual void endRemove() = 0;
+    virtual void rowChanged(size_t position) = 0;
+    virtual void beginReset() = 0;
+    virtual void endReset() = 0;
+};
+
+class LiveView;
+
+// Receives the artifacts that enter and leave a LiveView, as they are at that moment, to keep
+// totals over the view current without rescanning it. An edited member that still matches
+// leaves with its old values and enters with the new ones. Each call comes before the view
+// reports the matching row edit.
+class LiveViewMemberListener {
+public:
+    virtual ~LiveViewMemberListener() = default;
+    virtual void membersReset(const LiveView& view) = 0; // The view was refiltered as a whole
+    virtual void memberEntered(const ArcheologicalArtifact& artifact) = 0;
+    virtual void memberLeft(const ArcheologicalArtifact& artifact) = 0;
+};
+
+// Materialized result of a filter over the artifact table, kept current from repository
+// change sets instead of refiltering: an added artifact is tested alone and appended, an
+// updated one re-tested alone and inserted, removed or reported changed in place. Each
+// change evaluates one artifact against the compiled filter and finds its position by binary
+// search, independent of the catalog size; inserting into or removing from the view then
+// shifts the handles after that position, a cost in the size of the view.
+// Results are in table (repository) order. The view must be created after the table
+// registered with the repository so that the table already holds the changed row, and it
+// must not outlive the repository or the table.
+class LiveView : public RepositoryObserver {
+public:
+    LiveView(Repository& repository, const ArtifactTable& table, FilterResultCache* cache = nullptr);
+    ~LiveView() override;
+    LiveView(const LiveView&) = delete;
+    LiveView& operator=(const LiveView&) = delete;
+
+    // Refilters the whole table once; nullptr shows every artifact
+    void setFilter(std::unique_ptr<FilterStrategy> filter, FilterExecution execution = FilterExecution::Serial);
+    void setListener(LiveViewListener* listener); // Not owned; nullptr to detach
+    // Not owned; nullptr to detach. A new listener is reset at once.
+    void setMemberListener(LiveViewMemberListener* listener);
+
+    size_t size() const;
+    ArtifactHandle handle(size_t position) const;
+    const ArcheologicalArtifact& artifact(size_t position) const;
+    int positionOf(ArtifactHandle handle) const; // -1 if the artifact is not in the view
+
+    void onArtifactChanged(const ArtifactChangeSet& change) override;
+
+private:
+    bool matches(const ArcheologicalArtifact& artifact) const;
+    bool isMember(ArtifactHandle handle) const;
+    void setMember(ArtifactHandle handle, bool member);
+    size_t insertionPoint(int row) const; // First position whose table row is not below row
+    void insertAt(size_t position, ArtifactHandle handle);
+    void removeAt(size_t position);
+
+    Repository& m_repository;
+    const ArtifactTable& m_table;
+    FilterResultCache* m_cache;
+    LiveViewListener* m_listener = nullptr;
+    LiveViewMemberListener* m_memberListener = nullptr;
+    std::unique_ptr<FilterProgram> m_program; // nullptr: no filter, everything matches
+    std::vector<ArtifactHandle> m_handles;    // Members in table order
+    std::vector<bool> m_member;               // Indexed by handle
+};
+
+#endif // LIVE_VIEW_H
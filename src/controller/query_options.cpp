@@ -0,0 +1,165 @@
+#include "query_options.h"
+#include "../domain/artifact_schema.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+// Matches at least this fraction of the table make walking a cached order cheaper than sorting them
+constexpr size_t OrderWalkRatio = 8;
+
+int compareField(const ArtifactTable& table, ArtifactField field, size_t a, size_t b) {
+    if (field == ArtifactField::Coordinates) {
+        // South to north, then west to east; artifacts without coordinates first, like invalid dates
+        const GeoPoint& x = table.artifact(a).getCoordinates();
+        const GeoPoint& y = table.artifact(b).getCoordinates();
+        if (x.isValid() != y.isValid()) {
+            return x.isValid() ? 1 : -1;
+        }
+        if (x.latitude() != y.latitude()) {
+            return x.latitude() < y.latitude() ? -1 : 1;
+        }
+        return (x.longitude() > y.longitude()) - (x.longitude() < y.longitude());
+    }
+    const ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(field);
+    if (!getter) {
+        const qint32 x = table.julianDays()[a];
+        const qint32 y = table.julianDays()[b];
+        return (x > y) - (x < y);
+    }
+    const QString& x = (table.artifact(a).*getter)();
+    const QString& y = (table.artifact(b).*getter)();
+    // The folded columns make the case-insensitive part a plain comparison
+    const std::vector<QString>* folded = table.foldedColumn(field);
+    int result = folded ? (*folded)[a].compare((*folded)[b]) : x.compare(y, Qt::CaseInsensitive);
+    return result ? result : x.compare(y);
+}
+
+// Strict weak order of table rows under keys, ties broken by table order
+struct RowLess {
+    const ArtifactTable& table;
+    const std::vector<SortKey>& keys;
+
+    bool operator()(size_t a, size_t b) const {
+        for (const SortKey& key : keys) {
+            int result = compareField(table, key.field, a, b);
+            if (result) {
+                return key.direction == SortDirection::Ascending ? result < 0 : result > 0;
+            }
+        }
+        return a < b;
+    }
+};
+
+QString keyOf(const std::vector<SortKey>& keys) {
+    QString key;
+    for (const SortKey& sortKey : keys) {
+        key += QString::number(static_cast<int>(sortKey.field));
+        key += sortKey.direction == SortDirection::Ascending ? QChar('+') : QChar('-');
+    }
+    return key;
+}
+
+} // namespace
+
+void SortOrderCache::sync(const ArtifactTable& table) {
+    if (m_table != &table || m_version != table.version()) {
+        clear();
+        m_table = &table;
+        m_version = table.version();
+    }
+}
+
+const SortOrderCache::Order* SortOrderCache::order(const std::vector<SortKey>& keys) {
+    if (!m_table) {
+        return nullptr;
+    }
+    const QString key = keyOf(keys);
+    auto found = m_orders.constFind(key);
+    if (found != m_orders.constEnd()) {
+        return &found.value();
+    }
+    if (!m_requested.contains(key)) {
+        m_requested.insert(key, true);
+        return nullptr;
+    }
+    if (static_cast<size_t>(m_orders.size()) >= DefaultCapacity) {
+        m_orders.clear(); // Rare: more key lists in use than an interactive session sorts by
+    }
+
+    Order& order = m_orders[key];
+    order.rows.resize(m_table->size());
+    std::iota(order.rows.begin(), order.rows.end(), 0u);
+    std::sort(order.rows.begin(), order.rows.end(), RowLess{*m_table, keys});
+    order.ranks.resize(order.rows.size());
+    for (size_t position = 0; position < order.rows.size(); ++position) {
+        order.ranks[order.rows[position]] = static_cast<quint32>(position);
+    }
+    return &order;
+}
+
+void SortOrderCache::clear() {
+    m_orders.clear();
+    m_requested.clear();
+    m_table = nullptr;
+    m_version = 0;
+}
+
+std::vector<size_t> selectPage(const ArtifactTable& table, const RowBitmap& rows, const QueryOptions& options,
+                               SortOrderCache* cache) {
+    std::vector<size_t> page;
+    const size_t matches = rows.count();
+    if (options.offset >= matches || options.limit == 0) {
+        return page;
+    }
+    const size_t end = options.limit < matches - options.offset ? options.offset + options.limit : matches;
+    page.reserve(end - options.offset);
+    size_t seen = 0;
+    auto take = [&](size_t row) {
+        if (seen++ >= options.offset) {
+            page.push_back(row);
+        }
+        return seen < end;
+    };
+
+    if (options.sortKeys.empty()) {
+        // Table order: stop at the word holding the last row of the page
+        const quint64* words = rows.words();
+        for (size_t word = 0; word < rows.wordCount(); ++word) {
+            for (quint64 bits = words[word]; bits; bits &= bits - 1) {
+                if (!take(word * 64 + qCountTrailingZeroBits(bits))) {
+                    return page;
+                }
+            }
+        }
+        return page;
+    }
+
+    const SortOrderCache::Order* order = cache ? cache->order(options.sortKeys) : nullptr;
+    if (order && order->rows.size() != table.size()) {
+        order = nullptr; // The cache was synced with another table
+    }
+    if (order && matches * OrderWalkRatio >= table.size()) {
+        for (quint32 row : order->rows) {
+            if (rows.test(row) && !take(row)) {
+                break;
+            }
+        }
+        return page;
+    }
+
+    // Bounded selection: only the first end matches are ever put in order
+    std::vector<size_t> candidates;
+    candidates.reserve(matches);
+    rows.forEachSetBit([&candidates](size_t row) { candidates.push_back(row); });
+    auto middle = candidates.begin() + static_cast<std::ptrdiff_t>(end);
+    if (order) {
+        const std::vector<quint32>& ranks = order->ranks;
+        std::partial_sort(candidates.begin(), middle, candidates.end(),
+                          [&ranks](size_t a, size_t b) { return ranks[a] < ranks[b]; });
+    } else {
+        std::partial_sort(candidates.begin(), middle, candidates.end(), RowLess{table, options.sortKeys});
+    }
+    page.assign(candidates.begin() + static_cast<std::ptrdiff_t>(options.offset), middle);
+    return page;
+}
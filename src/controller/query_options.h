@@ -0,0 +1,65 @@
+#ifndef QUERY_OPTIONS_H
+#define QUERY_OPTIONS_H
+
+#include "../index/artifact_table.h"
+#include "../index/row_bitmap.h"
+#include <QHash>
+#include <QString>
+#include <limits>
+#include <vector>
+
+enum class SortDirection {
+    Ascending,
+    Descending
+};
+
+// Text sorts ignoring case first, then by case; dates sort by day, invalid dates first
+struct SortKey {
+    ArtifactField field;
+    SortDirection direction = SortDirection::Ascending;
+};
+
+// Which matches a query returns and in what order: sorted by the keys in turn (ties, and
+// everything without keys, in table order), then the page [offset, offset + limit) of them
+struct QueryOptions {
+    static constexpr size_t NoLimit = std::numeric_limits<size_t>::max();
+
+    std::vector<SortKey> sortKeys;
+    size_t offset = 0;
+    size_t limit = NoLimit;
+};
+
+// Table rows in full sort order for the key lists that keep being asked for. A list is only
+// sorted once it is requested a second time at the same table version, so a one-off sort
+// costs no more than its page; the orders are dropped when the table changes.
+class SortOrderCache {
+public:
+    static constexpr size_t DefaultCapacity = 8; // Key lists
+
+    struct Order {
+        std::vector<quint32> rows;  // Table rows in sort order
+        std::vector<quint32> ranks; // Position of each table row in rows
+    };
+
+    // Empties the cache unless its orders were built for this table at its current version
+    void sync(const ArtifactTable& table);
+    // The order of the synced table under keys; nullptr the first time keys are asked for
+    const Order* order(const std::vector<SortKey>& keys);
+    void clear();
+
+    size_t size() const { return static_cast<size_t>(m_orders.size()); }
+
+private:
+    const ArtifactTable* m_table = nullptr;
+    quint64 m_version = 0;
+    QHash<QString, Order> m_orders;
+    QHash<QString, bool> m_requested; // Key lists asked for once at this version
+};
+
+// Table rows of the page options select from rows, in order. Only the matches up to the end
+// of the page are ordered (partially sorted, or read off a cached order when the matches are
+// dense), and nothing is copied beyond the page.
+std::vector<size_t> selectPage(const ArtifactTable& table, const RowBitmap& rows, const QueryOptions& options,
+                               SortOrderCache* cache = nullptr);
+
+#endif // QUERY_OPTIONS_H
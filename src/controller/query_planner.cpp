@@ -0,0 +1,532 @@
+#include "query_planner.h"
+#include "../domain/artifact_schema.h"
+#include <QStringList>
+#include <QLocale>
+#include <algorithm>
+#include <initializer_list>
+
+namespace {
+
+using Node = QueryPlan::Node;
+
+// Cost model, in units of one short text comparison. The day-scan and index-entry costs keep
+// the ratio ArtifactBatch::selectDateRange() uses, so both pick the same date path.
+constexpr double TextCost = 1.0;
+constexpr double LongTextCost = 4.0;    // Descriptions are paragraphs, not words
+constexpr double CallCost = 2.0;        // Virtual matches() of a strategy the planner does not know
+constexpr double DayScanCost = 0.05;    // One day of the SIMD scan, per batch row
+constexpr double IndexEntryCost = 0.8;  // Setting the bit of one handle: a random access
+constexpr double PostingCost = 0.25;    // One sequential posting entry during intersection
+constexpr double CachedRowCost = 1.0 / 64; // Cached results are combined a word at a time
+
+// Guesses where no statistic applies
+constexpr double DefaultContainsSelectivity = 0.1;
+constexpr double DefaultEqualsSelectivity = 0.01;
+constexpr double DefaultOpaqueSelectivity = 0.5;
+
+QString fieldName(ArtifactField field);
+
+// Reads the node kind and the operands of the leaves the planner understands
+class OperandReader : public FilterVisitor {
+public:
+    explicit OperandReader(Node& node) : m_node(node) {}
+
+    void visit(const NameFilter& filter) override {
+        text(ArtifactField::Name, filter.name(), TextMatch::Contains, filter.caseSensitive());
+    }
+    void visit(const MaterialFilter& filter) override {
+        text(ArtifactField::Material, filter.material(), filter.match(), filter.caseSensitive());
+    }
+    void visit(const LocationFilter& filter) override {
+        text(ArtifactField::Location, filter.location(), filter.match(), filter.caseSensitive());
+    }
+    void visit(const DescriptionFilter& filter) override {
+        text(ArtifactField::Description, filter.description(), TextMatch::Contains, filter.caseSensitive());
+    }
+    void visit(const IdFilter& filter) override {
+        text(ArtifactField::Id, filter.id(), TextMatch::Contains, filter.caseSensitive());
+    }
+    void visit(const DateRangeFilter& filter) override {
+        m_node.kind = Node::Kind::Date;
+        m_node.startDate = filter.startDate();
+        m_node.endDate = filter.endDate();
+    }
+    void visit(const AndFilter& filter) override {
+        m_node.kind = Node::Kind::And;
+        children = &filter.filters();
+    }
+    void visit(const OrFilter& filter) override {
+        m_node.kind = Node::Kind::Or;
+        children = &filter.filters();
+    }
+    // The next three are evaluated by the strategies themselves, but keyed so that their results
+    // can still be shared through the cache
+    void visit(const FuzzyNameFilter& filter) override {
+        m_node.kind = Node::Kind::Opaque;
+        const QString pattern = ArtifactTable::foldCase(filter.name());
+        m_node.key = QString("name:~%1:%2:%3").arg(filter.maxEdits()).arg(pattern.size()).arg(pattern);
+        m_node.label = QString("name like '%1' within %2 edits").arg(filter.name()).arg(filter.maxEdits());
+    }
+    void visit(const DescriptionSearch& filter) override {
+        m_node.kind = Node::Kind::Opaque;
+        // Words hold no quotes or separators, so phrases joined this way stay unambiguous
+        QStringList phrases;
+        for (const QStringList& phrase : filter.query().phrases) {
+            phrases << phrase.join(' ');
+        }
+        phrases.sort();
+        phrases.removeDuplicates();
+        m_node.key = "description:words:" + phrases.join('|');
+        m_node.label = QString("description has words '%1'").arg(filter.text());
+    }
+    void visit(const RegexFilter& filter) override {
+        m_node.kind = Node::Kind::Opaque;
+        m_node.key = QString("%1:re%2:%3:%4").arg(fieldName(filter.field()), filter.caseSensitive() ? "" : "i")
+                         .arg(filter.pattern().size()).arg(filter.pattern());
+        m_node.label = QString("%1 %2 /%3/").arg(fieldName(filter.field()), filter.caseSensitive() ? "matches" : "imatches",
+                                                 filter.pattern());
+    }
+    void visit(const BoundingBoxFilter& filter) override {
+        const GeoBox& box = filter.box();
+        const QString corners = QString("%1, %2, %3, %4").arg(box.south()).arg(box.west()).arg(box.north()).arg(box.east());
+        m_node.kind = Node::Kind::Opaque;
+        m_node.key = "coordinates:box:" + exact({box.south(), box.west(), box.north(), box.east()});
+        m_node.label = QString("coordinates in box [%1]").arg(corners);
+    }
+    void visit(const RadiusFilter& filter) override {
+        const GeoPoint& center = filter.center();
+        m_node.kind = Node::Kind::Opaque;
+        m_node.key = "coordinates:radius:" + exact({center.latitude(), center.longitude(), filter.radiusKm()});
+        m_node.label = QString("coordinates within %1 km of (%2, %3)")
+                           .arg(filter.radiusKm()).arg(center.latitude()).arg(center.longitude());
+    }
+    void visitOther(const FilterStrategy& /*filter*/) override {
+        m_node.kind = Node::Kind::Opaque;
+    }
+
+    const std::vector<std::unique_ptr<FilterStrategy>>* children = nullptr;
+
+private:
+    void text(ArtifactField field, const QString& needle, TextMatch match, bool caseSensitive) {
+        m_node.kind = Node::Kind::Text;
+        m_node.field = field;
+        m_node.needle = needle;
+        m_node.match = match;
+        m_node.sensitivity = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    }
+    // Shortest round-trip form of each value, so that different operands never share a key
+    static QString exact(std::initializer_list<double> values) {
+        QStringList parts;
+        for (double value : values) {
+            parts << QString::number(value, 'g', QLocale::FloatingPointShortest);
+        }
+        return parts.join(',');
+    }
+
+    Node& m_node;
+};
+
+// Cost of combining the value bitmaps of the subtree: testing each distinct value and
+// merging the handle containers, which is sequential. Negative when a part is not indexable.
+double bitmapBuildCost(const Node& node) {
+    switch (node.kind) {
+    case Node::Kind::Text:
+        return node.valueCount < 0 ? -1 : node.distinctValues * TextCost + node.valueCount * PostingCost;
+    case Node::Kind::And:
+    case Node::Kind::Or: {
+        if (node.children.empty()) {
+            return -1;
+        }
+        double total = 0;
+        for (const Node& child : node.children) {
+            double cost = bitmapBuildCost(child);
+            if (cost < 0) {
+                return -1;
+            }
+            total += cost;
+        }
+        return total;
+    }
+    default:
+        return -1;
+    }
+}
+
+// Same, plus mapping the resulting handles back to rows
+double bitmapCost(const Node& node, double tableRows) {
+    double build = bitmapBuildCost(node);
+    return build < 0 ? -1 : build + node.selectivity * tableRows * IndexEntryCost;
+}
+
+void answerFromBitmaps(Node& node) {
+    node.path = AccessPath::ValueBitmap;
+    for (Node& child : node.children) {
+        answerFromBitmaps(child);
+    }
+}
+
+QString pathName(AccessPath path) {
+    switch (path) {
+    case AccessPath::Scan: return "scan";
+    case AccessPath::ValueBitmap: return "value bitmaps";
+    case AccessPath::TrigramIndex: return "trigram index";
+    case AccessPath::DateIndex: return "date index";
+    case AccessPath::Cache: return "result cache";
+    }
+    return QString();
+}
+
+QString fieldName(ArtifactField field) {
+    QString name;
+    ArtifactSchema::forEachField([field, &name](const auto& descriptor) {
+        if (descriptor.field == field) {
+            name = descriptor.jsonKey;
+        }
+    });
+    return name;
+}
+
+QString describeNode(const Node& node) {
+    switch (node.kind) {
+    case Node::Kind::Text: {
+        bool folded = node.sensitivity == Qt::CaseInsensitive;
+        QString op = node.match == TextMatch::Equals ? (folded ? "i==" : "==") : (folded ? "icontains" : "contains");
+        return QString("%1 %2 '%3'").arg(fieldName(node.field), op, node.needle);
+    }
+    case Node::Kind::Date:
+        return QString("discoveryDate in [%1, %2]")
+            .arg(node.startDate.toString(Qt::ISODate), node.endDate.toString(Qt::ISODate));
+    case Node::Kind::And:
+        return "AND";
+    case Node::Kind::Or:
+        return "OR";
+    case Node::Kind::Opaque:
+        if (!node.label.isEmpty()) {
+            return node.label;
+        }
+        break;
+    }
+    return "custom filter";
+}
+
+void explainNode(const Node& node, size_t tableRows, int depth, QStringList& lines) {
+    lines << QString("%1%2  [%3, est. %4 rows, cost %5]")
+                 .arg(QString(depth * 2, QChar(' ')), describeNode(node), pathName(node.path))
+                 .arg(QString::number(node.selectivity * static_cast<double>(tableRows), 'f', 0),
+                      QString::number(node.cost, 'f', 0));
+    if (node.path == AccessPath::Cache) {
+        return; // The children did not run
+    }
+    for (const Node& child : node.children) {
+        explainNode(child, tableRows, depth + 1, lines);
+    }
+}
+
+QString textKey(const Node& node) {
+    bool folded = node.sensitivity == Qt::CaseInsensitive;
+    QString op = node.match == TextMatch::Equals ? (folded ? "ie" : "e") : (folded ? "ic" : "c");
+    // The length keeps needles holding separators unambiguous
+    return QString("%1:%2:%3:%4").arg(fieldName(node.field), op).arg(node.needle.size())
+        .arg(folded ? node.needle.toCaseFolded() : node.needle);
+}
+
+// Keys of the terms of an AND/OR, looking through nested nodes of the same kind.
+// An empty nested node is a term of its own: it matches nothing, unlike its siblings.
+bool collectTerms(const Node& node, Node::Kind kind, QStringList& terms) {
+    for (const Node& child : node.children) {
+        if (child.kind == kind && !child.children.empty()) {
+            if (!collectTerms(child, kind, terms)) {
+                return false;
+            }
+        } else if (child.key.isEmpty()) {
+            return false;
+        } else {
+            terms << child.key;
+        }
+    }
+    return true;
+}
+
+QString compositeKey(const Node& node) {
+    QStringList terms;
+    if (!collectTerms(node, node.kind, terms)) {
+        return QString();
+    }
+    terms.sort();
+    terms.removeDuplicates();
+    if (terms.size() == 1) {
+        return terms.front(); // A single term decides alone
+    }
+    return QString("%1(%2)").arg(node.kind == Node::Kind::And ? "and" : "or", terms.join(','));
+}
+
+RowBitmap executeNode(const Node& node, const ArtifactBatch& batch, const RowBitmap& candidates,
+                      bool unrestricted, FilterResultCache* cache);
+
+RowBitmap evaluateNode(const Node& node, const ArtifactBatch& batch, const RowBitmap& candidates,
+                       bool unrestricted, FilterResultCache* cache) {
+    const ArtifactTable* table = batch.table();
+    switch (node.path) {
+    case AccessPath::ValueBitmap: {
+        RoaringBitmap handles;
+        if (table && node.filter->selectIndexed(*table, handles)) {
+            RowBitmap rows = batch.rowsOf(handles);
+            rows &= candidates;
+            return rows;
+        }
+        return node.filter->refineBatch(batch, candidates);
+    }
+    case AccessPath::TrigramIndex:
+        return batch.selectText(node.field, node.needle, node.match, node.sensitivity, candidates, true);
+    case AccessPath::DateIndex: {
+        RowBitmap rows = table ? batch.indexDateRange(node.startDate, node.endDate)
+                               : batch.scanDateRange(node.startDate, node.endDate);
+        rows &= candidates;
+        return rows;
+    }
+    case AccessPath::Cache: {
+        if (!table) {
+            return node.filter->refineBatch(batch, candidates);
+        }
+        RowBitmap rows = batch.coversTable() ? *node.cached : node.cached->slice(batch.tableOffset(), batch.size());
+        rows &= candidates;
+        return rows;
+    }
+    case AccessPath::Scan:
+        break;
+    }
+
+    switch (node.kind) {
+    case Node::Kind::Text:
+        return batch.selectText(node.field, node.needle, node.match, node.sensitivity, candidates, false);
+    case Node::Kind::Date: {
+        RowBitmap rows = batch.scanDateRange(node.startDate, node.endDate);
+        rows &= candidates;
+        return rows;
+    }
+    case Node::Kind::And: {
+        if (node.children.empty()) {
+            return RowBitmap(batch.size());
+        }
+        // Only the first child sees every row the AND sees
+        RowBitmap rows = candidates;
+        for (size_t i = 0; i < node.children.size() && !rows.none(); ++i) {
+            rows &= executeNode(node.children[i], batch, rows, unrestricted && i == 0, cache);
+        }
+        return rows;
+    }
+    case Node::Kind::Or: {
+        RowBitmap rows(batch.size());
+        RowBitmap remaining = candidates;
+        for (size_t i = 0; i < node.children.size() && !remaining.none(); ++i) {
+            RowBitmap hits = executeNode(node.children[i], batch, remaining, unrestricted && i == 0, cache);
+            rows |= hits;
+            remaining.andNot(hits);
+        }
+        return rows;
+    }
+    case Node::Kind::Opaque:
+        break;
+    }
+    return node.filter->refineBatch(batch, candidates);
+}
+
+// unrestricted: candidates are all live rows of a batch over the whole table, so the result
+// is the node's complete result and can be cached
+RowBitmap executeNode(const Node& node, const ArtifactBatch& batch, const RowBitmap& candidates,
+                      bool unrestricted, FilterResultCache* cache) {
+    RowBitmap rows = evaluateNode(node, batch, candidates, unrestricted, cache);
+    if (cache && unrestricted && node.path != AccessPath::Cache && !node.key.isEmpty()) {
+        cache->insert(node.key, rows);
+    }
+    return rows;
+}
+
+} // namespace
+
+RowBitmap QueryPlan::execute(const ArtifactBatch& batch, FilterResultCache* cache) const {
+    if (cache && batch.table()) {
+        cache->sync(*batch.table());
+    }
+    return executeNode(m_root, batch, batch.liveRows(), batch.coversTable(), cache);
+}
+
+QString QueryPlan::explain() const {
+    QStringList lines;
+    lines << QString("Plan over %1 rows, est. %2 matches")
+                 .arg(m_tableRows)
+                 .arg(QString::number(estimatedRows(), 'f', 0));
+    explainNode(m_root, m_tableRows, 1, lines);
+    return lines.join('\n');
+}
+
+QueryPlanner::QueryPlanner(const ArtifactTable& table, FilterResultCache* cache)
+    : m_table(table), m_statistics(table), m_cache(cache) {
+    if (m_cache) {
+        m_cache->sync(table);
+    }
+}
+
+QueryPlan QueryPlanner::plan(const FilterStrategy& filter) const {
+    QueryPlan plan;
+    plan.m_source = filter.clone();
+    plan.m_tableRows = m_statistics.rows();
+    plan.m_root = describe(*plan.m_source);
+    choose(plan.m_root, static_cast<double>(plan.m_tableRows));
+    return plan;
+}
+
+QueryPlan::Node QueryPlanner::describe(const FilterStrategy& filter) const {
+    Node node;
+    node.filter = &filter;
+    OperandReader reader(node);
+    filter.accept(reader);
+    const double rows = static_cast<double>(std::max<size_t>(1, m_statistics.rows()));
+
+    switch (node.kind) {
+    case Node::Kind::Text: {
+        // The value bitmaps only serve substring tests while the distinct values are few
+        const BitmapIndex* values = m_table.bitmapIndex(node.field);
+        size_t count = 0;
+        if (values && (node.match == TextMatch::Equals || values->isLowCardinality(m_table.artifactCount())) &&
+            m_statistics.countValues(node.field, node.needle, node.match, node.sensitivity, count)) {
+            node.valueCount = static_cast<double>(count);
+            node.distinctValues = static_cast<double>(m_statistics.distinctValues(node.field));
+        }
+        size_t bound = 0;
+        size_t work = 0;
+        if (node.match == TextMatch::Contains && m_statistics.trigramBound(node.field, node.needle, bound, work)) {
+            node.trigramBound = static_cast<double>(bound);
+            node.postingWork = static_cast<double>(work);
+        }
+
+        node.key = textKey(node);
+        if (node.valueCount >= 0) {
+            node.selectivity = node.valueCount / rows;
+        } else if (node.trigramBound >= 0) {
+            node.selectivity = node.trigramBound / rows;
+        } else if (node.match == TextMatch::Contains && node.needle.isEmpty()) {
+            node.selectivity = 1.0;
+        } else {
+            node.selectivity = node.match == TextMatch::Equals ? DefaultEqualsSelectivity : DefaultContainsSelectivity;
+        }
+        break;
+    }
+    case Node::Kind::Date:
+        node.dateCount = static_cast<double>(m_statistics.countDateRange(node.startDate, node.endDate));
+        node.selectivity = node.dateCount / rows;
+        node.key = QString("date:%1:%2").arg(ArtifactTable::toJulianDay(node.startDate))
+                       .arg(ArtifactTable::toJulianDay(node.endDate));
+        break;
+    case Node::Kind::And:
+    case Node::Kind::Or: {
+        // Children are assumed independent
+        double all = 1.0;
+        double none = 1.0;
+        for (const auto& child : *reader.children) {
+            node.children.push_back(describe(*child));
+            all *= node.children.back().selectivity;
+            none *= 1.0 - node.children.back().selectivity;
+        }
+        if (node.children.empty()) {
+            node.selectivity = 0.0; // Empty composites match nothing
+        } else {
+            node.selectivity = node.kind == Node::Kind::And ? all : 1.0 - none;
+        }
+        node.key = compositeKey(node);
+        break;
+    }
+    case Node::Kind::Opaque:
+        node.selectivity = DefaultOpaqueSelectivity;
+        break;
+    }
+    if (m_cache && !node.key.isEmpty()) {
+        node.cached = m_cache->lookup(node.key);
+        if (node.cached) {
+            node.selectivity = static_cast<double>(node.cached->count()) / rows;
+        }
+    }
+    node.selectivity = std::min(1.0, std::max(0.0, node.selectivity));
+    return node;
+}
+
+double QueryPlanner::choose(Node& node, double inputRows) const {
+    const double tableRows = static_cast<double>(m_statistics.rows());
+    node.path = AccessPath::Scan;
+    if (node.cached) {
+        node.path = AccessPath::Cache;
+        node.cost = tableRows * CachedRowCost;
+        return node.cost;
+    }
+
+    switch (node.kind) {
+    case Node::Kind::Text: {
+        const double rowCost = node.field == ArtifactField::Description ? LongTextCost : TextCost;
+        node.cost = inputRows * rowCost;
+        if (node.trigramBound >= 0) {
+            // Only the index candidates that are still candidates get verified
+            double verified = tableRows > 0 ? node.trigramBound * inputRows / tableRows : 0;
+            double cost = node.postingWork * PostingCost + node.trigramBound * IndexEntryCost + verified * rowCost;
+            if (cost < node.cost) {
+                node.cost = cost;
+                node.path = AccessPath::TrigramIndex;
+            }
+        }
+        double cost = bitmapCost(node, tableRows);
+        if (cost >= 0 && cost < node.cost) {
+            node.cost = cost;
+            node.path = AccessPath::ValueBitmap;
+        }
+        break;
+    }
+    case Node::Kind::Date: {
+        // The scan reads the whole day column whatever the candidates
+        node.cost = tableRows * DayScanCost;
+        double cost = node.dateCount * IndexEntryCost;
+        if (cost < node.cost) {
+            node.cost = cost;
+            node.path = AccessPath::DateIndex;
+        }
+        break;
+    }
+    case Node::Kind::Opaque:
+        node.cost = inputRows * CallCost;
+        break;
+    case Node::Kind::And:
+    case Node::Kind::Or: {
+        const bool conjunction = node.kind == Node::Kind::And;
+        // A conjunct is worth running early when it is cheap per row it rejects,
+        // a disjunct when it is cheap per row it accepts
+        std::vector<std::pair<double, size_t>> ranks;
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            double cost = choose(node.children[i], inputRows);
+            double decided = conjunction ? 1.0 - node.children[i].selectivity : node.children[i].selectivity;
+            ranks.emplace_back(cost / std::max(decided, 1e-9), i);
+        }
+        std::stable_sort(ranks.begin(), ranks.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        std::vector<Node> ordered;
+        ordered.reserve(node.children.size());
+        for (const auto& rank : ranks) {
+            ordered.push_back(std::move(node.children[rank.second]));
+        }
+        node.children.swap(ordered);
+
+        // Each child only sees the rows the ones before it left undecided
+        node.cost = 0;
+        double remaining = inputRows;
+        for (Node& child : node.children) {
+            node.cost += choose(child, remaining);
+            remaining *= conjunction ? child.selectivity : 1.0 - child.selectivity;
+        }
+
+        double cost = bitmapCost(node, tableRows);
+        if (cost >= 0 && cost < node.cost) {
+            node.cost = cost;
+            answerFromBitmaps(node);
+        }
+        break;
+    }
+    }
+    return node.cost;
+}
@@ -0,0 +1,101 @@
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include "filter.h"
+#include "filter_result_cache.h"
+#include "../index/table_statistics.h"
+#include <vector>
+#include <memory>
+#include <QString>
+#include <QDate>
+
+// How a plan node finds its rows
+enum class AccessPath {
+    Scan,         // Evaluate every candidate row (or the day column, for dates)
+    ValueBitmap,  // Answer the whole subtree from the value bitmaps
+    TrigramIndex, // Verify only the trigram index candidates
+    DateIndex,    // Read the slice of the date index
+    Cache         // Reuse a result from the FilterResultCache
+};
+
+// A filter tree annotated by QueryPlanner: conjuncts and disjuncts in execution order,
+// an access path per node and the estimates that led to them. Running the plan gives
+// the same rows as FilterStrategy::matchBatch() on the planned filter.
+class QueryPlan {
+public:
+    struct Node {
+        enum class Kind { Text, Date, Opaque, And, Or };
+
+        Kind kind = Kind::Opaque;
+        const FilterStrategy* filter = nullptr; // Points into the plan's copy of the filter
+        AccessPath path = AccessPath::Scan;
+        double selectivity = 1.0; // Estimated fraction of all rows that match
+        double cost = 0.0;        // Estimated work, in text comparisons, for the planned input
+        std::vector<Node> children; // Execution order
+
+        // Canonical form of the subtree: equal for trees that match the same rows by construction
+        // (AND/OR children in any order, nesting or repetition; case-insensitive terms in any case).
+        // Empty when the subtree holds a strategy the planner does not know.
+        QString key;
+        std::shared_ptr<const RowBitmap> cached; // Table rows, set when the cache held the key
+        QString label; // How explain() shows an Opaque leaf the planner recognizes
+
+        // Operands of the Text and Date leaves
+        ArtifactField field = ArtifactField::Id;
+        QString needle;
+        TextMatch match = TextMatch::Contains;
+        Qt::CaseSensitivity sensitivity = Qt::CaseInsensitive;
+        QDate startDate;
+        QDate endDate;
+
+        // Statistics behind the choice of path; -1 when the index is missing or unusable
+        double valueCount = -1;   // Exact rows from the value bitmaps
+        double distinctValues = 0;
+        double trigramBound = -1; // Upper bound from the trigram postings
+        double postingWork = 0;
+        double dateCount = -1;    // Exact rows from the date index
+    };
+
+    const Node& root() const { return m_root; }
+    size_t tableRows() const { return m_tableRows; }
+    double estimatedRows() const { return m_root.selectivity * static_cast<double>(m_tableRows); }
+
+    // Rows of the batch that match. The batch must view the planned table (or a slice of it);
+    // over any other batch the index paths fall back to the filter's own evaluation.
+    // With a cache and a batch over the whole table, every subtree that gets evaluated over
+    // all rows (the root and the first child of each composite on the way) is stored.
+    RowBitmap execute(const ArtifactBatch& batch, FilterResultCache* cache = nullptr) const;
+
+    // One line per node, children indented under their parent in execution order
+    QString explain() const;
+
+private:
+    friend class QueryPlanner;
+
+    Node m_root;
+    size_t m_tableRows = 0;
+    std::unique_ptr<FilterStrategy> m_source;
+};
+
+// Cost-based planner for filter trees over an ArtifactTable. Selectivities come from
+// TableStatistics (exact for value-indexed fields and dates, trigram bounds for the other
+// indexed text, fixed guesses otherwise); conjuncts are ordered by cost per rejected row and
+// disjuncts by cost per accepted row, and each node takes its cheapest access path for the
+// rows the nodes before it leave over. Subtrees found in the result cache cost next to nothing.
+class QueryPlanner {
+public:
+    explicit QueryPlanner(const ArtifactTable& table, FilterResultCache* cache = nullptr);
+
+    QueryPlan plan(const FilterStrategy& filter) const;
+
+private:
+    QueryPlan::Node describe(const FilterStrategy& filter) const;
+    // Picks the paths and child order of node for inputRows candidate rows; returns its cost
+    double choose(QueryPlan::Node& node, double inputRows) const;
+
+    const ArtifactTable& m_table;
+    TableStatistics m_statistics;
+    FilterResultCache* m_cache;
+};
+
+#endif // QUERY_PLANNER_H
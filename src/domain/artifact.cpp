@@ -1,27 +1,78 @@
 // filepath: src/domain/artifact.cpp
 #include "artifact.h"
+#include "artifact_schema.h"
 
 ArcheologicalArtifact::ArcheologicalArtifact() {}
 
 ArcheologicalArtifact::ArcheologicalArtifact(const QString& id, const QString& name, const QString& description,
-                                             const QString& material, const QDate& discoveryDate, const QString& location)
+                                             const QString& material, const QDate& discoveryDate, const QString& location,
+                                             const GeoPoint& coordinates)
     : m_id(id), m_name(name), m_description(description), m_material(material),
-      m_discoveryDate(discoveryDate), m_location(location) {}
+      m_discoveryDate(discoveryDate), m_location(location), m_coordinates(coordinates) {}
 
-QString ArcheologicalArtifact::getId() const { return m_id; }
-void ArcheologicalArtifact::setId(const QString& id) { m_id = id; }
+const QString& ArcheologicalArtifact::getId() const { return m_id; }
+void ArcheologicalArtifact::setId(const QString& id) { m_id = id; m_dirtyFields |= fieldBit(ArtifactField::Id); }
 
-QString ArcheologicalArtifact::getName() const { return m_name; }
-void ArcheologicalArtifact::setName(const QString& name) { m_name = name; }
+const QString& ArcheologicalArtifact::getName() const { return m_name; }
+void ArcheologicalArtifact::setName(const QString& name) { m_name = name; m_dirtyFields |= fieldBit(ArtifactField::Name); }
 
-QString ArcheologicalArtifact::getDescription() const { return m_description; }
-void ArcheologicalArtifact::setDescription(const QString& description) { m_description = description; }
+const QString& ArcheologicalArtifact::getDescription() const { return m_description; }
+void ArcheologicalArtifact::setDescription(const QString& description) { m_description = description; m_dirtyFields |= fieldBit(ArtifactField::Description); }
 
-QString ArcheologicalArtifact::getMaterial() const { return m_material; }
-void ArcheologicalArtifact::setMaterial(const QString& material) { m_material = material; }
+const QString& ArcheologicalArtifact::getMaterial() const { return m_material; }
+void ArcheologicalArtifact::setMaterial(const QString& material) { m_material = material; m_dirtyFields |= fieldBit(ArtifactField::Material); }
 
-QDate ArcheologicalArtifact::getDiscoveryDate() const { return m_discoveryDate; }
-void ArcheologicalArtifact::setDiscoveryDate(const QDate& date) { m_discoveryDate = date; }
+const QDate& ArcheologicalArtifact::getDiscoveryDate() const { return m_discoveryDate; }
+void ArcheologicalArtifact::setDiscoveryDate(const QDate& date) { m_discoveryDate = date; m_dirtyFields |= fieldBit(ArtifactField::DiscoveryDate); }
 
-QString ArcheologicalArtifact::getLocation() const { return m_location; }
-void ArcheologicalArtifact::setLocation(const QString& location) { m_location = location; }
\ No newline at end of file
+const QString& ArcheologicalArtifact::getLocation() const { return m_location; }
+void ArcheologicalArtifact::setLocation(const QString& location) { m_location = location; m_dirtyFields |= fieldBit(ArtifactField::Location); }
+
+const GeoPoint& ArcheologicalArtifact::getCoordinates() const { return m_coordinates; }
+void ArcheologicalArtifact::setCoordinates(const GeoPoint& coordinates) { m_coordinates = coordinates; m_dirtyFields |= fieldBit(ArtifactField::Coordinates); }
+
+ArtifactHandle ArcheologicalArtifact::getHandle() const { return m_handle; }
+void ArcheologicalArtifact::setHandle(ArtifactHandle handle) { m_handle = handle; }
+
+QVariant ArcheologicalArtifact::getField(ArtifactField field) const {
+    QVariant value;
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        if (descriptor.field == field) {
+            value = QVariant::fromValue((this->*descriptor.get)());
+        }
+    });
+    return value;
+}
+
+void ArcheologicalArtifact::setField(ArtifactField field, const QVariant& value) {
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        using ValueType = typename std::decay_t<decltype(descriptor)>::ValueType;
+        if (descriptor.field == field) {
+            (this->*descriptor.set)(value.value<ValueType>());
+        }
+    });
+}
+
+ArtifactFieldMask ArcheologicalArtifact::dirtyFields() const { return m_dirtyFields; }
+bool ArcheologicalArtifact::isDirty() const { return m_dirtyFields != 0; }
+void ArcheologicalArtifact::clearDirtyFields() { m_dirtyFields = 0; }
+
+ArtifactFieldMask ArcheologicalArtifact::differingFields(const ArcheologicalArtifact& other, ArtifactFieldMask mask) const {
+    ArtifactFieldMask result = 0;
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        if ((mask & fieldBit(descriptor.field)) && (this->*descriptor.get)() != (other.*descriptor.get)()) {
+            result |= fieldBit(descriptor.field);
+        }
+    });
+    return result;
+}
+
+size_t ArcheologicalArtifact::textBytes() const {
+    size_t bytes = 0;
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        if constexpr (std::is_same_v<typename std::decay_t<decltype(descriptor)>::ValueType, QString>) {
+            bytes += static_cast<size_t>((this->*descriptor.get)().size()) * sizeof(QChar);
+        }
+    });
+    return bytes;
+}
\ No newline at end of file
@@ -3,6 +3,30 @@
 
 #include <QString>
 #include <QDate> // For discovery date
+#include "geo_point.h"
+#include <QVariant>
+#include <QtGlobal>
+
+// Internal 32-bit surrogate key assigned by the repository.
+// The string ID stays the public identity; handles are for hot internal paths.
+using ArtifactHandle = quint32;
+constexpr ArtifactHandle InvalidArtifactHandle = 0;
+
+// Field identifiers, used for dirty flags and change sets
+enum class ArtifactField : quint8 {
+    Id,
+    Name,
+    Description,
+    Material,
+    DiscoveryDate,
+    Location,
+    Coordinates
+};
+constexpr int ArtifactFieldCount = 7;
+
+using ArtifactFieldMask = quint32;
+constexpr ArtifactFieldMask fieldBit(ArtifactField field) { return 1u << static_cast<int>(field); }
+constexpr ArtifactFieldMask AllArtifactFields = (1u << ArtifactFieldCount) - 1;
 
 class ArcheologicalArtifact {
 public:
@@ -12,26 +36,50 @@ public:
                           const QString& description,
                           const QString& material,
                           const QDate& discoveryDate,
-                          const QString& location);
+                          const QString& location,
+                          const GeoPoint& coordinates = GeoPoint());
 
-    QString getId() const;
+    const QString& getId() const;
     void setId(const QString& id);
 
-    QString getName() const;
+    const QString& getName() const;
     void setName(const QString& name);
 
-    QString getDescription() const;
+    const QString& getDescription() const;
     void setDescription(const QString& description);
 
-    QString getMaterial() const;
+    const QString& getMaterial() const;
     void setMaterial(const QString& material);
 
-    QDate getDiscoveryDate() const;
+    const QDate& getDiscoveryDate() const;
     void setDiscoveryDate(const QDate& date);
 
-    QString getLocation() const;
+    const QString& getLocation() const;
     void setLocation(const QString& location);
 
+    // Where the artifact was found, when surveyed; a null point otherwise
+    const GeoPoint& getCoordinates() const;
+    void setCoordinates(const GeoPoint& coordinates);
+
+    // Handle is InvalidArtifactHandle until the artifact is stored in a repository
+    ArtifactHandle getHandle() const;
+    void setHandle(ArtifactHandle handle);
+
+    // Generic field access (QString, QDate or GeoPoint wrapped in a QVariant)
+    QVariant getField(ArtifactField field) const;
+    void setField(ArtifactField field, const QVariant& value);
+
+    // Dirty flags: every setter marks its field, repositories store clean copies
+    ArtifactFieldMask dirtyFields() const;
+    bool isDirty() const;
+    void clearDirtyFields();
+
+    // Fields (restricted to mask) whose values differ from other
+    ArtifactFieldMask differingFields(const ArcheologicalArtifact& other, ArtifactFieldMask mask = AllArtifactFields) const;
+
+    // UTF-16 bytes of the text fields, counted as if their storage were not shared
+    size_t textBytes() const;
+
     // Add other properties and their getters/setters as needed
     // For example: QString getPhotoPath() const; void setPhotoPath(const QString& path);
 
@@ -42,6 +90,9 @@ private:
     QString m_material;
     QDate m_discoveryDate;
     QString m_location;
+    GeoPoint m_coordinates;
+    ArtifactHandle m_handle = InvalidArtifactHandle;
+    ArtifactFieldMask m_dirtyFields = 0;
     // QString m_photoPath;
 };
 
@@ -0,0 +1,88 @@
+#include "artifact_change.h"
+#include "artifact_schema.h"
+
+ArtifactChangeSet::ArtifactChangeSet(Kind kind, ArtifactHandle handle)
+    : m_kind(kind), m_handle(handle) {}
+
+ArtifactChangeSet ArtifactChangeSet::added(const ArcheologicalArtifact& artifact) {
+    ArtifactChangeSet change(Kind::Added, artifact.getHandle());
+    change.m_changes.reserve(ArtifactFieldCount);
+    for (int i = 0; i < ArtifactFieldCount; ++i) {
+        ArtifactField field = static_cast<ArtifactField>(i);
+        change.m_changes.push_back({field, QVariant(), artifact.getField(field)});
+    }
+    change.m_fields = AllArtifactFields;
+    return change;
+}
+
+ArtifactChangeSet ArtifactChangeSet::removed(const ArcheologicalArtifact& artifact) {
+    ArtifactChangeSet change(Kind::Removed, artifact.getHandle());
+    change.m_changes.reserve(ArtifactFieldCount);
+    for (int i = 0; i < ArtifactFieldCount; ++i) {
+        ArtifactField field = static_cast<ArtifactField>(i);
+        change.m_changes.push_back({field, artifact.getField(field), QVariant()});
+    }
+    change.m_fields = AllArtifactFields;
+    return change;
+}
+
+ArtifactChangeSet ArtifactChangeSet::updated(const ArcheologicalArtifact& before, const ArcheologicalArtifact& after,
+                                             ArtifactFieldMask mask) {
+    ArtifactChangeSet change(Kind::Updated, before.getHandle());
+    change.m_fields = before.differingFields(after, mask);
+    for (int i = 0; i < ArtifactFieldCount; ++i) {
+        ArtifactField field = static_cast<ArtifactField>(i);
+        if (change.m_fields & fieldBit(field)) {
+            change.m_changes.push_back({field, before.getField(field), after.getField(field)});
+        }
+    }
+    return change;
+}
+
+ArtifactChangeSet::Kind ArtifactChangeSet::kind() const { return m_kind; }
+ArtifactHandle ArtifactChangeSet::handle() const { return m_handle; }
+ArtifactFieldMask ArtifactChangeSet::fields() const { return m_fields; }
+bool ArtifactChangeSet::touches(ArtifactField field) const { return (m_fields & fieldBit(field)) != 0; }
+bool ArtifactChangeSet::isEmpty() const { return m_fields == 0; }
+const std::vector<FieldChange>& ArtifactChangeSet::changes() const { return m_changes; }
+
+const FieldChange* ArtifactChangeSet::find(ArtifactField field) const {
+    for (const auto& change : m_changes) {
+        if (change.field == field) {
+            return &change;
+        }
+    }
+    return nullptr;
+}
+
+QVariant ArtifactChangeSet::oldValue(ArtifactField field) const {
+    const FieldChange* change = find(field);
+    return change ? change->oldValue : QVariant();
+}
+
+QVariant ArtifactChangeSet::newValue(ArtifactField field) const {
+    const FieldChange* change = find(field);
+    return change ? change->newValue : QVariant();
+}
+
+void ArtifactChangeSet::apply(ArcheologicalArtifact& artifact) const {
+    for (const auto& change : m_changes) {
+        artifact.setField(change.field, change.newValue);
+    }
+}
+
+void ArtifactChangeSet::revert(ArcheologicalArtifact& artifact) const {
+    for (const auto& change : m_changes) {
+        artifact.setField(change.field, change.oldValue);
+    }
+}
+
+size_t ArtifactChangeSet::memoryUsage() const {
+    size_t bytes = m_changes.capacity() * sizeof(FieldChange);
+    for (const auto& change : m_changes) {
+        if (ArtifactSchema::textGetter(change.field)) {
+            bytes += static_cast<size_t>(change.oldValue.toString().size() + change.newValue.toString().size()) * sizeof(QChar);
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,58 @@
+#ifndef ARTIFACT_CHANGE_H
+#define ARTIFACT_CHANGE_H
+
+#include "artifact.h"
+#include <QVariant>
+#include <vector>
+
+// Old and new value of one field
+struct FieldChange {
+    ArtifactField field;
+    QVariant oldValue;
+    QVariant newValue;
+};
+
+// Describes one repository mutation at field granularity.
+// Added changes carry every field as a new value, Removed changes every field as an old value.
+class ArtifactChangeSet {
+public:
+    enum class Kind {
+        Added,
+        Removed,
+        Updated
+    };
+
+    static ArtifactChangeSet added(const ArcheologicalArtifact& artifact);
+    static ArtifactChangeSet removed(const ArcheologicalArtifact& artifact);
+    // Only fields in mask are compared; unchanged fields are left out of the set
+    static ArtifactChangeSet updated(const ArcheologicalArtifact& before, const ArcheologicalArtifact& after,
+                                     ArtifactFieldMask mask = AllArtifactFields);
+
+    Kind kind() const;
+    ArtifactHandle handle() const;
+    ArtifactFieldMask fields() const;
+    bool touches(ArtifactField field) const;
+    bool isEmpty() const;
+
+    const std::vector<FieldChange>& changes() const;
+    QVariant oldValue(ArtifactField field) const; // Invalid QVariant if the field is not part of the set
+    QVariant newValue(ArtifactField field) const;
+
+    void apply(ArcheologicalArtifact& artifact) const;  // Writes the new values
+    void revert(ArcheologicalArtifact& artifact) const; // Writes the old values
+
+    // Bytes held outside the object: the changes and the text of their values, counted as if
+    // not shared
+    size_t memoryUsage() const;
+
+private:
+    ArtifactChangeSet(Kind kind, ArtifactHandle handle);
+    const FieldChange* find(ArtifactField field) const;
+
+    Kind m_kind;
+    ArtifactHandle m_handle;
+    ArtifactFieldMask m_fields = 0;
+    std::vector<FieldChange> m_changes;
+};
+
+#endif // ARTIFACT_CHANGE_H
@@ -0,0 +1,97 @@
+#ifndef ARTIFACT_SCHEMA_H
+#define ARTIFACT_SCHEMA_H
+
+#include "artifact.h"
+#include "geo_point.h"
+#include <QString>
+#include <QDate>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+// Compile-time description of one ArcheologicalArtifact field
+template <typename T>
+struct FieldDescriptor {
+    using ValueType = T;
+
+    ArtifactField field;
+    const char* jsonKey;
+    const char* csvHeader;
+    const T& (ArcheologicalArtifact::*get)() const;
+    void (ArcheologicalArtifact::*set)(const T&);
+    bool optional = false; // May be missing from stored data, which then reads as a default value
+};
+
+namespace ArtifactSchema {
+
+// Field table in storage order. Codecs are generated from this list, so a new
+// field only needs an entry here (plus its ArtifactField value). Fields added after
+// data was first stored go last and are optional, so older files still load.
+inline constexpr auto fields = std::make_tuple(
+    FieldDescriptor<QString>{ArtifactField::Id, "id", "ID",
+                             &ArcheologicalArtifact::getId, &ArcheologicalArtifact::setId},
+    FieldDescriptor<QString>{ArtifactField::Name, "name", "Name",
+                             &ArcheologicalArtifact::getName, &ArcheologicalArtifact::setName},
+    FieldDescriptor<QString>{ArtifactField::Description, "description", "Description",
+                             &ArcheologicalArtifact::getDescription, &ArcheologicalArtifact::setDescription},
+    FieldDescriptor<QString>{ArtifactField::Material, "material", "Material",
+                             &ArcheologicalArtifact::getMaterial, &ArcheologicalArtifact::setMaterial},
+    FieldDescriptor<QDate>{ArtifactField::DiscoveryDate, "discoveryDate", "DiscoveryDate",
+                           &ArcheologicalArtifact::getDiscoveryDate, &ArcheologicalArtifact::setDiscoveryDate},
+    FieldDescriptor<QString>{ArtifactField::Location, "location", "Location",
+                             &ArcheologicalArtifact::getLocation, &ArcheologicalArtifact::setLocation},
+    FieldDescriptor<GeoPoint>{ArtifactField::Coordinates, "coordinates", "Coordinates",
+                              &ArcheologicalArtifact::getCoordinates, &ArcheologicalArtifact::setCoordinates, true}
+);
+
+inline constexpr size_t fieldCount = std::tuple_size<std::decay_t<decltype(fields)>>::value;
+static_assert(fieldCount == ArtifactFieldCount, "ArtifactSchema::fields must list every ArtifactField");
+
+// Calls fn(descriptor) for every field; the fold expression unrolls at compile time
+template <typename Fn>
+constexpr void forEachField(Fn&& fn) {
+    std::apply([&fn](const auto&... descriptor) { (fn(descriptor), ...); }, fields);
+}
+
+// Same, but also passes the position of the field as a size_t
+template <typename Fn, size_t... I>
+constexpr void forEachFieldIndexedImpl(Fn&& fn, std::index_sequence<I...>) {
+    (fn(I, std::get<I>(fields)), ...);
+}
+
+template <typename Fn>
+constexpr void forEachFieldIndexed(Fn&& fn) {
+    forEachFieldIndexedImpl(fn, std::make_index_sequence<fieldCount>{});
+}
+
+// Number of leading fields that stored data must have
+constexpr size_t countRequiredFields() {
+    size_t count = 0;
+    bool optionalSeen = false;
+    forEachField([&count, &optionalSeen](const auto& descriptor) {
+        optionalSeen = optionalSeen || descriptor.optional;
+        count += optionalSeen ? 0 : 1;
+    });
+    return count;
+}
+
+inline constexpr size_t requiredFieldCount = countRequiredFields();
+
+using TextGetter = const QString& (ArcheologicalArtifact::*)() const;
+
+// Getter of a text field; nullptr for fields that are not QStrings
+inline TextGetter textGetter(ArtifactField field) {
+    TextGetter getter = nullptr;
+    forEachField([field, &getter](const auto& descriptor) {
+        if constexpr (std::is_same_v<typename std::decay_t<decltype(descriptor)>::ValueType, QString>) {
+            if (descriptor.field == field) {
+                getter = descriptor.get;
+            }
+        }
+    });
+    return getter;
+}
+
+} // namespace ArtifactSchema
+
+#endif // ARTIFACT_SCHEMA_H
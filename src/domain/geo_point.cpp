@@ -0,0 +1,99 @@
+#include "geo_point.h"
+#include <QStringList>
+#include <QLocale>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+inline double radians(double degrees) { return degrees * (Pi / 180.0); }
+
+inline bool inRange(double latitude, double longitude) {
+    // Also rejects NaN
+    return latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0;
+}
+
+} // namespace
+
+GeoPoint::GeoPoint(double latitude, double longitude) {
+    if (inRange(latitude, longitude)) {
+        m_latitude = latitude;
+        m_longitude = longitude;
+        m_valid = true;
+    }
+}
+
+double GeoPoint::distanceKm(const GeoPoint& other) const {
+    const double dLat = std::sin(radians(other.m_latitude - m_latitude) / 2.0);
+    const double dLon = std::sin(radians(other.m_longitude - m_longitude) / 2.0);
+    double h = dLat * dLat + std::cos(radians(m_latitude)) * std::cos(radians(other.m_latitude)) * dLon * dLon;
+    h = std::min(1.0, h); // Rounding can overshoot for antipodal points
+    return 2.0 * EarthRadiusKm * std::asin(std::sqrt(h));
+}
+
+QString GeoPoint::toString() const {
+    if (!m_valid) {
+        return QString();
+    }
+    // The shortest text that reads back as the same double
+    return QString::number(m_latitude, 'g', QLocale::FloatingPointShortest) + ',' +
+           QString::number(m_longitude, 'g', QLocale::FloatingPointShortest);
+}
+
+GeoPoint GeoPoint::fromString(const QString& text) {
+    const QStringList parts = text.split(',');
+    if (parts.size() != 2) {
+        return GeoPoint();
+    }
+    bool latitudeOk = false;
+    bool longitudeOk = false;
+    const double latitude = parts[0].trimmed().toDouble(&latitudeOk);
+    const double longitude = parts[1].trimmed().toDouble(&longitudeOk);
+    if (!latitudeOk || !longitudeOk) {
+        return GeoPoint();
+    }
+    return GeoPoint(latitude, longitude);
+}
+
+bool GeoPoint::operator==(const GeoPoint& other) const {
+    if (m_valid != other.m_valid) {
+        return false;
+    }
+    return !m_valid || (m_latitude == other.m_latitude && m_longitude == other.m_longitude);
+}
+
+QDataStream& operator<<(QDataStream& stream, const GeoPoint& point) {
+    return stream << point.isValid() << point.latitude() << point.longitude();
+}
+
+QDataStream& operator>>(QDataStream& stream, GeoPoint& point) {
+    bool valid = false;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    stream >> valid >> latitude >> longitude;
+    point = valid ? GeoPoint(latitude, longitude) : GeoPoint();
+    return stream;
+}
+
+GeoBox::GeoBox(double south, double west, double north, double east) {
+    if (inRange(south, west) && inRange(north, east) && south <= north) {
+        m_south = south;
+        m_west = west;
+        m_north = north;
+        m_east = east;
+        m_valid = true;
+    }
+}
+
+bool GeoBox::contains(const GeoPoint& point) const {
+    if (!m_valid || !point.isValid() || point.latitude() < m_south || point.latitude() > m_north) {
+        return false;
+    }
+    const double longitude = point.longitude();
+    if (crossesAntimeridian()) {
+        return longitude >= m_west || longitude <= m_east;
+    }
+    return longitude >= m_west && longitude <= m_east;
+}
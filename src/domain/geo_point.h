@@ -0,0 +1,67 @@
+#ifndef GEO_POINT_H
+#define GEO_POINT_H
+
+#include <QString>
+#include <QDataStream>
+#include <QMetaType>
+
+// Position on the earth in decimal degrees (WGS 84). A default-constructed point is null,
+// which is how an artifact without coordinates stores them; like QDate, out-of-range values
+// give a null point rather than an error.
+class GeoPoint {
+public:
+    static constexpr double EarthRadiusKm = 6371.0088; // Mean radius
+
+    GeoPoint() = default;
+    GeoPoint(double latitude, double longitude); // Null unless in [-90, 90] x [-180, 180]
+
+    bool isValid() const { return m_valid; }
+    double latitude() const { return m_latitude; }
+    double longitude() const { return m_longitude; }
+
+    // Great-circle (haversine) distance; requires both points valid
+    double distanceKm(const GeoPoint& other) const;
+
+    // "latitude,longitude", exact to the double; empty for a null point
+    QString toString() const;
+    static GeoPoint fromString(const QString& text); // Null point on empty or malformed text
+
+    bool operator==(const GeoPoint& other) const;
+    bool operator!=(const GeoPoint& other) const { return !(*this == other); }
+
+private:
+    double m_latitude = 0.0;
+    double m_longitude = 0.0;
+    bool m_valid = false;
+};
+
+Q_DECLARE_METATYPE(GeoPoint)
+
+QDataStream& operator<<(QDataStream& stream, const GeoPoint& point);
+QDataStream& operator>>(QDataStream& stream, GeoPoint& point);
+
+// Latitude/longitude rectangle, closed on every side. A box whose west edge lies east of its
+// east edge crosses the antimeridian.
+class GeoBox {
+public:
+    GeoBox() = default;
+    GeoBox(double south, double west, double north, double east); // Null unless south <= north, all in range
+
+    bool isValid() const { return m_valid; }
+    double south() const { return m_south; }
+    double west() const { return m_west; }
+    double north() const { return m_north; }
+    double east() const { return m_east; }
+    bool crossesAntimeridian() const { return m_west > m_east; }
+
+    bool contains(const GeoPoint& point) const;
+
+private:
+    double m_south = 0.0;
+    double m_west = 0.0;
+    double m_north = 0.0;
+    double m_east = 0.0;
+    bool m_valid = false;
+};
+
+#endif // GEO_POINT_H
@@ -0,0 +1,68 @@
+#include "iso_date.h"
+
+namespace {
+
+inline int digit(QChar c) {
+    char16_t u = c.unicode();
+    return (u >= u'0' && u <= u'9') ? static_cast<int>(u - u'0') : -1;
+}
+
+// Parses count ASCII digits starting at pos, -1 if any of them is not a digit
+inline int parseDigits(QStringView text, qsizetype pos, int count) {
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        int d = digit(text[pos + i]);
+        if (d < 0) {
+            return -1;
+        }
+        value = value * 10 + d;
+    }
+    return value;
+}
+
+inline void writeDigits(QChar* out, int value, int count) {
+    for (int i = count - 1; i >= 0; --i) {
+        out[i] = QChar(static_cast<char16_t>(u'0' + value % 10));
+        value /= 10;
+    }
+}
+
+} // namespace
+
+namespace IsoDate {
+
+QDate parse(QStringView text) {
+    // Fast path: exactly yyyy-MM-dd, optionally followed by a time part
+    if (text.size() >= 10 && text[4] == QChar('-') && text[7] == QChar('-')
+        && (text.size() == 10 || text[10] == QChar('T'))) {
+        int year = parseDigits(text, 0, 4);
+        int month = parseDigits(text, 5, 2);
+        int day = parseDigits(text, 8, 2);
+        if (year >= 0 && month >= 0 && day >= 0) {
+            return QDate::isValid(year, month, day) ? QDate(year, month, day) : QDate();
+        }
+    }
+    if (text.isEmpty()) {
+        return QDate();
+    }
+    return QDate::fromString(text.toString(), Qt::ISODate);
+}
+
+QString format(const QDate& date) {
+    if (!date.isValid()) {
+        return QString();
+    }
+    int year = date.year();
+    if (year < 0 || year > 9999) {
+        return date.toString(Qt::ISODate);
+    }
+
+    QString text(10, QChar('-'));
+    QChar* out = text.data();
+    writeDigits(out, year, 4);
+    writeDigits(out + 5, date.month(), 2);
+    writeDigits(out + 8, date.day(), 2);
+    return text;
+}
+
+} // namespace IsoDate
@@ -0,0 +1,17 @@
+#ifndef ISO_DATE_H
+#define ISO_DATE_H
+
+#include <QDate>
+#include <QString>
+#include <QStringView>
+
+// Hand-rolled ISO-8601 (yyyy-MM-dd) date conversion for the load/save hot path.
+// Anything outside the fixed four-digit-year form falls back to QDate's own parser.
+namespace IsoDate {
+
+QDate parse(QStringView text);     // Invalid QDate on malformed input, like QDate::fromString
+QString format(const QDate& date); // Empty string for an invalid date, like QDate::toString
+
+} // namespace IsoDate
+
+#endif // ISO_DATE_H
@@ -0,0 +1,95 @@
+#include "approximate_search.h"
+#include "artifact_table.h"
+#include <algorithm>
+#include <numeric>
+
+ApproximateSearch::ApproximateSearch(const QString& pattern, int maxEdits)
+    : m_pattern(ArtifactTable::foldCase(pattern)), m_maxEdits(std::max(maxEdits, 0)) {
+    const qsizetype length = std::min(m_pattern.size(), MaxBitParallelLength);
+    for (qsizetype i = 0; i < length; ++i) {
+        ushort unit = m_pattern[i].unicode();
+        quint64 bit = quint64(1) << i;
+        if (unit < 128) {
+            m_ascii[unit] |= bit;
+            continue;
+        }
+        auto it = std::find_if(m_other.begin(), m_other.end(), [unit](const auto& entry) { return entry.first == unit; });
+        if (it == m_other.end()) {
+            m_other.emplace_back(unit, bit);
+        } else {
+            it->second |= bit;
+        }
+    }
+}
+
+bool ApproximateSearch::contains(const QString& text) const {
+    return containsFolded(ArtifactTable::foldCase(text));
+}
+
+bool ApproximateSearch::containsFolded(const QString& foldedText) const {
+    const qsizetype length = m_pattern.size();
+    if (length <= m_maxEdits) {
+        return true; // Deleting the whole pattern is within budget
+    }
+    if (length > MaxBitParallelLength) {
+        return containsFoldedLong(foldedText);
+    }
+    // Myers (1999): the column of the edit-distance matrix as vertical +1/-1 deltas in two
+    // words, with score tracking the last row. The top row stays 0 since a match may start anywhere.
+    const quint64 last = quint64(1) << (length - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = static_cast<int>(length);
+    for (QChar c : foldedText) {
+        quint64 eq = mask(c.unicode());
+        quint64 xv = eq | mv;
+        quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+        if (ph & last) {
+            ++score;
+        } else if (mh & last) {
+            --score;
+        }
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        if (score <= m_maxEdits) {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint64 ApproximateSearch::mask(ushort unit) const {
+    if (unit < 128) {
+        return m_ascii[unit];
+    }
+    for (const auto& entry : m_other) {
+        if (entry.first == unit) {
+            return entry.second;
+        }
+    }
+    return 0;
+}
+
+bool ApproximateSearch::containsFoldedLong(const QString& foldedText) const {
+    // Sellers' dynamic program, one column of the matrix per unit of text
+    const qsizetype length = m_pattern.size();
+    std::vector<int> column(static_cast<size_t>(length) + 1);
+    std::iota(column.begin(), column.end(), 0);
+    for (QChar c : foldedText) {
+        int diagonal = 0; // Row 0 of the previous column
+        for (qsizetype i = 1; i <= length; ++i) {
+            int above = column[i];
+            int substitution = diagonal + (m_pattern[i - 1] == c ? 0 : 1);
+            column[i] = std::min({substitution, above + 1, column[i - 1] + 1});
+            diagonal = above;
+        }
+        if (column[length] <= m_maxEdits) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,35 @@
+#ifndef APPROXIMATE_SEARCH_H
+#define APPROXIMATE_SEARCH_H
+
+#include <QString>
+#include <utility>
+#include <vector>
+
+// Approximate substring test prepared once per pattern: does the text hold some substring within
+// maxEdits insertions, deletions or substitutions of the pattern? Case is ignored. Patterns of up
+// to 64 UTF-16 units run Myers' bit-parallel algorithm, one step per unit of text; longer ones
+// fall back to the row-by-row dynamic program.
+class ApproximateSearch {
+public:
+    static constexpr qsizetype MaxBitParallelLength = 64;
+
+    ApproximateSearch(const QString& pattern, int maxEdits);
+
+    bool contains(const QString& text) const;
+    // Same, for text already folded with ArtifactTable::foldCase()
+    bool containsFolded(const QString& foldedText) const;
+
+    const QString& pattern() const { return m_pattern; } // Folded
+    int maxEdits() const { return m_maxEdits; }
+
+private:
+    quint64 mask(ushort unit) const; // Bit i set where pattern unit i equals unit
+    bool containsFoldedLong(const QString& foldedText) const;
+
+    QString m_pattern;
+    int m_maxEdits;
+    quint64 m_ascii[128] = {};
+    std::vector<std::pair<ushort, quint64>> m_other; // Masks of the non-ASCII units, few in practice
+};
+
+#endif // APPROXIMATE_SEARCH_H
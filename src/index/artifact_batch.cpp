@@ -0,0 +1,238 @@
+#include "artifact_batch.h"
+#include "artifact_table.h"
+#include "trigram_index.h"
+#include "roaring_bitmap.h"
+#include "substring_search.h"
+#include "approximate_search.h"
+#include "regex_search.h"
+#include "../domain/artifact_schema.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ARTIFACT_BATCH_SSE2 1
+#endif
+
+namespace {
+
+// Sets bit i of out for every days[i] in [lo, hi]; out must hold (count + 63) / 64 zeroed words
+void scanDayRange(const qint32* days, size_t count, qint32 lo, qint32 hi, quint64* out) {
+    size_t i = 0;
+#ifdef ARTIFACT_BATCH_SSE2
+    const __m128i low = _mm_set1_epi32(lo);
+    const __m128i high = _mm_set1_epi32(hi);
+    for (; i + 4 <= count; i += 4) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(days + i));
+        __m128i outside = _mm_or_si128(_mm_cmplt_epi32(value, low), _mm_cmpgt_epi32(value, high));
+        quint64 inside = static_cast<quint64>(~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF);
+        out[i / 64] |= inside << (i % 64);
+    }
+#endif
+    for (; i < count; ++i) {
+        if (days[i] >= lo && days[i] <= hi) {
+            out[i / 64] |= quint64(1) << (i % 64);
+        }
+    }
+}
+
+} // namespace
+
+ArtifactBatch::ArtifactBatch(const std::vector<ArcheologicalArtifact>& artifacts)
+    : m_artifacts(artifacts.data()), m_size(artifacts.size()) {
+    m_ownedDays.reserve(artifacts.size());
+    for (const auto& artifact : artifacts) {
+        m_ownedDays.push_back(ArtifactTable::toJulianDay(artifact.getDiscoveryDate()));
+    }
+    m_julianDays = m_ownedDays.data();
+}
+
+ArtifactBatch::ArtifactBatch(const ArtifactTable& table)
+    : m_artifacts(table.artifacts().data()), m_size(table.size()), m_julianDays(table.julianDays().data()),
+      m_table(&table) {}
+
+ArtifactBatch::ArtifactBatch(const ArtifactBatch& batch, size_t begin, size_t count)
+    : m_artifacts(batch.m_artifacts + begin), m_size(count), m_julianDays(batch.m_julianDays + begin),
+      m_table(batch.m_table), m_tableOffset(batch.m_tableOffset + begin) {}
+
+bool ArtifactBatch::coversTable() const {
+    return m_table && m_tableOffset == 0 && m_size == m_table->size();
+}
+
+RowBitmap ArtifactBatch::liveRows() const {
+    if (!m_table || m_table->artifactCount() == m_table->size()) {
+        return RowBitmap(m_size, true);
+    }
+    return coversTable() ? m_table->liveRows() : m_table->liveRows().slice(m_tableOffset, m_size);
+}
+
+RowBitmap ArtifactBatch::selectText(ArtifactField field, const QString& needle, TextMatch match,
+                                    Qt::CaseSensitivity sensitivity, const RowBitmap& candidates,
+                                    bool useIndex) const {
+    const ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(field);
+    RowBitmap rows(m_size);
+    if (!getter) {
+        return rows;
+    }
+
+    // Narrow the candidates to the rows holding every trigram of the needle
+    const TrigramIndex* index = m_table ? m_table->trigramIndex(field) : nullptr;
+    RowBitmap indexed;
+    const RowBitmap* live = &candidates;
+    if (useIndex && index && TrigramIndex::canServe(needle)) {
+        indexed = rowsOf(index->candidates(needle));
+        indexed &= candidates;
+        live = &indexed;
+    }
+
+    quint64* words = rows.words();
+    const quint64* liveWords = live->words();
+    const std::vector<QString>* folded = m_table && sensitivity == Qt::CaseInsensitive ? m_table->foldedColumn(field)
+                                                                                      : nullptr;
+    if (folded) {
+        // Folded once at load, the rows only need a case-sensitive comparison
+        const QString foldedNeedle = ArtifactTable::foldCase(needle);
+        const SubstringSearch search(foldedNeedle, Qt::CaseSensitive);
+        const QString* column = folded->data() + m_tableOffset;
+        for (size_t word = 0; word < rows.wordCount(); ++word) {
+            quint64 pending = liveWords[word];
+            quint64 bits = 0;
+            while (pending) {
+                int bit = qCountTrailingZeroBits(pending);
+                pending &= pending - 1;
+                const QString& text = column[word * 64 + bit];
+                bool hit = match == TextMatch::Equals ? text == foldedNeedle : search.contains(text);
+                bits |= quint64(hit) << bit;
+            }
+            words[word] = bits;
+        }
+        return rows;
+    }
+
+    // Build each word in a register and store it once; words without candidates are skipped
+    const SubstringSearch search(needle, sensitivity);
+    for (size_t word = 0; word < rows.wordCount(); ++word) {
+        quint64 pending = liveWords[word];
+        quint64 bits = 0;
+        while (pending) {
+            int bit = qCountTrailingZeroBits(pending);
+            pending &= pending - 1;
+            const QString& text = (m_artifacts[word * 64 + bit].*getter)();
+            bool hit = match == TextMatch::Equals ? text.compare(needle, sensitivity) == 0 : search.contains(text);
+            bits |= quint64(hit) << bit;
+        }
+        words[word] = bits;
+    }
+    return rows;
+}
+
+RowBitmap ArtifactBatch::selectApproximate(ArtifactField field, const ApproximateSearch& search,
+                                           const RowBitmap& candidates) const {
+    const ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(field);
+    RowBitmap rows(m_size);
+    if (!getter) {
+        return rows;
+    }
+
+    const TrigramIndex* index = m_table ? m_table->trigramIndex(field) : nullptr;
+    RowBitmap indexed;
+    const RowBitmap* live = &candidates;
+    if (index && TrigramIndex::canServeApproximate(search.pattern(), search.maxEdits())) {
+        indexed = rowsOf(index->approximateCandidates(search.pattern(), search.maxEdits()));
+        indexed &= candidates;
+        live = &indexed;
+    }
+
+    const std::vector<QString>* folded = m_table ? m_table->foldedColumn(field) : nullptr;
+    live->forEachSetBit([&](size_t row) {
+        bool hit = folded ? search.containsFolded((*folded)[m_tableOffset + row])
+                          : search.contains((m_artifacts[row].*getter)());
+        if (hit) {
+            rows.set(row);
+        }
+    });
+    return rows;
+}
+
+RowBitmap ArtifactBatch::selectRegex(ArtifactField field, const RegexSearch& search,
+                                     const RowBitmap& candidates) const {
+    const ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(field);
+    if (!getter || !search.isValid()) {
+        return RowBitmap(m_size);
+    }
+
+    // Longest literal first: it has the most selective trigrams
+    RowBitmap live = candidates;
+    for (const QString& literal : search.literals()) {
+        live = selectText(field, literal, TextMatch::Contains, search.sensitivity(), live);
+    }
+
+    RowBitmap rows(m_size);
+    live.forEachSetBit([&](size_t row) {
+        if (search.matchesRegex((m_artifacts[row].*getter)())) {
+            rows.set(row);
+        }
+    });
+    return rows;
+}
+
+RowBitmap ArtifactBatch::rowsOf(const std::vector<ArtifactHandle>& handles) const {
+    RowBitmap rows(m_size);
+    for (ArtifactHandle handle : handles) {
+        int row = m_table->rowOf(handle);
+        if (row >= 0 && static_cast<size_t>(row) - m_tableOffset < m_size) {
+            rows.set(static_cast<size_t>(row) - m_tableOffset);
+        }
+    }
+    return rows;
+}
+
+RowBitmap ArtifactBatch::rowsOf(const RoaringBitmap& handles) const {
+    RowBitmap rows(m_size);
+    handles.forEach([this, &rows](quint32 handle) {
+        size_t row = static_cast<size_t>(m_table->rowOf(handle)) - m_tableOffset;
+        if (row < m_size) {
+            rows.set(row);
+        }
+    });
+    return rows;
+}
+
+RowBitmap ArtifactBatch::selectDateRange(const QDate& startDate, const QDate& endDate) const {
+    if (m_table) {
+        // Setting a bit per index entry costs a random access each; the scan streams four days
+        // per instruction, so the index only wins when the slice is a small part of the batch
+        auto slice = m_table->dateIndex().range(ArtifactTable::toJulianDay(startDate),
+                                                ArtifactTable::toJulianDay(endDate));
+        if (prefersDateIndex(static_cast<size_t>(slice.second - slice.first))) {
+            return indexDateRange(startDate, endDate);
+        }
+    }
+    return scanDateRange(startDate, endDate);
+}
+
+RowBitmap ArtifactBatch::scanDateRange(const QDate& startDate, const QDate& endDate) const {
+    RowBitmap rows(m_size);
+    // Same semantics as comparing QDates: an invalid date sorts before every valid one
+    qint32 lo = ArtifactTable::toJulianDay(startDate);
+    qint32 hi = ArtifactTable::toJulianDay(endDate);
+    if (lo <= hi) {
+        scanDayRange(m_julianDays, m_size, lo, hi, rows.words());
+    }
+    return rows;
+}
+
+RowBitmap ArtifactBatch::indexDateRange(const QDate& startDate, const QDate& endDate) const {
+    RowBitmap rows(m_size);
+    qint32 lo = ArtifactTable::toJulianDay(startDate);
+    qint32 hi = ArtifactTable::toJulianDay(endDate);
+    if (lo > hi) {
+        return rows;
+    }
+    auto slice = m_table->dateIndex().range(lo, hi);
+    for (const DateIndex::Entry* entry = slice.first; entry != slice.second; ++entry) {
+        size_t row = static_cast<size_t>(m_table->rowOf(entry->handle)) - m_tableOffset;
+        if (row < m_size) {
+            rows.set(row);
+        }
+    }
+    return rows;
+}
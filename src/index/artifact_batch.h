@@ -0,0 +1,82 @@
+#ifndef ARTIFACT_BATCH_H
+#define ARTIFACT_BATCH_H
+
+#include "../domain/artifact.h"
+#include "row_bitmap.h"
+#include <QString>
+#include <QDate>
+#include <vector>
+
+class ArtifactTable;
+class RoaringBitmap;
+class ApproximateSearch;
+class RegexSearch;
+
+// How a text filter compares its needle with the field value
+enum class TextMatch {
+    Contains,
+    Equals
+};
+
+// Read-only columnar view over a contiguous run of artifacts, the unit of work for
+// FilterStrategy::matchBatch(). A view over an ArtifactTable borrows its day column;
+// a view over a plain vector derives the column once on construction.
+// The view does not own the artifacts, which must outlive it. A view over a table includes
+// its tombstones, blank artifacts that liveRows() leaves out.
+class ArtifactBatch {
+public:
+    explicit ArtifactBatch(const std::vector<ArcheologicalArtifact>& artifacts);
+    explicit ArtifactBatch(const ArtifactTable& table);
+    // Rows [begin, begin + count) of another batch, sharing its storage
+    ArtifactBatch(const ArtifactBatch& batch, size_t begin, size_t count);
+    ArtifactBatch(const ArtifactBatch&) = delete;
+    ArtifactBatch& operator=(const ArtifactBatch&) = delete;
+
+    size_t size() const { return m_size; }
+    const ArcheologicalArtifact& artifact(size_t row) const { return m_artifacts[row]; }
+    const qint32* julianDays() const { return m_julianDays; }
+
+    const ArtifactTable* table() const { return m_table; } // nullptr for a batch over a plain vector
+    size_t tableOffset() const { return m_tableOffset; }  // Table row of batch row 0
+    bool coversTable() const;                              // Views every row of its table
+    RowBitmap liveRows() const; // Rows that hold artifacts: all but the table's tombstones
+
+    // Candidate rows whose text field contains (or equals) needle; other rows are not read.
+    // Over a table with a trigram index on the field, only the index's candidates are verified
+    // unless useIndex is false.
+    RowBitmap selectText(ArtifactField field, const QString& needle, TextMatch match,
+                         Qt::CaseSensitivity sensitivity, const RowBitmap& candidates,
+                         bool useIndex = true) const;
+    // Candidate rows whose text field holds the search's pattern within its edit budget. Over a
+    // table with a trigram index on the field, rows sharing too few trigrams are skipped.
+    RowBitmap selectApproximate(ArtifactField field, const ApproximateSearch& search,
+                                const RowBitmap& candidates) const;
+    // Candidate rows whose text field the search's regex matches. Its literals narrow the
+    // candidates first, through selectText() and so the trigram index where the field has one;
+    // the regex engine only sees the rows holding all of them.
+    RowBitmap selectRegex(ArtifactField field, const RegexSearch& search, const RowBitmap& candidates) const;
+    // Rows of the given handles; requires table()
+    RowBitmap rowsOf(const RoaringBitmap& handles) const;
+    // Rows whose discovery date lies in [startDate, endDate]. A narrow range over a table reads
+    // the slice of its date index; anything else is a SIMD scan of the day column.
+    RowBitmap selectDateRange(const QDate& startDate, const QDate& endDate) const;
+    // The two access paths of selectDateRange(); indexDateRange() requires table()
+    RowBitmap scanDateRange(const QDate& startDate, const QDate& endDate) const;
+    RowBitmap indexDateRange(const QDate& startDate, const QDate& endDate) const;
+    // Whether selectDateRange() would read the date index for a slice of sliceRows entries
+    bool prefersDateIndex(size_t sliceRows) const { return m_table && sliceRows * DateIndexScanRatio < m_size; }
+
+private:
+    static constexpr size_t DateIndexScanRatio = 16;
+
+    RowBitmap rowsOf(const std::vector<ArtifactHandle>& handles) const; // Ascending handles; requires table()
+
+    const ArcheologicalArtifact* m_artifacts;
+    size_t m_size;
+    const qint32* m_julianDays;
+    std::vector<qint32> m_ownedDays; // Only used by the vector constructor
+    const ArtifactTable* m_table = nullptr; // Set when the batch views (part of) a table
+    size_t m_tableOffset = 0;               // Table row of batch row 0
+};
+
+#endif // ARTIFACT_BATCH_H
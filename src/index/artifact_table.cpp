@@ -0,0 +1,399 @@
+#include "artifact_table.h"
+#include "artifact_batch.h"
+#include "../domain/artifact_schema.h"
+
+bool ArtifactTable::rebuild(const std::vector<ArcheologicalArtifact>& artifacts, const QString& fullTextPath) {
+    ++m_version;
+    // Tokenizing every description is most of the rebuild; a saved index skips it
+    const bool fullTextLoaded = !fullTextPath.isEmpty() && m_fullText.load(fullTextPath, artifacts, FullTextField);
+    if (!fullTextLoaded) {
+        m_fullText.clear();
+    }
+    m_artifacts.clear();
+    m_julianDays.clear();
+    m_rowOfHandle.clear();
+    m_liveRows = RowBitmap();
+    m_deadRows = 0;
+    for (TrigramIndex& index : m_trigrams) {
+        index.clear();
+    }
+    for (BitmapIndex& index : m_bitmaps) {
+        index.clear();
+    }
+    for (RadixTrie& trie : m_completions) {
+        trie.clear();
+    }
+    m_nearDuplicates.clear();
+    m_nearDuplicatesBuilt = false;
+    for (std::vector<QString>& column : m_folded) {
+        column.clear();
+    }
+    m_artifacts.reserve(artifacts.size());
+    m_julianDays.reserve(artifacts.size());
+    for (const auto& artifact : artifacts) {
+        appendRow(artifact, !fullTextLoaded);
+    }
+    
+    // Sort the date index and pack the R-tree once instead of inserting row by row
+    std::vector<DateIndex::Entry> entries;
+    std::vector<RTree::Entry> points;
+    entries.reserve(m_artifacts.size());
+    for (size_t row = 0; row < m_artifacts.size(); ++row) {
+        entries.push_back({m_julianDays[row], m_artifacts[row].getHandle()});
+        if (m_artifacts[row].getCoordinates().isValid()) {
+            points.push_back({m_artifacts[row].getCoordinates(), m_artifacts[row].getHandle()});
+        }
+    }
+    m_dates.assign(std::move(entries));
+    m_spatial.assign(std::move(points));
+    return fullTextLoaded;
+}
+
+void ArtifactTable::onArtifactChanged(const ArtifactChangeSet& change) {
+    ++m_version;
+    // Only between changes, since observers after the table still read the row of a removal
+    if (m_deadRows > artifactCount()) {
+        compact();
+    }
+    switch (change.kind()) {
+    case ArtifactChangeSet::Kind::Added: {
+        ArcheologicalArtifact artifact;
+        change.apply(artifact);
+        artifact.setHandle(change.handle());
+        artifact.clearDirtyFields();
+        appendRow(artifact);
+        m_dates.insert(m_julianDays.back(), artifact.getHandle());
+        m_spatial.insert(artifact.getCoordinates(), artifact.getHandle());
+        break;
+    }
+    case ArtifactChangeSet::Kind::Removed: {
+        int row = rowOf(change.handle());
+        if (row >= 0 && isLive(static_cast<size_t>(row))) {
+            m_dates.remove(m_julianDays[row], change.handle());
+            m_spatial.remove(m_artifacts[row].getCoordinates(), change.handle());
+            tombstoneRow(static_cast<size_t>(row));
+        }
+        break;
+    }
+    case ArtifactChangeSet::Kind::Updated: {
+        int row = rowOf(change.handle());
+        if (row >= 0 && isLive(static_cast<size_t>(row))) {
+            ArcheologicalArtifact& artifact = m_artifacts[row];
+            if (change.touches(ArtifactField::Coordinates)) {
+                m_spatial.remove(artifact.getCoordinates(), artifact.getHandle());
+            }
+            for (const FieldChange& fieldChange : change.changes()) {
+                if ((TrigramIndexedFields | BitmapIndexedFields | CompletionFields) & fieldBit(fieldChange.field)) {
+                    indexTextField(fieldChange.field, artifact.getHandle(), fieldChange.oldValue.toString(), false);
+                    indexTextField(fieldChange.field, artifact.getHandle(), fieldChange.newValue.toString(), true);
+                }
+                if (fieldChange.field == FullTextField) {
+                    m_fullText.remove(artifact.getHandle(), fieldChange.oldValue.toString());
+                    m_fullText.insert(artifact.getHandle(), fieldChange.newValue.toString());
+                }
+            }
+            change.apply(artifact);
+            artifact.clearDirtyFields();
+            for (const FieldChange& fieldChange : change.changes()) {
+                if (isFolded(fieldChange.field)) {
+                    m_folded[static_cast<size_t>(fieldChange.field)][row] = foldCase(fieldChange.newValue.toString());
+                }
+            }
+            if (change.touches(ArtifactField::DiscoveryDate)) {
+                m_dates.remove(m_julianDays[row], artifact.getHandle());
+                m_julianDays[row] = toJulianDay(artifact.getDiscoveryDate());
+                m_dates.insert(m_julianDays[row], artifact.getHandle());
+            }
+            if (change.touches(ArtifactField::Coordinates)) {
+                m_spatial.insert(artifact.getCoordinates(), artifact.getHandle());
+            }
+            if (m_nearDuplicatesBuilt && (change.fields() & NearDuplicateFields)) {
+                m_nearDuplicates.insert(artifact.getHandle(), nearDuplicateText(artifact));
+            }
+        }
+        break;
+    }
+    }
+}
+
+size_t ArtifactTable::size() const { return m_artifacts.size(); }
+size_t ArtifactTable::artifactCount() const { return m_artifacts.size() - m_deadRows; }
+bool ArtifactTable::empty() const { return artifactCount() == 0; }
+bool ArtifactTable::isLive(size_t row) const { return m_liveRows.test(row); }
+const RowBitmap& ArtifactTable::liveRows() const { return m_liveRows; }
+const std::vector<ArcheologicalArtifact>& ArtifactTable::artifacts() const { return m_artifacts; }
+const ArcheologicalArtifact& ArtifactTable::artifact(size_t row) const { return m_artifacts[row]; }
+ArtifactHandle ArtifactTable::handle(size_t row) const { return m_artifacts[row].getHandle(); }
+const std::vector<qint32>& ArtifactTable::julianDays() const { return m_julianDays; }
+const DateIndex& ArtifactTable::dateIndex() const { return m_dates; }
+
+int ArtifactTable::rowOf(ArtifactHandle handle) const {
+    if (handle >= m_rowOfHandle.size()) {
+        return -1;
+    }
+    return m_rowOfHandle[handle];
+}
+
+qint32 ArtifactTable::toJulianDay(const QDate& date) {
+    if (!date.isValid()) {
+        return InvalidJulianDay;
+    }
+    qint64 day = date.toJulianDay();
+    // Saturate the (theoretical) dates outside the int32 range
+    if (day <= std::numeric_limits<qint32>::min()) return std::numeric_limits<qint32>::min() + 1;
+    if (day > std::numeric_limits<qint32>::max()) return std::numeric_limits<qint32>::max();
+    return static_cast<qint32>(day);
+}
+
+RowBitmap ArtifactTable::selectDateRange(const QDate& startDate, const QDate& endDate) const {
+    return ArtifactBatch(*this).selectDateRange(startDate, endDate);
+}
+
+const TrigramIndex* ArtifactTable::trigramIndex(ArtifactField field) const {
+    if (!(TrigramIndexedFields & fieldBit(field))) {
+        return nullptr;
+    }
+    return &m_trigrams[static_cast<size_t>(field)];
+}
+
+const BitmapIndex* ArtifactTable::bitmapIndex(ArtifactField field) const {
+    if (!(BitmapIndexedFields & fieldBit(field))) {
+        return nullptr;
+    }
+    return &m_bitmaps[static_cast<size_t>(field)];
+}
+
+const RadixTrie* ArtifactTable::completionTrie(ArtifactField field) const {
+    if (!(CompletionFields & fieldBit(field))) {
+        return nullptr;
+    }
+    return &m_completions[static_cast<size_t>(field)];
+}
+
+const RTree& ArtifactTable::spatialIndex() const {
+    return m_spatial;
+}
+
+const MinHashIndex& ArtifactTable::nearDuplicateIndex() const {
+    if (!m_nearDuplicatesBuilt) {
+        m_nearDuplicates.reserve(m_artifacts.size());
+        m_liveRows.forEachSetBit([this](size_t row) {
+            m_nearDuplicates.insert(m_artifacts[row].getHandle(), nearDuplicateText(m_artifacts[row]));
+        });
+        m_nearDuplicatesBuilt = true;
+    }
+    return m_nearDuplicates;
+}
+
+QString ArtifactTable::nearDuplicateText(const ArcheologicalArtifact& artifact) {
+    return artifact.getName() + '\n' + artifact.getDescription();
+}
+
+const FullTextIndex& ArtifactTable::fullTextIndex() const {
+    return m_fullText;
+}
+
+bool ArtifactTable::saveFullTextIndex(const QString& path) const {
+    if (m_deadRows == 0) {
+        return m_fullText.save(path, m_artifacts, FullTextField);
+    }
+    // Saved for the artifacts as the repository lists them, without the tombstones
+    std::vector<ArcheologicalArtifact> artifacts;
+    artifacts.reserve(artifactCount());
+    m_liveRows.forEachSetBit([this, &artifacts](size_t row) {
+        artifacts.push_back(m_artifacts[row]);
+    });
+    return m_fullText.save(path, artifacts, FullTextField);
+}
+
+void ArtifactTable::setFoldedFields(ArtifactFieldMask fields) {
+    m_foldedFields = fields;
+    for (size_t field = 0; field < ArtifactFieldCount; ++field) {
+        std::vector<QString>& column = m_folded[field];
+        if (!isFolded(static_cast<ArtifactField>(field))) {
+            std::vector<QString>().swap(column);
+            continue;
+        }
+        if (column.size() == m_artifacts.size()) {
+            continue; // Already built
+        }
+        const ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(static_cast<ArtifactField>(field));
+        column.clear();
+        column.reserve(m_artifacts.size());
+        for (const auto& artifact : m_artifacts) {
+            column.push_back(foldCase((artifact.*getter)()));
+        }
+    }
+}
+
+ArtifactFieldMask ArtifactTable::foldedFields() const {
+    return m_foldedFields;
+}
+
+const std::vector<QString>* ArtifactTable::foldedColumn(ArtifactField field) const {
+    return isFolded(field) ? &m_folded[static_cast<size_t>(field)] : nullptr;
+}
+
+size_t ArtifactTable::foldedColumnBytes() const {
+    size_t bytes = 0;
+    for (size_t field = 0; field < ArtifactFieldCount; ++field) {
+        const std::vector<QString>& column = m_folded[field];
+        if (column.empty()) {
+            continue;
+        }
+        const ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(static_cast<ArtifactField>(field));
+        bytes += column.capacity() * sizeof(QString);
+        for (size_t row = 0; row < column.size(); ++row) {
+            if (column[row].constData() != (m_artifacts[row].*getter)().constData()) {
+                bytes += static_cast<size_t>(column[row].size()) * sizeof(QChar);
+            }
+        }
+    }
+    return bytes;
+}
+
+QString ArtifactTable::foldCase(const QString& text) {
+    // ASCII only needs A-Z lowered, and text without upper case is returned shared
+    const qsizetype size = text.size();
+    const QChar* data = text.constData();
+    qsizetype first = 0;
+    for (; first < size; ++first) {
+        char16_t c = data[first].unicode();
+        if (c >= 0x80) {
+            return text.toCaseFolded();
+        }
+        if (c >= 'A' && c <= 'Z') {
+            break;
+        }
+    }
+    if (first == size) {
+        return text;
+    }
+    QString folded = text;
+    QChar* out = folded.data();
+    for (qsizetype i = first; i < size; ++i) {
+        char16_t c = out[i].unicode();
+        if (c >= 0x80) {
+            return text.toCaseFolded();
+        }
+        if (c >= 'A' && c <= 'Z') {
+            out[i] = QChar(static_cast<char16_t>(c + ('a' - 'A')));
+        }
+    }
+    return folded;
+}
+
+void ArtifactTable::appendRow(const ArcheologicalArtifact& artifact, bool indexFullText) {
+    setRowOf(artifact.getHandle(), static_cast<int>(m_artifacts.size()));
+    m_artifacts.push_back(artifact);
+    m_julianDays.push_back(toJulianDay(artifact.getDiscoveryDate()));
+    m_liveRows.push_back(true);
+    indexText(artifact, true);
+    if (m_nearDuplicatesBuilt) {
+        m_nearDuplicates.insert(artifact.getHandle(), nearDuplicateText(artifact));
+    }
+    if (indexFullText) {
+        m_fullText.insert(artifact.getHandle(), (artifact.*ArtifactSchema::textGetter(FullTextField))());
+    }
+    for (size_t field = 0; field < ArtifactFieldCount; ++field) {
+        if (isFolded(static_cast<ArtifactField>(field))) {
+            m_folded[field].push_back(foldCase((artifact.*ArtifactSchema::textGetter(static_cast<ArtifactField>(field)))()));
+        }
+    }
+}
+
+void ArtifactTable::tombstoneRow(size_t row) {
+    const ArtifactHandle handle = m_artifacts[row].getHandle();
+    indexText(m_artifacts[row], false);
+    if (m_nearDuplicatesBuilt) {
+        m_nearDuplicates.remove(handle);
+    }
+    m_fullText.remove(handle, (m_artifacts[row].*ArtifactSchema::textGetter(FullTextField))());
+    // The row keeps its handle, so rowOf() still leads to it, but none of its values
+    m_artifacts[row] = ArcheologicalArtifact();
+    m_artifacts[row].setHandle(handle);
+    m_julianDays[row] = InvalidJulianDay;
+    for (std::vector<QString>& column : m_folded) {
+        if (!column.empty()) {
+            column[row] = QString();
+        }
+    }
+    m_liveRows.reset(row);
+    ++m_deadRows;
+}
+
+void ArtifactTable::compact() {
+    // The artifacts move up over the tombstones in order, so repository order is kept
+    size_t live = 0;
+    for (size_t row = 0; row < m_artifacts.size(); ++row) {
+        if (!m_liveRows.test(row)) {
+            setRowOf(m_artifacts[row].getHandle(), -1);
+            continue;
+        }
+        if (live != row) {
+            m_artifacts[live] = std::move(m_artifacts[row]);
+            m_julianDays[live] = m_julianDays[row];
+            for (std::vector<QString>& column : m_folded) {
+                if (!column.empty()) {
+                    column[live] = std::move(column[row]);
+                }
+            }
+        }
+        setRowOf(m_artifacts[live].getHandle(), static_cast<int>(live));
+        ++live;
+    }
+    m_artifacts.resize(live);
+    m_julianDays.resize(live);
+    for (std::vector<QString>& column : m_folded) {
+        if (!column.empty()) {
+            column.resize(live);
+        }
+    }
+    m_liveRows = RowBitmap(live, true);
+    m_deadRows = 0;
+}
+
+void ArtifactTable::setRowOf(ArtifactHandle handle, int row) {
+    if (handle >= m_rowOfHandle.size()) {
+        m_rowOfHandle.resize(static_cast<size_t>(handle) + 1, -1);
+    }
+    m_rowOfHandle[handle] = row;
+}
+
+bool ArtifactTable::isFolded(ArtifactField field) const {
+    return (m_foldedFields & fieldBit(field)) && ArtifactSchema::textGetter(field);
+}
+
+void ArtifactTable::indexText(const ArcheologicalArtifact& artifact, bool insert) {
+    for (size_t field = 0; field < ArtifactFieldCount; ++field) {
+        ArtifactField key = static_cast<ArtifactField>(field);
+        if ((TrigramIndexedFields | BitmapIndexedFields | CompletionFields) & fieldBit(key)) {
+            indexTextField(key, artifact.getHandle(), (artifact.*ArtifactSchema::textGetter(key))(), insert);
+        }
+    }
+}
+
+void ArtifactTable::indexTextField(ArtifactField field, ArtifactHandle handle, const QString& text, bool insert) {
+    const size_t slot = static_cast<size_t>(field);
+    if (TrigramIndexedFields & fieldBit(field)) {
+        if (insert) {
+            m_trigrams[slot].insert(handle, text);
+        } else {
+            m_trigrams[slot].remove(handle, text);
+        }
+    }
+    if (BitmapIndexedFields & fieldBit(field)) {
+        if (insert) {
+            m_bitmaps[slot].insert(handle, text);
+        } else {
+            m_bitmaps[slot].remove(handle, text);
+        }
+    }
+    if (CompletionFields & fieldBit(field)) {
+        if (insert) {
+            m_completions[slot].insert(text);
+        } else {
+            m_completions[slot].remove(text);
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef ARTIFACT_TABLE_H
+#define ARTIFACT_TABLE_H
+
+#include "../domain/artifact.h"
+#include "../domain/artifact_change.h"
+#include "../repository/repository.h"
+#include "row_bitmap.h"
+#include "trigram_index.h"
+#include "date_index.h"
+#include "bitmap_index.h"
+#include "full_text_index.h"
+#include "radix_trie.h"
+#include "rtree.h"
+#include "minhash_index.h"
+#include <QDate>
+#include <vector>
+#include <limits>
+#include <array>
+
+// In-memory mirror of the repository, kept in repository order and addressed by row.
+// A removed artifact leaves its row behind as a tombstone holding a blank artifact, so the
+// rows of the others stay put and removal costs the same whatever the catalog size; once
+// tombstones outnumber the artifacts, the next change first compacts the rows, in order.
+// Besides the artifacts themselves it keeps contiguous columns for scans
+// (currently the discovery date as an int32 Julian day), an ordered date index,
+// trigram indexes over the short text fields that substring filters search,
+// value bitmaps for the low-cardinality fields, a full-text index over descriptions,
+// prefix tries of the values users type into filters, an R-tree of the coordinates and MinHash
+// signatures of the names and descriptions for near-duplicate detection.
+class ArtifactTable : public RepositoryObserver {
+public:
+    // Indexes the artifacts. With fullTextPath, the full-text index is read from that file instead
+    // of built, provided it was saved for exactly these artifacts; returns whether it was.
+    bool rebuild(const std::vector<ArcheologicalArtifact>& artifacts, const QString& fullTextPath = QString());
+    void onArtifactChanged(const ArtifactChangeSet& change) override;
+
+    size_t size() const;          // Rows, tombstones included
+    size_t artifactCount() const; // Rows holding artifacts
+    bool empty() const;           // No artifacts
+    bool isLive(size_t row) const;     // False for tombstones
+    const RowBitmap& liveRows() const; // A bit per row, set for those holding artifacts
+    const std::vector<ArcheologicalArtifact>& artifacts() const; // Per row, tombstones included
+    const ArcheologicalArtifact& artifact(size_t row) const;
+    ArtifactHandle handle(size_t row) const;
+    // -1 if the handle was never in the table or its tombstone was compacted away. A removed
+    // artifact keeps its row until then, so observers after the table can still place it.
+    int rowOf(ArtifactHandle handle) const;
+    // Bumped by every rebuild and change set; results computed at another version are stale
+    quint64 version() const { return m_version; }
+
+    // Discovery date column; invalid dates are stored as InvalidJulianDay
+    const std::vector<qint32>& julianDays() const;
+    static constexpr qint32 InvalidJulianDay = std::numeric_limits<qint32>::min();
+    static qint32 toJulianDay(const QDate& date);
+
+    // Discovery date column ordered by day, for range queries that select few rows
+    const DateIndex& dateIndex() const;
+
+    // Rows whose discovery date lies in [startDate, endDate]
+    RowBitmap selectDateRange(const QDate& startDate, const QDate& endDate) const;
+
+    // Fields with a trigram index; descriptions are long and not indexed
+    static constexpr ArtifactFieldMask TrigramIndexedFields =
+        fieldBit(ArtifactField::Id) | fieldBit(ArtifactField::Name) |
+        fieldBit(ArtifactField::Material) | fieldBit(ArtifactField::Location);
+    const TrigramIndex* trigramIndex(ArtifactField field) const; // nullptr if the field is not indexed
+
+    // Fields with one handle bitmap per distinct value
+    static constexpr ArtifactFieldMask BitmapIndexedFields =
+        fieldBit(ArtifactField::Material) | fieldBit(ArtifactField::Location);
+    const BitmapIndex* bitmapIndex(ArtifactField field) const; // nullptr if the field is not indexed
+
+    // Words of the descriptions, for ranked search
+    static constexpr ArtifactField FullTextField = ArtifactField::Description;
+    const FullTextIndex& fullTextIndex() const;
+    bool saveFullTextIndex(const QString& path) const;
+
+    // Distinct values with their frequencies, for type-ahead completion
+    static constexpr ArtifactFieldMask CompletionFields =
+        fieldBit(ArtifactField::Name) | fieldBit(ArtifactField::Material) | fieldBit(ArtifactField::Location);
+    const RadixTrie* completionTrie(ArtifactField field) const; // nullptr if the field has no trie
+
+    // Coordinates of the artifacts that have them, for box, radius and nearest-neighbour queries
+    const RTree& spatialIndex() const;
+
+    // MinHash signatures of nearDuplicateText(), bucketed for candidate pairs. Built on first use,
+    // since few sessions look for duplicates, and kept current from then on.
+    static constexpr ArtifactFieldMask NearDuplicateFields =
+        fieldBit(ArtifactField::Name) | fieldBit(ArtifactField::Description);
+    const MinHashIndex& nearDuplicateIndex() const;
+    static QString nearDuplicateText(const ArcheologicalArtifact& artifact);
+
+    // Case-folded shadow copies of text columns, so case-insensitive searches become plain
+    // case-sensitive ones. Text without upper case shares the storage of the original, so the
+    // cost is mostly one QString per row and column; 0 drops them all.
+    static constexpr ArtifactFieldMask DefaultFoldedFields =
+        fieldBit(ArtifactField::Id) | fieldBit(ArtifactField::Name) | fieldBit(ArtifactField::Description) |
+        fieldBit(ArtifactField::Material) | fieldBit(ArtifactField::Location);
+    void setFoldedFields(ArtifactFieldMask fields); // Non-text fields are ignored
+    ArtifactFieldMask foldedFields() const;
+    const std::vector<QString>* foldedColumn(ArtifactField field) const; // nullptr if the field is not folded
+    size_t foldedColumnBytes() const; // Memory of the shadow columns, not counting shared text
+    // The simple case folding Qt::CaseInsensitive comparisons apply, with an ASCII fast path
+    static QString foldCase(const QString& text);
+
+private:
+    void appendRow(const ArcheologicalArtifact& artifact, bool indexFullText = true);
+    void tombstoneRow(size_t row);
+    void compact();
+    void setRowOf(ArtifactHandle handle, int row);
+    void indexText(const ArcheologicalArtifact& artifact, bool insert);
+    void indexTextField(ArtifactField field, ArtifactHandle handle, const QString& text, bool insert);
+    bool isFolded(ArtifactField field) const;
+
+    std::vector<ArcheologicalArtifact> m_artifacts;
+    std::vector<qint32> m_julianDays;
+    std::vector<int> m_rowOfHandle; // Indexed by handle, -1 when absent
+    RowBitmap m_liveRows;
+    size_t m_deadRows = 0;
+    DateIndex m_dates;
+    std::array<TrigramIndex, ArtifactFieldCount> m_trigrams; // Indexed by ArtifactField; see TrigramIndexedFields
+    std::array<BitmapIndex, ArtifactFieldCount> m_bitmaps;   // Same, see BitmapIndexedFields
+    FullTextIndex m_fullText;                                 // Over FullTextField
+    std::array<RadixTrie, ArtifactFieldCount> m_completions;  // Same, see CompletionFields
+    RTree m_spatial;                                          // Over the coordinates
+    mutable MinHashIndex m_nearDuplicates;                    // Over NearDuplicateFields, once built
+    mutable bool m_nearDuplicatesBuilt = false;
+    std::array<std::vector<QString>, ArtifactFieldCount> m_folded; // Same, see foldedFields(); one entry per row
+    ArtifactFieldMask m_foldedFields = DefaultFoldedFields;
+    quint64 m_version = 0;
+};
+
+#endif // ARTIFACT_TABLE_H
@@ -0,0 +1,97 @@
+#include "bitmap_index.h"
+#include <algorithm>
+
+void BitmapIndex::insert(ArtifactHandle handle, const QString& value) {
+    m_bitmaps[value].add(handle);
+}
+
+void BitmapIndex::remove(ArtifactHandle handle, const QString& value) {
+    auto entry = m_bitmaps.find(value);
+    if (entry == m_bitmaps.end()) {
+        return;
+    }
+    entry.value().remove(handle);
+    if (entry.value().isEmpty()) {
+        m_bitmaps.erase(entry);
+    }
+}
+
+void BitmapIndex::clear() {
+    m_bitmaps.clear();
+}
+
+size_t BitmapIndex::distinctValues() const {
+    return static_cast<size_t>(m_bitmaps.size());
+}
+
+bool BitmapIndex::isLowCardinality(size_t rows) const {
+    return distinctValues() * LowCardinalityRatio <= rows;
+}
+
+std::vector<QString> BitmapIndex::values() const {
+    std::vector<QString> result;
+    result.reserve(m_bitmaps.size());
+    for (auto it = m_bitmaps.constBegin(); it != m_bitmaps.constEnd(); ++it) {
+        result.push_back(it.key());
+    }
+    return result;
+}
+
+std::vector<std::pair<QString, size_t>> BitmapIndex::valueCounts() const {
+    std::vector<std::pair<QString, size_t>> counts;
+    counts.reserve(static_cast<size_t>(m_bitmaps.size()));
+    for (auto it = m_bitmaps.constBegin(); it != m_bitmaps.constEnd(); ++it) {
+        counts.emplace_back(it.key(), it.value().cardinality());
+    }
+    std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    return counts;
+}
+
+size_t BitmapIndex::countEqualTo(const QString& value, Qt::CaseSensitivity sensitivity) const {
+    if (sensitivity == Qt::CaseSensitive) {
+        auto it = m_bitmaps.constFind(value);
+        return it == m_bitmaps.constEnd() ? 0 : it.value().cardinality();
+    }
+    size_t count = 0;
+    for (auto it = m_bitmaps.constBegin(); it != m_bitmaps.constEnd(); ++it) {
+        if (it.key().compare(value, Qt::CaseInsensitive) == 0) {
+            count += it.value().cardinality();
+        }
+    }
+    return count;
+}
+
+size_t BitmapIndex::countContaining(const QString& needle, Qt::CaseSensitivity sensitivity) const {
+    size_t count = 0;
+    for (auto it = m_bitmaps.constBegin(); it != m_bitmaps.constEnd(); ++it) {
+        if (it.key().contains(needle, sensitivity)) {
+            count += it.value().cardinality();
+        }
+    }
+    return count;
+}
+
+RoaringBitmap BitmapIndex::equalTo(const QString& value, Qt::CaseSensitivity sensitivity) const {
+    if (sensitivity == Qt::CaseSensitive) {
+        return m_bitmaps.value(value);
+    }
+    RoaringBitmap result;
+    for (auto it = m_bitmaps.constBegin(); it != m_bitmaps.constEnd(); ++it) {
+        if (it.key().compare(value, Qt::CaseInsensitive) == 0) {
+            result |= it.value();
+        }
+    }
+    return result;
+}
+
+RoaringBitmap BitmapIndex::containing(const QString& needle, Qt::CaseSensitivity sensitivity) const {
+    RoaringBitmap result;
+    for (auto it = m_bitmaps.constBegin(); it != m_bitmaps.constEnd(); ++it) {
+        if (it.key().contains(needle, sensitivity)) {
+            result |= it.value();
+        }
+    }
+    return result;
+}
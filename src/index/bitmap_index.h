@@ -0,0 +1,38 @@
+#ifndef BITMAP_INDEX_H
+#define BITMAP_INDEX_H
+
+#include "../domain/artifact.h"
+#include "roaring_bitmap.h"
+#include <QHash>
+#include <QString>
+#include <vector>
+
+// Value index for a low-cardinality text field: one compressed bitmap of handles per
+// distinct value. Equality is a hash lookup, and a substring query only has to test the
+// distinct values and union their bitmaps, so neither touches the rows themselves.
+class BitmapIndex {
+public:
+    // Value searches are only worth it while the distinct values are few compared to the rows
+    static constexpr size_t LowCardinalityRatio = 8;
+
+    void insert(ArtifactHandle handle, const QString& value);
+    void remove(ArtifactHandle handle, const QString& value); // value must be the one inserted
+    void clear();
+
+    size_t distinctValues() const;
+    bool isLowCardinality(size_t rows) const;
+    std::vector<QString> values() const;
+    // Handles per distinct value, most frequent first; the value histogram of the field
+    std::vector<std::pair<QString, size_t>> valueCounts() const;
+    // Sizes of equalTo() / containing() without building the bitmaps (each handle has one value)
+    size_t countEqualTo(const QString& value, Qt::CaseSensitivity sensitivity) const;
+    size_t countContaining(const QString& needle, Qt::CaseSensitivity sensitivity) const;
+
+    RoaringBitmap equalTo(const QString& value, Qt::CaseSensitivity sensitivity) const;
+    RoaringBitmap containing(const QString& needle, Qt::CaseSensitivity sensitivity) const;
+
+private:
+    QHash<QString, RoaringBitmap> m_bitmaps; // Exact value -> handles, never empty
+};
+
+#endif // BITMAP_INDEX_H
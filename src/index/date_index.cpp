@@ -0,0 +1,52 @@
+#include "date_index.h"
+#include <algorithm>
+
+namespace {
+
+bool entryLess(const DateIndex::Entry& a, const DateIndex::Entry& b) {
+    return a.day < b.day || (a.day == b.day && a.handle < b.handle);
+}
+
+} // namespace
+
+void DateIndex::assign(std::vector<Entry> entries) {
+    m_entries = std::move(entries);
+    std::sort(m_entries.begin(), m_entries.end(), entryLess);
+}
+
+void DateIndex::insert(qint32 day, ArtifactHandle handle) {
+    Entry entry{day, handle};
+    m_entries.insert(std::upper_bound(m_entries.begin(), m_entries.end(), entry, entryLess), entry);
+}
+
+void DateIndex::remove(qint32 day, ArtifactHandle handle) {
+    Entry entry{day, handle};
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), entry, entryLess);
+    if (it != m_entries.end() && it->day == day && it->handle == handle) {
+        m_entries.erase(it);
+    }
+}
+
+void DateIndex::clear() {
+    m_entries.clear();
+}
+
+size_t DateIndex::size() const {
+    return m_entries.size();
+}
+
+std::pair<const DateIndex::Entry*, const DateIndex::Entry*> DateIndex::range(qint32 low, qint32 high) const {
+    const Entry* begin = m_entries.data();
+    const Entry* end = begin + m_entries.size();
+    if (low > high) {
+        return {end, end};
+    }
+    const Entry* first = std::lower_bound(begin, end, low, [](const Entry& e, qint32 day) { return e.day < day; });
+    const Entry* last = std::upper_bound(first, end, high, [](qint32 day, const Entry& e) { return day < e.day; });
+    return {first, last};
+}
+
+size_t DateIndex::countInRange(qint32 low, qint32 high) const {
+    auto slice = range(low, high);
+    return static_cast<size_t>(slice.second - slice.first);
+}
@@ -0,0 +1,33 @@
+#ifndef DATE_INDEX_H
+#define DATE_INDEX_H
+
+#include "../domain/artifact.h"
+#include <vector>
+#include <utility>
+
+// Ordered index on the discovery date: a sorted array of (Julian day, handle) pairs.
+// A range query is two binary searches and yields a contiguous slice of entries.
+class DateIndex {
+public:
+    struct Entry {
+        qint32 day;
+        ArtifactHandle handle;
+    };
+
+    void assign(std::vector<Entry> entries); // Bulk build, sorts once
+    void insert(qint32 day, ArtifactHandle handle);
+    void remove(qint32 day, ArtifactHandle handle);
+    void clear();
+
+    size_t size() const;
+    // Entries with low <= day <= high, ascending by day
+    std::pair<const Entry*, const Entry*> range(qint32 low, qint32 high) const;
+    size_t countInRange(qint32 low, qint32 high) const;
+    // Day of the entry at the given rank (0 <= position < size()); quantiles of the distribution
+    qint32 dayAt(size_t position) const { return m_entries[position].day; }
+
+private:
+    std::vector<Entry> m_entries; // Sorted by (day, handle)
+};
+
+#endif // DATE_INDEX_H
@@ -0,0 +1,374 @@
+#include "full_text_index.h"
+#include "artifact_table.h"
+#include "../domain/artifact_schema.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <queue>
+
+namespace {
+
+// Whether words holds phrase at some position
+bool containsSequence(const QStringList& words, const QStringList& phrase) {
+    for (qsizetype start = 0; start + phrase.size() <= words.size(); ++start) {
+        qsizetype i = 0;
+        while (i < phrase.size() && words[start + i] == phrase[i]) {
+            ++i;
+        }
+        if (i == phrase.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+FullTextQuery FullTextQuery::parse(const QString& text) {
+    FullTextQuery query;
+    // Even sections lie outside quotes, odd ones inside; an unclosed quote runs to the end
+    const QStringList sections = text.split(QChar('"'));
+    for (qsizetype i = 0; i < sections.size(); ++i) {
+        QStringList words = FullTextIndex::tokenize(sections[i]);
+        if (i % 2 == 1) {
+            if (!words.isEmpty()) {
+                query.phrases.push_back(words);
+            }
+            continue;
+        }
+        for (const QString& word : words) {
+            query.phrases.push_back(QStringList{word});
+        }
+    }
+    return query;
+}
+
+QStringList FullTextQuery::terms() const {
+    QStringList result;
+    for (const QStringList& phrase : phrases) {
+        for (const QString& word : phrase) {
+            if (!result.contains(word)) {
+                result << word;
+            }
+        }
+    }
+    return result;
+}
+
+bool FullTextQuery::matches(const QString& text) const {
+    if (isEmpty()) {
+        return false;
+    }
+    const QStringList words = FullTextIndex::tokenize(text);
+    return std::all_of(phrases.begin(), phrases.end(),
+                       [&words](const QStringList& phrase) { return containsSequence(words, phrase); });
+}
+
+QStringList FullTextIndex::tokenize(const QString& text) {
+    QStringList words;
+    qsizetype start = -1;
+    for (qsizetype i = 0; i <= text.size(); ++i) {
+        bool inWord = i < text.size() && text[i].isLetterOrNumber();
+        if (inWord && start < 0) {
+            start = i;
+        } else if (!inWord && start >= 0) {
+            words << ArtifactTable::foldCase(text.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return words;
+}
+
+void FullTextIndex::insert(ArtifactHandle handle, const QString& text) {
+    const QStringList words = tokenize(text);
+    QHash<QString, std::vector<quint32>> positions;
+    for (qsizetype i = 0; i < words.size(); ++i) {
+        positions[words[i]].push_back(static_cast<quint32>(i));
+    }
+    for (auto it = positions.begin(); it != positions.end(); ++it) {
+        std::vector<Posting>& list = m_postings[it.key()];
+        Posting posting{handle, std::move(it.value())};
+        // Handles are issued in ascending order, so this is almost always an append
+        if (list.empty() || list.back().handle < handle) {
+            list.push_back(std::move(posting));
+        } else {
+            auto at = std::lower_bound(list.begin(), list.end(), handle,
+                                       [](const Posting& entry, ArtifactHandle value) { return entry.handle < value; });
+            list.insert(at, std::move(posting));
+        }
+    }
+    ++m_documents;
+    setLength(handle, static_cast<quint32>(words.size()));
+}
+
+void FullTextIndex::remove(ArtifactHandle handle, const QString& text) {
+    for (const QString& word : tokenize(text)) {
+        auto entry = m_postings.find(word);
+        if (entry == m_postings.end()) {
+            continue; // A repeated word whose last posting is already gone
+        }
+        std::vector<Posting>& list = entry.value();
+        auto at = std::lower_bound(list.begin(), list.end(), handle,
+                                   [](const Posting& posting, ArtifactHandle value) { return posting.handle < value; });
+        if (at != list.end() && at->handle == handle) {
+            list.erase(at);
+        }
+        if (list.empty()) {
+            m_postings.erase(entry);
+        }
+    }
+    if (m_documents > 0) {
+        --m_documents;
+    }
+    setLength(handle, 0);
+}
+
+void FullTextIndex::clear() {
+    m_postings.clear();
+    m_lengths.clear();
+    m_documents = 0;
+    m_totalLength = 0;
+}
+
+const std::vector<FullTextIndex::Posting>* FullTextIndex::postings(const QString& term) const {
+    auto entry = m_postings.constFind(term);
+    return entry == m_postings.constEnd() ? nullptr : &entry.value();
+}
+
+std::vector<ArtifactHandle> FullTextIndex::matching(const FullTextQuery& query) const {
+    std::vector<const std::vector<Posting>*> lists;
+    for (const QString& term : query.terms()) {
+        const std::vector<Posting>* list = postings(term);
+        if (!list) {
+            return {}; // A word nobody has
+        }
+        lists.push_back(list);
+    }
+    if (lists.empty()) {
+        return {};
+    }
+
+    // Intersect starting from the rarest word so the working set only shrinks
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+    std::vector<ArtifactHandle> result;
+    result.reserve(lists.front()->size());
+    for (const Posting& posting : *lists.front()) {
+        result.push_back(posting.handle);
+    }
+    std::vector<ArtifactHandle> next;
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        next.clear();
+        auto posting = lists[i]->begin();
+        for (ArtifactHandle handle : result) {
+            while (posting != lists[i]->end() && posting->handle < handle) {
+                ++posting;
+            }
+            if (posting != lists[i]->end() && posting->handle == handle) {
+                next.push_back(handle);
+            }
+        }
+        result.swap(next);
+    }
+
+    // Every word is present; phrases also need their words at consecutive positions
+    for (const QStringList& phrase : query.phrases) {
+        if (phrase.size() > 1) {
+            result.erase(std::remove_if(result.begin(), result.end(),
+                                        [&](ArtifactHandle handle) { return !holdsPhrase(phrase, handle); }),
+                         result.end());
+        }
+    }
+    return result;
+}
+
+std::vector<FullTextIndex::Hit> FullTextIndex::search(const FullTextQuery& query, size_t limit) const {
+    if (limit == 0) {
+        return {};
+    }
+    const QStringList terms = query.terms();
+    const double documents = static_cast<double>(m_documents);
+    const double averageLength = m_documents > 0 ? static_cast<double>(m_totalLength) / documents : 0.0;
+    std::vector<double> idf;
+    for (const QString& term : terms) {
+        const std::vector<Posting>* list = postings(term);
+        double frequency = list ? static_cast<double>(list->size()) : 0.0;
+        idf.push_back(std::log(1.0 + (documents - frequency + 0.5) / (frequency + 0.5)));
+    }
+
+    // The heap keeps the limit best hits seen so far with the worst on top
+    auto better = [](const Hit& a, const Hit& b) {
+        return a.score > b.score || (a.score == b.score && a.handle < b.handle);
+    };
+    std::priority_queue<Hit, std::vector<Hit>, decltype(better)> best(better);
+    for (ArtifactHandle handle : matching(query)) {
+        const double length = lengthOf(handle);
+        const double norm = K1 * (1.0 - B + (averageLength > 0 ? B * length / averageLength : 0.0));
+        double score = 0.0;
+        for (qsizetype i = 0; i < terms.size(); ++i) {
+            const double frequency = static_cast<double>(find(terms[i], handle)->positions.size());
+            score += idf[static_cast<size_t>(i)] * frequency * (K1 + 1.0) / (frequency + norm);
+        }
+        Hit hit{handle, score};
+        if (best.size() < limit) {
+            best.push(hit);
+        } else if (better(hit, best.top())) {
+            best.pop();
+            best.push(hit);
+        }
+    }
+    std::vector<Hit> hits(best.size());
+    for (auto it = hits.rbegin(); it != hits.rend(); ++it) {
+        *it = best.top();
+        best.pop();
+    }
+    return hits;
+}
+
+bool FullTextIndex::save(const QString& path, const std::vector<ArcheologicalArtifact>& rows,
+                         ArtifactField field) const {
+    std::vector<quint32> rowOfHandle;
+    for (size_t row = 0; row < rows.size(); ++row) {
+        ArtifactHandle handle = rows[row].getHandle();
+        if (handle >= rowOfHandle.size()) {
+            rowOfHandle.resize(handle + 1, 0);
+        }
+        rowOfHandle[handle] = static_cast<quint32>(row);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << FileMagic << FileVersion << fingerprint(rows, field) << static_cast<quint32>(rows.size())
+           << static_cast<quint32>(m_postings.size());
+    for (auto it = m_postings.constBegin(); it != m_postings.constEnd(); ++it) {
+        stream << it.key() << static_cast<quint32>(it.value().size());
+        for (const Posting& posting : it.value()) {
+            stream << (posting.handle < rowOfHandle.size() ? rowOfHandle[posting.handle] : 0u)
+                   << static_cast<quint32>(posting.positions.size());
+            for (quint32 position : posting.positions) {
+                stream << position;
+            }
+        }
+    }
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool FullTextIndex::load(const QString& path, const std::vector<ArcheologicalArtifact>& rows, ArtifactField field) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint64 savedFingerprint = 0;
+    quint32 rowCount = 0;
+    quint32 termCount = 0;
+    stream >> magic >> version >> savedFingerprint >> rowCount >> termCount;
+    if (stream.status() != QDataStream::Ok || magic != FileMagic || version != FileVersion ||
+        rowCount != rows.size() || savedFingerprint != fingerprint(rows, field)) {
+        return false;
+    }
+
+    // Read into a fresh index so that a damaged file leaves this one untouched
+    FullTextIndex loaded;
+    loaded.m_documents = rows.size();
+    for (quint32 term = 0; term < termCount; ++term) {
+        QString word;
+        quint32 postingCount = 0;
+        stream >> word >> postingCount;
+        if (stream.status() != QDataStream::Ok || postingCount > rowCount) {
+            return false;
+        }
+        std::vector<Posting>& list = loaded.m_postings[word];
+        list.reserve(postingCount);
+        for (quint32 i = 0; i < postingCount; ++i) {
+            quint32 row = 0;
+            quint32 positionCount = 0;
+            stream >> row >> positionCount;
+            if (stream.status() != QDataStream::Ok || row >= rowCount || positionCount > (1u << 24)) {
+                return false;
+            }
+            Posting posting{rows[row].getHandle(), std::vector<quint32>(positionCount)};
+            for (quint32& position : posting.positions) {
+                stream >> position;
+            }
+            loaded.setLength(posting.handle, loaded.lengthOf(posting.handle) + positionCount);
+            list.push_back(std::move(posting));
+        }
+        // Rows need not be in handle order
+        std::sort(list.begin(), list.end(), [](const Posting& a, const Posting& b) { return a.handle < b.handle; });
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    *this = std::move(loaded);
+    return true;
+}
+
+quint64 FullTextIndex::fingerprint(const std::vector<ArcheologicalArtifact>& rows, ArtifactField field) {
+    // FNV-1a over the UTF-16 units; unlike qHash() it is the same in every process and build
+    const ArtifactSchema::TextGetter getter = ArtifactSchema::textGetter(field);
+    quint64 hash = 14695981039346656037ull;
+    auto mix = [&hash](const QString& text) {
+        for (QChar c : text) {
+            hash = (hash ^ c.unicode()) * 1099511628211ull;
+        }
+        hash = (hash ^ 0x10000u) * 1099511628211ull; // Separator outside the UTF-16 range
+    };
+    for (const auto& artifact : rows) {
+        mix(artifact.getId());
+        mix(getter ? (artifact.*getter)() : QString());
+    }
+    return hash;
+}
+
+const FullTextIndex::Posting* FullTextIndex::find(const QString& term, ArtifactHandle handle) const {
+    const std::vector<Posting>* list = postings(term);
+    if (!list) {
+        return nullptr;
+    }
+    auto at = std::lower_bound(list->begin(), list->end(), handle,
+                               [](const Posting& posting, ArtifactHandle value) { return posting.handle < value; });
+    return at != list->end() && at->handle == handle ? &*at : nullptr;
+}
+
+bool FullTextIndex::holdsPhrase(const QStringList& phrase, ArtifactHandle handle) const {
+    std::vector<const std::vector<quint32>*> positions;
+    for (const QString& word : phrase) {
+        const Posting* posting = find(word, handle);
+        if (!posting) {
+            return false;
+        }
+        positions.push_back(&posting->positions);
+    }
+    for (quint32 start : *positions.front()) {
+        bool all = true;
+        for (size_t i = 1; i < positions.size() && all; ++i) {
+            all = std::binary_search(positions[i]->begin(), positions[i]->end(), start + static_cast<quint32>(i));
+        }
+        if (all) {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint32 FullTextIndex::lengthOf(ArtifactHandle handle) const {
+    return handle < m_lengths.size() ? m_lengths[handle] : 0;
+}
+
+void FullTextIndex::setLength(ArtifactHandle handle, quint32 length) {
+    if (handle >= m_lengths.size()) {
+        m_lengths.resize(handle + 1, 0);
+    }
+    m_totalLength = m_totalLength - m_lengths[handle] + length;
+    m_lengths[handle] = length;
+}
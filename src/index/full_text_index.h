@@ -0,0 +1,75 @@
+#ifndef FULL_TEXT_INDEX_H
+#define FULL_TEXT_INDEX_H
+
+#include "../domain/artifact.h"
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// Search text split into words, with quoted phrases whose words must follow each other in order
+struct FullTextQuery {
+    std::vector<QStringList> phrases; // A single word is a phrase of one
+
+    static FullTextQuery parse(const QString& text);
+    bool isEmpty() const { return phrases.empty(); }
+    QStringList terms() const; // Distinct words of all phrases
+    // Whether text holds every phrase; without an index. A query without words matches nothing.
+    bool matches(const QString& text) const;
+};
+
+// Inverted index from the words of one text field to the handles holding them, with the word
+// positions of each occurrence. Words are maximal runs of letters and digits, case-folded.
+// Matches rank by Okapi BM25 over the indexed documents.
+class FullTextIndex {
+public:
+    struct Posting {
+        ArtifactHandle handle;
+        std::vector<quint32> positions; // Ascending word positions; their count is the term frequency
+    };
+    struct Hit {
+        ArtifactHandle handle;
+        double score;
+    };
+    static constexpr double K1 = 1.2; // Term frequency saturation
+    static constexpr double B = 0.75; // Document length normalization
+
+    static QStringList tokenize(const QString& text);
+
+    void insert(ArtifactHandle handle, const QString& text);
+    void remove(ArtifactHandle handle, const QString& text); // text must be the one inserted
+    void clear();
+
+    size_t documentCount() const { return m_documents; }
+    size_t termCount() const { return static_cast<size_t>(m_postings.size()); }
+    const std::vector<Posting>* postings(const QString& term) const; // Ascending handles; nullptr if absent
+
+    // Handles whose text holds every phrase of the query, ascending
+    std::vector<ArtifactHandle> matching(const FullTextQuery& query) const;
+    // The limit best matches by BM25, best first (equal scores by handle), selected with a bounded heap
+    std::vector<Hit> search(const FullTextQuery& query, size_t limit) const;
+
+    // Persistence beside the repository file. rows are the indexed artifacts in repository order
+    // and field the one indexed: the file stores row numbers, since handles only live as long as
+    // the repository object, and a fingerprint of the IDs and texts, so that load() refuses an
+    // index of other data.
+    bool save(const QString& path, const std::vector<ArcheologicalArtifact>& rows, ArtifactField field) const;
+    bool load(const QString& path, const std::vector<ArcheologicalArtifact>& rows, ArtifactField field);
+
+private:
+    static constexpr quint32 FileMagic = 0x41465453; // "AFTS"
+    static constexpr quint32 FileVersion = 1;
+
+    static quint64 fingerprint(const std::vector<ArcheologicalArtifact>& rows, ArtifactField field);
+    const Posting* find(const QString& term, ArtifactHandle handle) const;
+    bool holdsPhrase(const QStringList& phrase, ArtifactHandle handle) const;
+    quint32 lengthOf(ArtifactHandle handle) const;
+    void setLength(ArtifactHandle handle, quint32 length);
+
+    QHash<QString, std::vector<Posting>> m_postings;
+    std::vector<quint32> m_lengths; // Words per document, indexed by handle
+    size_t m_documents = 0;
+    quint64 m_totalLength = 0;
+};
+
+#endif // FULL_TEXT_INDEX_H
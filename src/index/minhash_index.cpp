@@ -0,0 +1,227 @@
+#include "minhash_index.h"
+#include "full_text_index.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+inline quint64 mix(quint64 x) {
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+quint64 hashWord(const QString& word) {
+    // FNV-1a over the UTF-16 units, so signatures do not depend on qHash's per-process seed
+    quint64 hash = 0xcbf29ce484222325ULL;
+    for (QChar unit : word) {
+        hash = (hash ^ unit.unicode()) * 0x100000001b3ULL;
+    }
+    return mix(hash);
+}
+
+// The multipliers and offsets of the hash functions, fixed so that signatures are reproducible
+struct Permutations {
+    std::array<quint64, MinHashIndex::SignatureSize> a;
+    std::array<quint64, MinHashIndex::SignatureSize> b;
+
+    Permutations() {
+        quint64 state = 0x6d696e68617368ULL; // "minhash"
+        for (size_t i = 0; i < MinHashIndex::SignatureSize; ++i) {
+            a[i] = mix(state += 0x9e3779b97f4a7c15ULL) | 1;
+            b[i] = mix(state += 0x9e3779b97f4a7c15ULL);
+        }
+    }
+};
+
+const Permutations& permutations() {
+    static const Permutations instance;
+    return instance;
+}
+
+} // namespace
+
+std::vector<quint64> MinHashIndex::shingles(const QString& text) {
+    const QStringList words = FullTextIndex::tokenize(text);
+    std::vector<quint64> hashes;
+    hashes.reserve(static_cast<size_t>(words.size()) * 2);
+    quint64 previous = 0;
+    for (const QString& word : words) {
+        const quint64 hash = hashWord(word);
+        if (!hashes.empty()) {
+            hashes.push_back(mix(previous * 31 + hash)); // The pair keeps some of the word order
+        }
+        hashes.push_back(hash);
+        previous = hash;
+    }
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    return hashes;
+}
+
+MinHashIndex::Signature MinHashIndex::signature(const std::vector<quint64>& shingles) {
+    // Multiply-shift hashing of the already mixed shingles stands in for random permutations
+    const Permutations& p = permutations();
+    Signature result;
+    result.fill(std::numeric_limits<quint32>::max());
+    for (quint64 shingle : shingles) {
+        for (size_t i = 0; i < SignatureSize; ++i) {
+            result[i] = std::min(result[i], static_cast<quint32>((p.a[i] * shingle + p.b[i]) >> 32));
+        }
+    }
+    return result;
+}
+
+double MinHashIndex::jaccard(const std::vector<quint64>& a, const std::vector<quint64>& b) {
+    if (a.empty() && b.empty()) {
+        return 0.0;
+    }
+    size_t common = 0;
+    auto left = a.begin();
+    auto right = b.begin();
+    while (left != a.end() && right != b.end()) {
+        if (*left < *right) {
+            ++left;
+        } else if (*right < *left) {
+            ++right;
+        } else {
+            ++common;
+            ++left;
+            ++right;
+        }
+    }
+    return static_cast<double>(common) / static_cast<double>(a.size() + b.size() - common);
+}
+
+void MinHashIndex::insert(ArtifactHandle handle, const QString& text) {
+    remove(handle);
+    const std::vector<quint64> set = shingles(text);
+    if (set.empty()) {
+        return;
+    }
+    if (handle >= m_signatures.size()) {
+        m_signatures.resize(static_cast<size_t>(handle) + 1);
+        m_bandKeys.resize(static_cast<size_t>(handle) + 1);
+        m_indexed.resize(static_cast<size_t>(handle) + 1, false);
+    }
+    m_signatures[handle] = signature(set);
+    m_bandKeys[handle] = bandKeys(m_signatures[handle]);
+    m_indexed[handle] = true;
+    ++m_size;
+    for (size_t band = 0; band < Bands; ++band) {
+        const quint64 key = m_bandKeys[handle][band];
+        auto shared = m_shared[band].find(key);
+        if (shared != m_shared[band].end()) {
+            shared.value().push_back(handle);
+            continue;
+        }
+        auto single = m_singles[band].find(key);
+        if (single != m_singles[band].end()) {
+            m_shared[band].insert(key, {single.value(), handle});
+            m_singles[band].erase(single);
+        } else {
+            m_singles[band].insert(key, handle);
+        }
+    }
+}
+
+void MinHashIndex::remove(ArtifactHandle handle) {
+    if (!signatureOf(handle)) {
+        return;
+    }
+    for (size_t band = 0; band < Bands; ++band) {
+        const quint64 key = m_bandKeys[handle][band];
+        auto shared = m_shared[band].find(key);
+        if (shared == m_shared[band].end()) {
+            m_singles[band].remove(key);
+            continue;
+        }
+        std::vector<ArtifactHandle>& handles = shared.value();
+        handles.erase(std::remove(handles.begin(), handles.end(), handle), handles.end());
+        if (handles.size() == 1) {
+            m_singles[band].insert(key, handles.front());
+            m_shared[band].erase(shared);
+        }
+    }
+    m_indexed[handle] = false;
+    --m_size;
+}
+
+void MinHashIndex::clear() {
+    for (size_t band = 0; band < Bands; ++band) {
+        m_singles[band].clear();
+        m_shared[band].clear();
+    }
+    m_signatures.clear();
+    m_bandKeys.clear();
+    m_indexed.clear();
+    m_size = 0;
+}
+
+void MinHashIndex::reserve(size_t documents) {
+    for (auto& singles : m_singles) {
+        singles.reserve(static_cast<qsizetype>(documents));
+    }
+}
+
+const MinHashIndex::Signature* MinHashIndex::signatureOf(ArtifactHandle handle) const {
+    if (handle >= m_indexed.size() || !m_indexed[handle]) {
+        return nullptr;
+    }
+    return &m_signatures[handle];
+}
+
+std::vector<MinHashIndex::Candidate> MinHashIndex::candidates(double minEstimate, size_t* pairCount) const {
+    // An estimate below minEstimate means more than this many differing values
+    const size_t maxDiffering = minEstimate > 0.0 ? static_cast<size_t>((1.0 - minEstimate) * SignatureSize) : SignatureSize;
+    std::vector<Candidate> result;
+    size_t pairs = 0;
+    for (size_t band = 0; band < Bands; ++band) {
+        for (auto bucket = m_shared[band].begin(); bucket != m_shared[band].end(); ++bucket) {
+            const std::vector<ArtifactHandle>& handles = bucket.value();
+            for (size_t i = 0; i < handles.size(); ++i) {
+                const BandKeys& left = m_bandKeys[handles[i]];
+                for (size_t j = i + 1; j < handles.size(); ++j) {
+                    const BandKeys& right = m_bandKeys[handles[j]];
+                    bool seen = false;
+                    for (size_t earlier = 0; earlier < band && !seen; ++earlier) {
+                        seen = left[earlier] == right[earlier];
+                    }
+                    if (seen) {
+                        continue;
+                    }
+                    ++pairs;
+                    const Signature& a = m_signatures[handles[i]];
+                    const Signature& b = m_signatures[handles[j]];
+                    size_t differing = 0;
+                    for (size_t k = 0; k < SignatureSize && differing <= maxDiffering; ++k) {
+                        differing += a[k] != b[k];
+                    }
+                    if (differing <= maxDiffering) {
+                        result.push_back({std::min(handles[i], handles[j]), std::max(handles[i], handles[j]),
+                                          static_cast<double>(SignatureSize - differing) / SignatureSize});
+                    }
+                }
+            }
+        }
+    }
+    if (pairCount) {
+        *pairCount = pairs;
+    }
+    return result;
+}
+
+MinHashIndex::BandKeys MinHashIndex::bandKeys(const Signature& signature) {
+    BandKeys keys;
+    for (size_t band = 0; band < Bands; ++band) {
+        quint64 key = band;
+        for (size_t i = band * RowsPerBand; i < (band + 1) * RowsPerBand; ++i) {
+            key = mix(key * 0x100000001b3ULL + signature[i]);
+        }
+        keys[band] = key;
+    }
+    return keys;
+}
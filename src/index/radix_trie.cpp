@@ -0,0 +1,223 @@
+#include "radix_trie.h"
+#include "artifact_table.h"
+#include <algorithm>
+#include <queue>
+
+namespace {
+
+qsizetype commonPrefix(const QString& a, qsizetype offset, const QString& b) {
+    qsizetype length = 0;
+    while (offset + length < a.size() && length < b.size() && a[offset + length] == b[length]) {
+        ++length;
+    }
+    return length;
+}
+
+} // namespace
+
+size_t RadixTrie::childIndex(const Node& node, QChar first) {
+    auto it = std::lower_bound(node.children.begin(), node.children.end(), first,
+                               [](const std::unique_ptr<Node>& child, QChar value) { return child->label[0] < value; });
+    return static_cast<size_t>(it - node.children.begin());
+}
+
+void RadixTrie::updateBest(Node& node) {
+    node.best = node.count;
+    for (const auto& child : node.children) {
+        node.best = std::max(node.best, child->best);
+    }
+}
+
+void RadixTrie::insert(const QString& value, size_t count) {
+    if (value.isEmpty() || count == 0) {
+        return; // Nothing to complete to
+    }
+    const QString key = ArtifactTable::foldCase(value);
+    std::vector<Node*> path{&m_root};
+    qsizetype position = 0;
+    while (position < key.size()) {
+        Node& node = *path.back();
+        size_t index = childIndex(node, key[position]);
+        if (index == node.children.size() || node.children[index]->label[0] != key[position]) {
+            auto leaf = std::make_unique<Node>();
+            leaf->label = key.mid(position);
+            node.children.insert(node.children.begin() + static_cast<std::ptrdiff_t>(index), std::move(leaf));
+            path.push_back(node.children[index].get());
+            break;
+        }
+        Node* child = node.children[index].get();
+        qsizetype shared = commonPrefix(key, position, child->label);
+        if (shared < child->label.size()) {
+            // Split the edge where the key leaves it
+            auto split = std::make_unique<Node>();
+            split->label = child->label.left(shared);
+            child->label = child->label.mid(shared);
+            split->children.push_back(std::move(node.children[index]));
+            updateBest(*split);
+            node.children[index] = std::move(split);
+            child = node.children[index].get();
+        }
+        path.push_back(child);
+        position += shared;
+    }
+
+    Node& leaf = *path.back();
+    if (leaf.count == 0) {
+        ++m_size;
+    }
+    leaf.count += count;
+    auto spelling = std::find_if(leaf.spellings.begin(), leaf.spellings.end(),
+                                 [&value](const auto& entry) { return entry.first == value; });
+    if (spelling == leaf.spellings.end()) {
+        leaf.spellings.emplace_back(value, count);
+    } else {
+        spelling->second += count;
+    }
+    for (Node* node : path) {
+        node->best = std::max(node->best, leaf.count);
+    }
+}
+
+void RadixTrie::remove(const QString& value, size_t count) {
+    if (value.isEmpty() || count == 0) {
+        return;
+    }
+    const QString key = ArtifactTable::foldCase(value);
+    std::vector<std::pair<Node*, size_t>> path{{&m_root, 0}}; // Node and its position in the parent
+    qsizetype position = 0;
+    while (position < key.size()) {
+        Node& node = *path.back().first;
+        size_t index = childIndex(node, key[position]);
+        if (index == node.children.size()) {
+            return;
+        }
+        Node* child = node.children[index].get();
+        if (commonPrefix(key, position, child->label) != child->label.size()) {
+            return;
+        }
+        path.emplace_back(child, index);
+        position += child->label.size();
+    }
+
+    Node& leaf = *path.back().first;
+    auto spelling = std::find_if(leaf.spellings.begin(), leaf.spellings.end(),
+                                 [&value](const auto& entry) { return entry.first == value; });
+    if (leaf.count == 0 || spelling == leaf.spellings.end()) {
+        return;
+    }
+    count = std::min(count, spelling->second);
+    leaf.count -= count;
+    spelling->second -= count;
+    if (spelling->second == 0) {
+        leaf.spellings.erase(spelling);
+    }
+    if (leaf.count == 0) {
+        --m_size;
+    }
+
+    // Drop nodes left without a key or children and merge inner nodes left with one child
+    for (size_t depth = path.size() - 1; depth > 0; --depth) {
+        Node& node = *path[depth].first;
+        Node& parent = *path[depth - 1].first;
+        if (node.count == 0 && node.children.empty()) {
+            parent.children.erase(parent.children.begin() + static_cast<std::ptrdiff_t>(path[depth].second));
+            continue;
+        }
+        if (node.count == 0 && node.children.size() == 1) {
+            std::unique_ptr<Node> only = std::move(node.children.front());
+            only->label = node.label + only->label;
+            parent.children[path[depth].second] = std::move(only);
+            continue;
+        }
+        updateBest(node);
+    }
+    updateBest(m_root);
+}
+
+void RadixTrie::clear() {
+    m_root = Node();
+    m_size = 0;
+}
+
+size_t RadixTrie::frequency(const QString& value) const {
+    const QString key = ArtifactTable::foldCase(value);
+    const Node* node = &m_root;
+    qsizetype position = 0;
+    while (position < key.size()) {
+        size_t index = childIndex(*node, key[position]);
+        if (index == node->children.size()) {
+            return 0;
+        }
+        const Node* child = node->children[index].get();
+        if (commonPrefix(key, position, child->label) != child->label.size()) {
+            return 0;
+        }
+        node = child;
+        position += child->label.size();
+    }
+    return node->count;
+}
+
+std::vector<std::pair<QString, size_t>> RadixTrie::complete(const QString& prefix, size_t limit) const {
+    std::vector<std::pair<QString, size_t>> result;
+    if (limit == 0) {
+        return result;
+    }
+
+    // Find the subtree holding every key that starts with the prefix
+    const QString key = ArtifactTable::foldCase(prefix);
+    const Node* node = &m_root;
+    QString path;
+    qsizetype position = 0;
+    while (position < key.size()) {
+        size_t index = childIndex(*node, key[position]);
+        if (index == node->children.size()) {
+            return result;
+        }
+        const Node* child = node->children[index].get();
+        qsizetype shared = commonPrefix(key, position, child->label);
+        if (shared < child->label.size() && position + shared < key.size()) {
+            return result; // The key leaves the edge before the prefix ends
+        }
+        node = child;
+        path += child->label;
+        position += child->label.size();
+    }
+
+    // Best first: a subtree is ordered by its best count and its path, which no key below it
+    // beats, so keys come out exactly in (frequency descending, key ascending) order
+    struct Entry {
+        size_t priority;
+        QString path;
+        const Node* node;
+        bool key; // The key ending at node rather than the subtree below it
+    };
+    auto later = [](const Entry& a, const Entry& b) {
+        if (a.priority != b.priority) {
+            return a.priority < b.priority;
+        }
+        if (a.path != b.path) {
+            return a.path > b.path;
+        }
+        return a.key < b.key; // The key before the subtree it heads, which only holds longer keys
+    };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(later)> queue(later);
+    queue.push({node->best, path, node, false});
+    while (!queue.empty() && result.size() < limit) {
+        Entry entry = queue.top();
+        queue.pop();
+        if (entry.key) {
+            auto spelling = std::max_element(entry.node->spellings.begin(), entry.node->spellings.end(),
+                                             [](const auto& a, const auto& b) { return a.second < b.second; });
+            result.emplace_back(spelling->first, entry.node->count);
+            continue;
+        }
+        if (entry.node->count > 0) {
+            queue.push({entry.node->count, entry.path, entry.node, true});
+        }
+        for (const auto& child : entry.node->children) {
+            queue.push({child->best, entry.path + child->label, child.get(), false});
+        }
+    }
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef RADIX_TRIE_H
+#define RADIX_TRIE_H
+
+#include <QString>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Compressed prefix tree over the distinct values of a text field, with how often each occurs.
+// Keys are case-folded, so completion ignores case; each key remembers its spellings and
+// completes to the most frequent one. Every node also keeps the highest frequency below it,
+// which lets complete() visit the subtrees best first and stop after the top limit values
+// instead of collecting every value under the prefix.
+class RadixTrie {
+public:
+    void insert(const QString& value, size_t count = 1); // Empty values are not kept
+    void remove(const QString& value, size_t count = 1); // value must have been inserted that often
+    void clear();
+
+    size_t size() const { return m_size; } // Distinct keys
+    size_t frequency(const QString& value) const; // Of the key, over all its spellings
+
+    // The most frequent values starting with prefix (ignoring case), most frequent first, ties
+    // in key order; an empty prefix completes to the most frequent values overall
+    std::vector<std::pair<QString, size_t>> complete(const QString& prefix, size_t limit) const;
+
+private:
+    struct Node {
+        QString label; // Folded text on the edge from the parent
+        std::vector<std::unique_ptr<Node>> children; // Ordered by the first unit of their labels
+        size_t count = 0; // Occurrences of the key ending here; 0 for inner nodes
+        size_t best = 0;  // Highest count in this subtree
+        std::vector<std::pair<QString, size_t>> spellings; // Original values of the key and their counts
+    };
+
+    static size_t childIndex(const Node& node, QChar first); // Position of the child starting with first, or where it would go
+    static void updateBest(Node& node);
+
+    Node m_root;
+    size_t m_size = 0;
+};
+
+#endif // RADIX_TRIE_H
@@ -0,0 +1,224 @@
+#include "regex_search.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// Index just past the group opening at start, or pattern.size() if it is not closed
+qsizetype skipGroup(const QString& pattern, qsizetype start) {
+    int depth = 0;
+    for (qsizetype i = start; i < pattern.size(); ++i) {
+        const QChar c = pattern[i];
+        if (c == '\\') {
+            ++i;
+        } else if (c == '[') {
+            // A class may hold parentheses; ']' right after the opening (or '^') is literal
+            qsizetype j = i + 1;
+            if (j < pattern.size() && pattern[j] == '^') ++j;
+            if (j < pattern.size() && pattern[j] == ']') ++j;
+            while (j < pattern.size() && pattern[j] != ']') {
+                j += pattern[j] == '\\' ? 2 : 1;
+            }
+            i = j;
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')' && --depth == 0) {
+            return i + 1;
+        }
+    }
+    return pattern.size();
+}
+
+// Length of a counted quantifier {n}, {n,}, {n,m} or {,m} at start (0 if there is none); minimum
+// gets n. PCRE2 reads {,m} as {0,m} since 10.43 and as literal text before.
+qsizetype countedQuantifier(const QString& pattern, qsizetype start, int& minimum) {
+    qsizetype i = start + 1;
+    qsizetype digits = i;
+    minimum = 0;
+    while (i < pattern.size() && pattern[i].isDigit()) {
+        minimum = std::min(minimum * 10 + pattern[i].digitValue(), 1000000);
+        ++i;
+    }
+    if (i == digits && !(i + 1 < pattern.size() && pattern[i] == ',' && pattern[i + 1].isDigit())) {
+        return 0;
+    }
+    if (i < pattern.size() && pattern[i] == ',') {
+        ++i;
+        while (i < pattern.size() && pattern[i].isDigit()) ++i;
+    }
+    return i < pattern.size() && pattern[i] == '}' ? i + 1 - start : 0;
+}
+
+// Last index of the escape whose letter or digit is at start, e.g. the digits of \x41 or \12,
+// the name of \k<name> or the braces of \p{Greek}
+qsizetype escapeEnd(const QString& pattern, qsizetype start) {
+    const QChar letter = pattern[start];
+    qsizetype i = start + 1;
+    auto closing = [&pattern, &i](QChar close) {
+        qsizetype end = pattern.indexOf(close, i + 1);
+        return end < 0 ? pattern.size() - 1 : end;
+    };
+    if (i < pattern.size()) {
+        const QChar next = pattern[i];
+        if (next == '{') return closing('}');
+        if ((letter == 'k' || letter == 'g') && next == '<') return closing('>');
+        if ((letter == 'k' || letter == 'g') && next == '\'') return closing('\'');
+    }
+    qsizetype last = start;
+    if (letter == 'x') {
+        while (last + 1 < pattern.size() && last - start < 2 && isxdigit(pattern[last + 1].unicode())) ++last;
+    } else if (letter == 'c' || letter == 'p' || letter == 'P') {
+        last = std::min(start + 1, pattern.size() - 1);
+    } else if (letter.isDigit() || letter == 'g') {
+        if (letter == 'g' && last + 1 < pattern.size() && (pattern[last + 1] == '-' || pattern[last + 1] == '+')) ++last;
+        while (last + 1 < pattern.size() && pattern[last + 1].isDigit()) ++last;
+    }
+    return last;
+}
+
+} // namespace
+
+QStringList RegexSearch::requiredLiterals(const QString& pattern) {
+    QStringList literals;
+    QString run;
+    auto flush = [&]() {
+        if (!run.isEmpty()) {
+            literals << run;
+            run.clear();
+        }
+    };
+    // The quantifier makes the last character optional: drop it, whole surrogate pairs included
+    auto dropLast = [&run]() {
+        if (run.isEmpty()) return;
+        qsizetype length = run.size() >= 2 && run[run.size() - 1].isLowSurrogate() &&
+                           run[run.size() - 2].isHighSurrogate() ? 2 : 1;
+        run.chop(length);
+    };
+    // Inside braces that may be a quantifier, nothing is required up to the closing brace
+    bool inBraces = false;
+    auto append = [&run, &inBraces](const QString& text) {
+        if (!inBraces) {
+            run += text;
+        }
+    };
+
+    for (qsizetype i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern[i];
+        switch (c.unicode()) {
+        case '|':
+            return QStringList(); // Outside groups: a match may come from an alternative without them
+        case '(':
+            // Inline options such as (?i) or (?x) change how the rest reads
+            if (i + 2 < pattern.size() && pattern[i + 1] == '?' && QString("imsxnJU-^").contains(pattern[i + 2])) {
+                return QStringList();
+            }
+            flush();
+            i = skipGroup(pattern, i) - 1;
+            break;
+        case '[': {
+            flush();
+            qsizetype j = i + 1;
+            if (j < pattern.size() && pattern[j] == '^') ++j;
+            if (j < pattern.size() && pattern[j] == ']') ++j;
+            while (j < pattern.size() && pattern[j] != ']') {
+                j += pattern[j] == '\\' ? 2 : 1;
+            }
+            i = j;
+            break;
+        }
+        case '\\': {
+            if (i + 1 >= pattern.size()) {
+                break;
+            }
+            const QChar next = pattern[++i];
+            if (next == 'Q') {
+                // Quoted up to \E, or to the end
+                qsizetype end = pattern.indexOf("\\E", i + 1);
+                if (end < 0) end = pattern.size();
+                append(pattern.mid(i + 1, end - i - 1));
+                i = end + 1;
+            } else if (next.isLetterOrNumber()) {
+                // Classes, anchors, back references and code points: not plain characters
+                flush();
+                i = escapeEnd(pattern, i);
+            } else {
+                append(next);
+            }
+            break;
+        }
+        case '.':
+        case '^':
+        case '$':
+        case ')':
+            flush();
+            break;
+        case '*':
+        case '?':
+            dropLast();
+            flush();
+            break;
+        case '+':
+            flush();
+            break;
+        case '}':
+            if (inBraces) {
+                inBraces = false;
+            } else {
+                append(c);
+            }
+            break;
+        case '{': {
+            int minimum = 0;
+            qsizetype length = countedQuantifier(pattern, i, minimum);
+            if (length == 0) {
+                // Literal text to some PCRE2 versions and a quantifier to others (e.g. with
+                // spaces), so assume the worse: an optional last character and no literals up
+                // to the closing brace. Metacharacters in between still count.
+                dropLast();
+                flush();
+                inBraces = true;
+                break;
+            }
+            if (minimum == 0) {
+                dropLast();
+            }
+            flush();
+            i += length - 1;
+            break;
+        }
+        default:
+            append(c);
+        }
+    }
+    flush();
+    return literals;
+}
+
+RegexSearch::RegexSearch(const QString& pattern, Qt::CaseSensitivity sensitivity)
+    : m_pattern(pattern),
+      m_sensitivity(sensitivity),
+      m_regex(pattern, sensitivity == Qt::CaseInsensitive ? QRegularExpression::CaseInsensitiveOption
+                                                          : QRegularExpression::NoPatternOption),
+      m_literals(requiredLiterals(pattern)) {
+    // Compile and JIT now rather than on the first row, possibly in a worker thread
+    m_regex.optimize();
+    std::stable_sort(m_literals.begin(), m_literals.end(),
+                     [](const QString& a, const QString& b) { return a.size() > b.size(); });
+    m_literals.removeDuplicates();
+    for (const QString& literal : m_literals) {
+        m_literalSearches.emplace_back(literal, m_sensitivity);
+    }
+}
+
+bool RegexSearch::contains(const QString& text) const {
+    for (const SubstringSearch& literal : m_literalSearches) {
+        if (!literal.contains(text)) {
+            return false;
+        }
+    }
+    return matchesRegex(text);
+}
+
+bool RegexSearch::matchesRegex(const QString& text) const {
+    return m_regex.isValid() && m_regex.match(text).hasMatch();
+}
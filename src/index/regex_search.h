@@ -0,0 +1,44 @@
+#ifndef REGEX_SEARCH_H
+#define REGEX_SEARCH_H
+
+#include "substring_search.h"
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// Regular expression compiled (and JIT-optimized) once, together with the literal substrings
+// every match has to contain. contains() tests those with SubstringSearch first and only runs
+// the regex engine on text that holds them all; scans over a table can go further and take
+// the literals through the trigram index (see ArtifactBatch::selectRegex()).
+class RegexSearch {
+public:
+    RegexSearch(const QString& pattern, Qt::CaseSensitivity sensitivity = Qt::CaseSensitive);
+
+    bool isValid() const { return m_regex.isValid(); }
+    QString errorString() const { return m_regex.errorString(); }
+    const QString& pattern() const { return m_pattern; }
+    Qt::CaseSensitivity sensitivity() const { return m_sensitivity; }
+
+    // Whether the regex finds a match anywhere in text; false for an invalid pattern
+    bool contains(const QString& text) const;
+    bool matchesRegex(const QString& text) const; // The regex alone, without the literal test
+
+    // Substrings of every match (with the search's case sensitivity), longest first; empty
+    // when none could be derived
+    const QStringList& literals() const { return m_literals; }
+
+    // The runs of plain characters the pattern requires, left to right. Conservative: groups,
+    // classes, optional characters and patterns with a top-level alternative or inline options
+    // contribute nothing, so a match always contains every literal returned.
+    static QStringList requiredLiterals(const QString& pattern);
+
+private:
+    QString m_pattern;
+    Qt::CaseSensitivity m_sensitivity;
+    QRegularExpression m_regex;
+    QStringList m_literals;
+    std::vector<SubstringSearch> m_literalSearches; // One per literal
+};
+
+#endif // REGEX_SEARCH_H
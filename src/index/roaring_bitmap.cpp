@@ -0,0 +1,263 @@
+#include "roaring_bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr size_t BitmapWords = 65536 / 64;
+
+bool keyLess(quint16 key, quint16 other) { return key < other; }
+
+} // namespace
+
+void RoaringBitmap::toBitmap(Container& container) {
+    if (container.isBitmap()) {
+        return;
+    }
+    container.bits.assign(BitmapWords, 0);
+    for (quint16 low : container.array) {
+        container.bits[low / 64] |= quint64(1) << (low % 64);
+    }
+    container.array.clear();
+    container.array.shrink_to_fit();
+}
+
+void RoaringBitmap::toArrayIfSparse(Container& container) {
+    if (!container.isBitmap() || container.cardinality > ArrayLimit) {
+        return;
+    }
+    std::vector<quint16> array;
+    array.reserve(container.cardinality);
+    for (size_t i = 0; i < BitmapWords; ++i) {
+        quint64 word = container.bits[i];
+        while (word) {
+            array.push_back(static_cast<quint16>(i * 64 + qCountTrailingZeroBits(word)));
+            word &= word - 1;
+        }
+    }
+    container.array.swap(array);
+    container.bits.clear();
+    container.bits.shrink_to_fit();
+}
+
+RoaringBitmap::Container* RoaringBitmap::find(quint16 key) {
+    auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+                               [](const Container& c, quint16 k) { return keyLess(c.key, k); });
+    return it != m_containers.end() && it->key == key ? &*it : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::find(quint16 key) const {
+    return const_cast<RoaringBitmap*>(this)->find(key);
+}
+
+void RoaringBitmap::add(quint32 value) {
+    const quint16 key = static_cast<quint16>(value >> 16);
+    const quint16 low = static_cast<quint16>(value & 0xFFFF);
+    auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+                               [](const Container& c, quint16 k) { return keyLess(c.key, k); });
+    if (it == m_containers.end() || it->key != key) {
+        it = m_containers.insert(it, Container());
+        it->key = key;
+    }
+    Container& container = *it;
+    if (container.isBitmap()) {
+        quint64& word = container.bits[low / 64];
+        const quint64 bit = quint64(1) << (low % 64);
+        if (!(word & bit)) {
+            word |= bit;
+            ++container.cardinality;
+        }
+        return;
+    }
+    auto pos = std::lower_bound(container.array.begin(), container.array.end(), low);
+    if (pos != container.array.end() && *pos == low) {
+        return;
+    }
+    container.array.insert(pos, low);
+    if (++container.cardinality > ArrayLimit) {
+        toBitmap(container);
+    }
+}
+
+void RoaringBitmap::remove(quint32 value) {
+    const quint16 key = static_cast<quint16>(value >> 16);
+    const quint16 low = static_cast<quint16>(value & 0xFFFF);
+    Container* container = find(key);
+    if (!container) {
+        return;
+    }
+    if (container->isBitmap()) {
+        quint64& word = container->bits[low / 64];
+        const quint64 bit = quint64(1) << (low % 64);
+        if (!(word & bit)) {
+            return;
+        }
+        word &= ~bit;
+        --container->cardinality;
+        toArrayIfSparse(*container);
+    } else {
+        auto pos = std::lower_bound(container->array.begin(), container->array.end(), low);
+        if (pos == container->array.end() || *pos != low) {
+            return;
+        }
+        container->array.erase(pos);
+        --container->cardinality;
+    }
+    if (container->cardinality == 0) {
+        m_containers.erase(m_containers.begin() + (container - m_containers.data()));
+    }
+}
+
+bool RoaringBitmap::contains(quint32 value) const {
+    const Container* container = find(static_cast<quint16>(value >> 16));
+    if (!container) {
+        return false;
+    }
+    const quint16 low = static_cast<quint16>(value & 0xFFFF);
+    if (container->isBitmap()) {
+        return (container->bits[low / 64] >> (low % 64)) & 1u;
+    }
+    return std::binary_search(container->array.begin(), container->array.end(), low);
+}
+
+void RoaringBitmap::clear() {
+    m_containers.clear();
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const Container& container : m_containers) {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+bool RoaringBitmap::isEmpty() const {
+    return m_containers.empty();
+}
+
+size_t RoaringBitmap::memoryUsage() const {
+    size_t bytes = m_containers.capacity() * sizeof(Container);
+    for (const Container& container : m_containers) {
+        bytes += container.array.capacity() * sizeof(quint16) + container.bits.capacity() * sizeof(quint64);
+    }
+    return bytes;
+}
+
+void RoaringBitmap::unite(Container& target, const Container& source) {
+    if (!target.isBitmap() && !source.isBitmap()) {
+        std::vector<quint16> merged;
+        merged.reserve(target.array.size() + source.array.size());
+        std::set_union(target.array.begin(), target.array.end(), source.array.begin(), source.array.end(),
+                       std::back_inserter(merged));
+        target.array.swap(merged);
+        target.cardinality = static_cast<quint32>(target.array.size());
+        if (target.cardinality > ArrayLimit) {
+            toBitmap(target);
+        }
+        return;
+    }
+    toBitmap(target);
+    if (source.isBitmap()) {
+        for (size_t i = 0; i < BitmapWords; ++i) {
+            target.bits[i] |= source.bits[i];
+        }
+    } else {
+        for (quint16 low : source.array) {
+            target.bits[low / 64] |= quint64(1) << (low % 64);
+        }
+    }
+    quint32 count = 0;
+    for (quint64 word : target.bits) {
+        count += qPopulationCount(word);
+    }
+    target.cardinality = count;
+}
+
+void RoaringBitmap::intersect(Container& target, const Container& source) {
+    if (target.isBitmap() && source.isBitmap()) {
+        quint32 count = 0;
+        for (size_t i = 0; i < BitmapWords; ++i) {
+            target.bits[i] &= source.bits[i];
+            count += qPopulationCount(target.bits[i]);
+        }
+        target.cardinality = count;
+        toArrayIfSparse(target);
+        return;
+    }
+    if (target.isBitmap()) {
+        // Result is at most as large as the source array
+        std::vector<quint16> kept;
+        kept.reserve(source.array.size());
+        for (quint16 low : source.array) {
+            if ((target.bits[low / 64] >> (low % 64)) & 1u) {
+                kept.push_back(low);
+            }
+        }
+        target.bits.clear();
+        target.bits.shrink_to_fit();
+        target.array.swap(kept);
+    } else if (source.isBitmap()) {
+        auto end = std::remove_if(target.array.begin(), target.array.end(), [&source](quint16 low) {
+            return !((source.bits[low / 64] >> (low % 64)) & 1u);
+        });
+        target.array.erase(end, target.array.end());
+    } else {
+        std::vector<quint16> common;
+        std::set_intersection(target.array.begin(), target.array.end(), source.array.begin(), source.array.end(),
+                              std::back_inserter(common));
+        target.array.swap(common);
+    }
+    target.cardinality = static_cast<quint32>(target.array.size());
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    std::vector<Container> merged;
+    merged.reserve(m_containers.size() + other.m_containers.size());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < m_containers.size() || j < other.m_containers.size()) {
+        if (j == other.m_containers.size() || (i < m_containers.size() && m_containers[i].key < other.m_containers[j].key)) {
+            merged.push_back(std::move(m_containers[i++]));
+        } else if (i == m_containers.size() || other.m_containers[j].key < m_containers[i].key) {
+            merged.push_back(other.m_containers[j++]);
+        } else {
+            unite(m_containers[i], other.m_containers[j++]);
+            merged.push_back(std::move(m_containers[i++]));
+        }
+    }
+    m_containers.swap(merged);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    std::vector<Container> kept;
+    size_t j = 0;
+    for (Container& container : m_containers) {
+        while (j < other.m_containers.size() && other.m_containers[j].key < container.key) {
+            ++j;
+        }
+        if (j == other.m_containers.size()) {
+            break;
+        }
+        if (other.m_containers[j].key == container.key) {
+            intersect(container, other.m_containers[j]);
+            if (container.cardinality > 0) {
+                kept.push_back(std::move(container));
+            }
+        }
+    }
+    m_containers.swap(kept);
+    return *this;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap& other) const {
+    return cardinality() == other.cardinality() && toVector() == other.toVector();
+}
+
+std::vector<quint32> RoaringBitmap::toVector() const {
+    std::vector<quint32> values;
+    values.reserve(cardinality());
+    forEach([&values](quint32 value) { values.push_back(value); });
+    return values;
+}
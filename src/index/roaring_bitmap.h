@@ -0,0 +1,76 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+#include <vector>
+#include <cstddef>
+
+// Compressed set of 32-bit values (artifact handles) in the style of Roaring bitmaps.
+// Values are split by their high 16 bits into containers; a container holds a sorted
+// array of low halves while sparse and switches to a 65536-bit bitmap once it holds
+// more than ArrayLimit values, so dense and sparse sets both stay small and fast.
+class RoaringBitmap {
+public:
+    static constexpr quint32 ArrayLimit = 4096;
+
+    void add(quint32 value);
+    void remove(quint32 value);
+    bool contains(quint32 value) const;
+    void clear();
+
+    size_t cardinality() const;
+    bool isEmpty() const;
+    size_t memoryUsage() const; // Bytes held by the containers
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    friend RoaringBitmap operator|(RoaringBitmap a, const RoaringBitmap& b) { return a |= b; }
+    friend RoaringBitmap operator&(RoaringBitmap a, const RoaringBitmap& b) { return a &= b; }
+    bool operator==(const RoaringBitmap& other) const;
+
+    // Calls fn(value) for every value in ascending order
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const Container& container : m_containers) {
+            const quint32 high = quint32(container.key) << 16;
+            if (container.isBitmap()) {
+                for (size_t i = 0; i < container.bits.size(); ++i) {
+                    quint64 word = container.bits[i];
+                    while (word) {
+                        fn(high | quint32(i * 64 + qCountTrailingZeroBits(word)));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (quint16 low : container.array) {
+                    fn(high | low);
+                }
+            }
+        }
+    }
+
+    std::vector<quint32> toVector() const;
+
+private:
+    struct Container {
+        quint16 key = 0;
+        quint32 cardinality = 0;
+        std::vector<quint16> array; // Sorted low halves while cardinality <= ArrayLimit
+        std::vector<quint64> bits;  // 1024 words once the container is dense
+
+        bool isBitmap() const { return !bits.empty(); }
+    };
+
+    static void toBitmap(Container& container);
+    static void toArrayIfSparse(Container& container);
+    static void unite(Container& target, const Container& source);
+    static void intersect(Container& target, const Container& source);
+
+    Container* find(quint16 key);
+    const Container* find(quint16 key) const;
+
+    std::vector<Container> m_containers; // Sorted by key, never empty containers
+};
+
+#endif // ROARING_BITMAP_H
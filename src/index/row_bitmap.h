@@ -0,0 +1,103 @@
+#ifndef ROW_BITMAP_H
+#define ROW_BITMAP_H
+
+#include <QtAlgorithms>
+#include <vector>
+#include <cstddef>
+
+// Fixed-size bitmap over row positions, 64 rows per word
+class RowBitmap {
+public:
+    RowBitmap() = default;
+    explicit RowBitmap(size_t size, bool value = false)
+        : m_size(size), m_words((size + 63) / 64, value ? ~quint64(0) : 0) {
+        clearTail();
+    }
+
+    size_t size() const { return m_size; }
+    size_t wordCount() const { return m_words.size(); }
+    quint64* words() { return m_words.data(); }
+    const quint64* words() const { return m_words.data(); }
+
+    bool test(size_t row) const { return (m_words[row / 64] >> (row % 64)) & 1u; }
+    void set(size_t row) { m_words[row / 64] |= quint64(1) << (row % 64); }
+    void reset(size_t row) { m_words[row / 64] &= ~(quint64(1) << (row % 64)); }
+    // Appends one row
+    void push_back(bool value) {
+        if (m_size % 64 == 0) {
+            m_words.push_back(0);
+        }
+        if (value) {
+            set(m_size);
+        }
+        ++m_size;
+    }
+
+    size_t count() const {
+        size_t total = 0;
+        for (quint64 word : m_words) {
+            total += qPopulationCount(word);
+        }
+        return total;
+    }
+
+    bool none() const {
+        for (quint64 word : m_words) {
+            if (word) return false;
+        }
+        return true;
+    }
+
+    // Word-wide combination; both bitmaps must have the same size
+    RowBitmap& operator&=(const RowBitmap& other) {
+        for (size_t i = 0; i < m_words.size(); ++i) m_words[i] &= other.m_words[i];
+        return *this;
+    }
+    RowBitmap& operator|=(const RowBitmap& other) {
+        for (size_t i = 0; i < m_words.size(); ++i) m_words[i] |= other.m_words[i];
+        return *this;
+    }
+    RowBitmap& andNot(const RowBitmap& other) {
+        for (size_t i = 0; i < m_words.size(); ++i) m_words[i] &= ~other.m_words[i];
+        return *this;
+    }
+
+    // Bits [begin, begin + count) as a bitmap of their own
+    RowBitmap slice(size_t begin, size_t count) const {
+        RowBitmap result(count);
+        const size_t first = begin / 64;
+        const unsigned shift = begin % 64;
+        for (size_t i = 0; i < result.m_words.size(); ++i) {
+            quint64 low = m_words[first + i] >> shift;
+            quint64 high = shift && first + i + 1 < m_words.size() ? m_words[first + i + 1] << (64 - shift) : 0;
+            result.m_words[i] = low | high;
+        }
+        result.clearTail();
+        return result;
+    }
+
+    // Calls fn(row) for every set bit in ascending order
+    template <typename Fn>
+    void forEachSetBit(Fn&& fn) const {
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            quint64 word = m_words[i];
+            while (word) {
+                fn(i * 64 + qCountTrailingZeroBits(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Zeroes the unused bits of the last word so count() stays exact
+    void clearTail() {
+        if (m_size % 64 != 0 && !m_words.empty()) {
+            m_words.back() &= (quint64(1) << (m_size % 64)) - 1;
+        }
+    }
+
+private:
+    size_t m_size = 0;
+    std::vector<quint64> m_words;
+};
+
+#endif // ROW_BITMAP_H
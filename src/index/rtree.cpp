@@ -0,0 +1,485 @@
+#include "rtree.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+struct RTree::Rect {
+    double minLatitude;
+    double minLongitude;
+    double maxLatitude;
+    double maxLongitude;
+
+    static Rect of(const GeoPoint& point) {
+        return {point.latitude(), point.longitude(), point.latitude(), point.longitude()};
+    }
+    void extend(const Rect& other) {
+        minLatitude = std::min(minLatitude, other.minLatitude);
+        minLongitude = std::min(minLongitude, other.minLongitude);
+        maxLatitude = std::max(maxLatitude, other.maxLatitude);
+        maxLongitude = std::max(maxLongitude, other.maxLongitude);
+    }
+    Rect united(const Rect& other) const {
+        Rect rect = *this;
+        rect.extend(other);
+        return rect;
+    }
+    double area() const { return (maxLatitude - minLatitude) * (maxLongitude - minLongitude); }
+    double margin() const { return (maxLatitude - minLatitude) + (maxLongitude - minLongitude); }
+    bool intersects(const Rect& other) const {
+        return minLatitude <= other.maxLatitude && other.minLatitude <= maxLatitude &&
+               minLongitude <= other.maxLongitude && other.minLongitude <= maxLongitude;
+    }
+    bool contains(const GeoPoint& point) const {
+        return point.latitude() >= minLatitude && point.latitude() <= maxLatitude &&
+               point.longitude() >= minLongitude && point.longitude() <= maxLongitude;
+    }
+    double centerLatitude() const { return (minLatitude + maxLatitude) / 2.0; }
+    double centerLongitude() const { return (minLongitude + maxLongitude) / 2.0; }
+};
+
+struct RTree::Node {
+    Rect rect{0.0, 0.0, 0.0, 0.0}; // Meaningless while the node is empty
+    bool leaf = true;
+    std::vector<Entry> entries;                  // Leaves only
+    std::vector<std::unique_ptr<Node>> children; // Inner nodes only
+
+    size_t count() const { return leaf ? entries.size() : children.size(); }
+
+    void updateRect() {
+        if (leaf) {
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (i == 0) {
+                    rect = Rect::of(entries[i].point);
+                } else {
+                    rect.extend(Rect::of(entries[i].point));
+                }
+            }
+        } else {
+            for (size_t i = 0; i < children.size(); ++i) {
+                if (i == 0) {
+                    rect = children[i]->rect;
+                } else {
+                    rect.extend(children[i]->rect);
+                }
+            }
+        }
+    }
+};
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+inline double radians(double degrees) { return degrees * (Pi / 180.0); }
+
+// Splits [0, count) into parts runs whose lengths differ by at most one
+template <typename Fn>
+void forEachEvenRun(size_t count, size_t parts, Fn&& fn) {
+    size_t begin = 0;
+    for (size_t part = 0; part < parts; ++part) {
+        size_t end = begin + count / parts + (part < count % parts ? 1 : 0);
+        fn(begin, end);
+        begin = end;
+    }
+}
+
+// Sort-Tile-Recursive grouping: sorted by latitude into vertical slices, each slice sorted by
+// longitude and cut into runs of at most maxEntries. Every run becomes one node of the level.
+template <typename Item, typename Latitude, typename Longitude>
+std::vector<std::vector<Item>> tile(std::vector<Item> items, size_t maxEntries, Latitude latitude, Longitude longitude) {
+    const size_t groups = (items.size() + maxEntries - 1) / maxEntries;
+    const size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(groups))));
+    std::sort(items.begin(), items.end(), [&](const Item& a, const Item& b) { return latitude(a) < latitude(b); });
+
+    std::vector<std::vector<Item>> result;
+    result.reserve(groups);
+    forEachEvenRun(items.size(), slices, [&](size_t sliceBegin, size_t sliceEnd) {
+        std::sort(items.begin() + static_cast<std::ptrdiff_t>(sliceBegin),
+                  items.begin() + static_cast<std::ptrdiff_t>(sliceEnd),
+                  [&](const Item& a, const Item& b) { return longitude(a) < longitude(b); });
+        const size_t length = sliceEnd - sliceBegin;
+        forEachEvenRun(length, (length + maxEntries - 1) / maxEntries, [&](size_t begin, size_t end) {
+            std::vector<Item> group;
+            group.reserve(end - begin);
+            for (size_t i = sliceBegin + begin; i < sliceBegin + end; ++i) {
+                group.push_back(std::move(items[i]));
+            }
+            result.push_back(std::move(group));
+        });
+    });
+    return result;
+}
+
+// Guttman's quadratic split: the two items that would waste the most area seed the groups,
+// then the item with the strongest preference joins its group, while both can still reach
+// minEntries. Items keeps the first group; the second is returned.
+template <typename Item, typename RectOf>
+std::vector<Item> quadraticSplit(std::vector<Item>& items, size_t minEntries, RectOf rectOf) {
+    size_t seedA = 0;
+    size_t seedB = 1;
+    double worstWaste = -1.0;
+    double worstMargin = -1.0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        for (size_t j = i + 1; j < items.size(); ++j) {
+            auto united = rectOf(items[i]).united(rectOf(items[j]));
+            double waste = united.area() - rectOf(items[i]).area() - rectOf(items[j]).area();
+            // Points have no area, so the margin separates collinear seeds
+            if (waste > worstWaste || (waste == worstWaste && united.margin() > worstMargin)) {
+                worstWaste = waste;
+                worstMargin = united.margin();
+                seedA = i;
+                seedB = j;
+            }
+        }
+    }
+
+    std::vector<Item> remaining;
+    remaining.reserve(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i != seedA && i != seedB) {
+            remaining.push_back(std::move(items[i]));
+        }
+    }
+    std::vector<Item> groupA;
+    std::vector<Item> groupB;
+    groupA.push_back(std::move(items[seedA]));
+    groupB.push_back(std::move(items[seedB]));
+    auto rectA = rectOf(groupA.front());
+    auto rectB = rectOf(groupB.front());
+
+    while (!remaining.empty()) {
+        if (groupA.size() + remaining.size() == minEntries || groupB.size() + remaining.size() == minEntries) {
+            std::vector<Item>& group = groupA.size() + remaining.size() == minEntries ? groupA : groupB;
+            for (Item& item : remaining) {
+                group.push_back(std::move(item));
+            }
+            break;
+        }
+        size_t next = 0;
+        double strongest = -1.0;
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            double preference = std::abs((rectA.united(rectOf(remaining[i])).area() - rectA.area()) -
+                                         (rectB.united(rectOf(remaining[i])).area() - rectB.area()));
+            if (preference > strongest) {
+                strongest = preference;
+                next = i;
+            }
+        }
+        auto rect = rectOf(remaining[next]);
+        double growthA = rectA.united(rect).area() - rectA.area();
+        double growthB = rectB.united(rect).area() - rectB.area();
+        bool toA = growthA != growthB ? growthA < growthB
+                 : rectA.area() != rectB.area() ? rectA.area() < rectB.area()
+                 : groupA.size() <= groupB.size();
+        (toA ? groupA : groupB).push_back(std::move(remaining[next]));
+        (toA ? rectA : rectB).extend(rect);
+        remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(next));
+    }
+    items = std::move(groupA);
+    return groupB;
+}
+
+} // namespace
+
+RTree::RTree() : m_root(std::make_unique<Node>()) {}
+RTree::~RTree() = default;
+RTree::RTree(RTree&&) noexcept = default;
+RTree& RTree::operator=(RTree&&) noexcept = default;
+
+void RTree::clear() {
+    m_root = std::make_unique<Node>();
+    m_size = 0;
+}
+
+int RTree::height() const {
+    int levels = 1;
+    for (const Node* node = m_root.get(); !node->leaf; node = node->children.front().get()) {
+        ++levels;
+    }
+    return levels;
+}
+
+void RTree::assign(std::vector<Entry> entries) {
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const Entry& entry) { return !entry.point.isValid(); }),
+                  entries.end());
+    clear();
+    if (entries.empty()) {
+        return;
+    }
+    m_size = entries.size();
+
+    // Pack the leaves, then each level above from the centers of the one below
+    std::vector<std::unique_ptr<Node>> level;
+    for (std::vector<Entry>& group : tile(std::move(entries), MaxEntries,
+                                          [](const Entry& e) { return e.point.latitude(); },
+                                          [](const Entry& e) { return e.point.longitude(); })) {
+        auto leaf = std::make_unique<Node>();
+        leaf->entries = std::move(group);
+        leaf->updateRect();
+        level.push_back(std::move(leaf));
+    }
+    while (level.size() > 1) {
+        std::vector<std::unique_ptr<Node>> parents;
+        for (auto& group : tile(std::move(level), MaxEntries,
+                                [](const std::unique_ptr<Node>& n) { return n->rect.centerLatitude(); },
+                                [](const std::unique_ptr<Node>& n) { return n->rect.centerLongitude(); })) {
+            auto parent = std::make_unique<Node>();
+            parent->leaf = false;
+            parent->children = std::move(group);
+            parent->updateRect();
+            parents.push_back(std::move(parent));
+        }
+        level = std::move(parents);
+    }
+    m_root = std::move(level.front());
+}
+
+void RTree::insert(const GeoPoint& point, ArtifactHandle handle) {
+    if (!point.isValid()) {
+        return;
+    }
+    insertEntry({point, handle});
+    ++m_size;
+}
+
+void RTree::remove(const GeoPoint& point, ArtifactHandle handle) {
+    if (!point.isValid()) {
+        return;
+    }
+    std::vector<Entry> orphans;
+    if (!removeFrom(*m_root, {point, handle}, orphans)) {
+        return;
+    }
+    --m_size;
+    // A root with a single child only adds a level
+    while (!m_root->leaf && m_root->children.size() == 1) {
+        m_root = std::move(m_root->children.front());
+    }
+    if (!m_root->leaf && m_root->children.empty()) {
+        m_root = std::make_unique<Node>();
+    }
+    for (const Entry& entry : orphans) {
+        insertEntry(entry);
+    }
+}
+
+std::vector<ArtifactHandle> RTree::inBox(const GeoBox& box) const {
+    std::vector<ArtifactHandle> handles;
+    if (!box.isValid() || m_size == 0) {
+        return handles;
+    }
+    if (box.crossesAntimeridian()) {
+        searchBox(*m_root, {box.south(), box.west(), box.north(), 180.0}, handles);
+        searchBox(*m_root, {box.south(), -180.0, box.north(), box.east()}, handles);
+    } else {
+        searchBox(*m_root, {box.south(), box.west(), box.north(), box.east()}, handles);
+    }
+    return handles;
+}
+
+std::vector<ArtifactHandle> RTree::withinRadius(const GeoPoint& center, double radiusKm) const {
+    std::vector<ArtifactHandle> handles;
+    if (center.isValid() && radiusKm >= 0.0 && m_size > 0) {
+        searchRadius(*m_root, center, radiusKm, handles);
+    }
+    return handles;
+}
+
+std::vector<RTree::Neighbour> RTree::nearest(const GeoPoint& center, size_t k, double maxDistanceKm) const {
+    std::vector<Neighbour> result;
+    if (!center.isValid() || k == 0 || m_size == 0) {
+        return result;
+    }
+
+    // Best-first: nodes by the lower bound of their distance, entries by their distance. A node
+    // comes out before entries at the same distance, so ties among entries are settled by handle.
+    struct Candidate {
+        double distanceKm;
+        const Node* node; // nullptr for an entry
+        ArtifactHandle handle;
+    };
+    auto later = [](const Candidate& a, const Candidate& b) {
+        if (a.distanceKm != b.distanceKm) return a.distanceKm > b.distanceKm;
+        if ((a.node == nullptr) != (b.node == nullptr)) return a.node == nullptr;
+        return a.handle > b.handle;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(later)> queue(later);
+    queue.push({lowerBoundKm(center, m_root->rect), m_root.get(), 0});
+    while (!queue.empty() && result.size() < k) {
+        Candidate next = queue.top();
+        queue.pop();
+        if (next.distanceKm > maxDistanceKm) {
+            break;
+        }
+        if (!next.node) {
+            result.push_back({next.handle, next.distanceKm});
+        } else if (next.node->leaf) {
+            for (const Entry& entry : next.node->entries) {
+                queue.push({center.distanceKm(entry.point), nullptr, entry.handle});
+            }
+        } else {
+            for (const auto& child : next.node->children) {
+                queue.push({lowerBoundKm(center, child->rect), child.get(), 0});
+            }
+        }
+    }
+    return result;
+}
+
+void RTree::insertEntry(const Entry& entry) {
+    std::unique_ptr<Node> sibling = insertInto(*m_root, entry);
+    if (sibling) {
+        // The root split: grow the tree by one level
+        auto root = std::make_unique<Node>();
+        root->leaf = false;
+        root->children.push_back(std::move(m_root));
+        root->children.push_back(std::move(sibling));
+        root->updateRect();
+        m_root = std::move(root);
+    }
+}
+
+std::unique_ptr<RTree::Node> RTree::insertInto(Node& node, const Entry& entry) {
+    const Rect rect = Rect::of(entry.point);
+    if (node.count() == 0) {
+        node.rect = rect;
+    } else {
+        node.rect.extend(rect);
+    }
+    if (node.leaf) {
+        node.entries.push_back(entry);
+        return node.entries.size() > MaxEntries ? split(node) : nullptr;
+    }
+
+    // Least enlargement, then least area
+    Node* best = nullptr;
+    double bestGrowth = 0.0;
+    for (const auto& child : node.children) {
+        double growth = child->rect.united(rect).area() - child->rect.area();
+        if (!best || growth < bestGrowth || (growth == bestGrowth && child->rect.area() < best->rect.area())) {
+            best = child.get();
+            bestGrowth = growth;
+        }
+    }
+    std::unique_ptr<Node> sibling = insertInto(*best, entry);
+    if (sibling) {
+        node.children.push_back(std::move(sibling));
+        if (node.children.size() > MaxEntries) {
+            return split(node);
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<RTree::Node> RTree::split(Node& node) {
+    auto sibling = std::make_unique<Node>();
+    sibling->leaf = node.leaf;
+    if (node.leaf) {
+        sibling->entries = quadraticSplit(node.entries, MinEntries, [](const Entry& e) { return Rect::of(e.point); });
+    } else {
+        sibling->children = quadraticSplit(node.children, MinEntries,
+                                           [](const std::unique_ptr<Node>& n) { return n->rect; });
+    }
+    node.updateRect();
+    sibling->updateRect();
+    return sibling;
+}
+
+bool RTree::removeFrom(Node& node, const Entry& entry, std::vector<Entry>& orphans) {
+    if (node.leaf) {
+        auto it = std::find_if(node.entries.begin(), node.entries.end(), [&entry](const Entry& e) {
+            return e.handle == entry.handle && e.point == entry.point;
+        });
+        if (it == node.entries.end()) {
+            return false;
+        }
+        node.entries.erase(it);
+        node.updateRect();
+        return true;
+    }
+    for (auto it = node.children.begin(); it != node.children.end(); ++it) {
+        Node& child = **it;
+        if (!child.rect.contains(entry.point) || !removeFrom(child, entry, orphans)) {
+            continue;
+        }
+        // Dissolve an underfull child; its entries go back in from the root
+        if (child.count() < MinEntries) {
+            collect(child, orphans);
+            node.children.erase(it);
+        }
+        node.updateRect();
+        return true;
+    }
+    return false;
+}
+
+void RTree::collect(const Node& node, std::vector<Entry>& entries) {
+    if (node.leaf) {
+        entries.insert(entries.end(), node.entries.begin(), node.entries.end());
+        return;
+    }
+    for (const auto& child : node.children) {
+        collect(*child, entries);
+    }
+}
+
+void RTree::searchBox(const Node& node, const Rect& box, std::vector<ArtifactHandle>& handles) {
+    if (node.count() == 0 || !node.rect.intersects(box)) {
+        return;
+    }
+    if (node.leaf) {
+        for (const Entry& entry : node.entries) {
+            if (box.contains(entry.point)) {
+                handles.push_back(entry.handle);
+            }
+        }
+        return;
+    }
+    for (const auto& child : node.children) {
+        searchBox(*child, box, handles);
+    }
+}
+
+void RTree::searchRadius(const Node& node, const GeoPoint& center, double radiusKm, std::vector<ArtifactHandle>& handles) {
+    if (node.count() == 0 || lowerBoundKm(center, node.rect) > radiusKm) {
+        return;
+    }
+    if (node.leaf) {
+        for (const Entry& entry : node.entries) {
+            if (center.distanceKm(entry.point) <= radiusKm) {
+                handles.push_back(entry.handle);
+            }
+        }
+        return;
+    }
+    for (const auto& child : node.children) {
+        searchRadius(*child, center, radiusKm, handles);
+    }
+}
+
+double RTree::lowerBoundKm(const GeoPoint& center, const Rect& rect) {
+    // Haversine is sin^2(dLat/2) + cos(lat1) cos(lat2) sin^2(dLon/2); each factor is bounded
+    // separately over the rectangle: the nearest latitude, the smallest cosine (at the edge
+    // farthest from the equator) and the nearest longitude, going either way around.
+    const double latitude = center.latitude();
+    const double longitude = center.longitude();
+    double dLatitude = 0.0;
+    if (latitude < rect.minLatitude) {
+        dLatitude = rect.minLatitude - latitude;
+    } else if (latitude > rect.maxLatitude) {
+        dLatitude = latitude - rect.maxLatitude;
+    }
+    double dLongitude = 0.0;
+    if (longitude < rect.minLongitude || longitude > rect.maxLongitude) {
+        dLongitude = std::min(std::fmod(rect.minLongitude - longitude + 360.0, 360.0),
+                              std::fmod(longitude - rect.maxLongitude + 360.0, 360.0));
+    }
+    const double cosine = std::max(0.0, std::min(std::cos(radians(rect.minLatitude)), std::cos(radians(rect.maxLatitude))));
+    const double sinLatitude = std::sin(radians(dLatitude) / 2.0);
+    const double sinLongitude = std::sin(radians(dLongitude) / 2.0);
+    double h = sinLatitude * sinLatitude + std::cos(radians(latitude)) * cosine * sinLongitude * sinLongitude;
+    h = std::min(1.0, h);
+    // Shaved by a rounding margin, so that a point exactly on the radius is never pruned
+    return std::max(0.0, 2.0 * GeoPoint::EarthRadiusKm * std::asin(std::sqrt(h)) * (1.0 - 1e-12) - 1e-9);
+}
@@ -0,0 +1,73 @@
+#ifndef RTREE_H
+#define RTREE_H
+
+#include "../domain/artifact.h"
+#include "../domain/geo_point.h"
+#include <vector>
+#include <memory>
+#include <limits>
+
+// R-tree over the artifact coordinates, with latitude and longitude as plain planar axes.
+// Bulk loads use Sort-Tile-Recursive packing (full, square-ish leaves); single inserts
+// descend by least enlargement and split quadratically, and removals reinsert the entries
+// of underfull nodes. Radius and nearest-neighbour queries prune subtrees with a lower bound
+// on the great-circle distance to their rectangles, so results are exact on the sphere.
+class RTree {
+public:
+    static constexpr size_t MaxEntries = 16;
+    static constexpr size_t MinEntries = 6; // Nodes below this (except the root) are dissolved
+
+    struct Entry {
+        GeoPoint point;
+        ArtifactHandle handle;
+    };
+
+    struct Neighbour {
+        ArtifactHandle handle;
+        double distanceKm;
+    };
+
+    RTree();
+    ~RTree();
+    RTree(RTree&&) noexcept;
+    RTree& operator=(RTree&&) noexcept;
+
+    void assign(std::vector<Entry> entries); // Replaces the contents; null points are skipped
+    void insert(const GeoPoint& point, ArtifactHandle handle); // Null points are not indexed
+    void remove(const GeoPoint& point, ArtifactHandle handle); // point must be the one inserted
+    void clear();
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    int height() const; // 1 for a single leaf
+
+    // Handles in the box, in no particular order
+    std::vector<ArtifactHandle> inBox(const GeoBox& box) const;
+    // Handles within radiusKm of center along the earth's surface, in no particular order
+    std::vector<ArtifactHandle> withinRadius(const GeoPoint& center, double radiusKm) const;
+    // The k handles closest to center, nearest first (ties by handle), none farther than maxDistanceKm
+    std::vector<Neighbour> nearest(const GeoPoint& center, size_t k,
+                                   double maxDistanceKm = std::numeric_limits<double>::infinity()) const;
+
+private:
+    struct Rect;
+    struct Node;
+
+    void insertEntry(const Entry& entry);
+    // Returns the node split off from node, if it overflowed
+    static std::unique_ptr<Node> insertInto(Node& node, const Entry& entry);
+    static std::unique_ptr<Node> split(Node& node);
+    // Entries of the children dissolved on the way are added to orphans
+    static bool removeFrom(Node& node, const Entry& entry, std::vector<Entry>& orphans);
+    static void collect(const Node& node, std::vector<Entry>& entries);
+    static void searchBox(const Node& node, const Rect& box, std::vector<ArtifactHandle>& handles);
+    static void searchRadius(const Node& node, const GeoPoint& center, double radiusKm,
+                             std::vector<ArtifactHandle>& handles);
+    // Never more than the great-circle distance from center to any point of rect
+    static double lowerBoundKm(const GeoPoint& center, const Rect& rect);
+
+    std::unique_ptr<Node> m_root;
+    size_t m_size = 0;
+};
+
+#endif // RTREE_H
@@ -0,0 +1,180 @@
+#include "substring_search.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SUBSTRING_SEARCH_SSE2 1
+#endif
+#if defined(SUBSTRING_SEARCH_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SUBSTRING_SEARCH_AVX2 1 // Built for the target attribute, used only if the CPU has it
+#endif
+
+namespace {
+
+inline ushort foldAscii(ushort c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<ushort>(c + ('a' - 'A')) : c;
+}
+
+// needle[0] and needle[length - 1] are already known to match at text
+inline bool matchesAt(const ushort* text, const ushort* needle, qsizetype length, bool fold) {
+    if (!fold) {
+        return length <= 2 || std::memcmp(text + 1, needle + 1, static_cast<size_t>(length - 2) * sizeof(ushort)) == 0;
+    }
+    for (qsizetype i = 1; i + 1 < length; ++i) {
+        if (foldAscii(text[i]) != needle[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool findScalar(const ushort* text, qsizetype size, const ushort* needle, qsizetype length, bool fold) {
+    for (qsizetype i = 0; i + length <= size; ++i) {
+        ushort head = fold ? foldAscii(text[i]) : text[i];
+        ushort tail = fold ? foldAscii(text[i + length - 1]) : text[i + length - 1];
+        if (head == needle[0] && tail == needle[length - 1] && matchesAt(text + i, needle, length, fold)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef SUBSTRING_SEARCH_SSE2
+inline __m128i foldAscii(__m128i units) {
+    // Signed compares leave units above 0x7FFF out of the A-Z range, as they should be
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi16(units, _mm_set1_epi16('A' - 1)),
+                                  _mm_cmplt_epi16(units, _mm_set1_epi16('Z' + 1)));
+    return _mm_or_si128(units, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+}
+
+bool findSse2(const ushort* text, qsizetype size, const ushort* needle, qsizetype length, bool fold) {
+    const __m128i first = _mm_set1_epi16(static_cast<short>(needle[0]));
+    const __m128i last = _mm_set1_epi16(static_cast<short>(needle[length - 1]));
+    qsizetype i = 0;
+    // Eight start positions per step; movemask gives two bits per 16-bit lane
+    for (; i + length - 1 + 8 <= size; i += 8) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + length - 1));
+        if (fold) {
+            head = foldAscii(head);
+            tail = foldAscii(tail);
+        }
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(head, first), _mm_cmpeq_epi16(tail, last))));
+        while (mask) {
+            int bit = qCountTrailingZeroBits(mask);
+            if (matchesAt(text + i + bit / 2, needle, length, fold)) {
+                return true;
+            }
+            mask &= ~(3u << bit);
+        }
+    }
+    return findScalar(text + i, size - i, needle, length, fold);
+}
+#endif
+
+#ifdef SUBSTRING_SEARCH_AVX2
+__attribute__((target("avx2")))
+bool findAvx2(const ushort* text, qsizetype size, const ushort* needle, qsizetype length, bool fold) {
+    const __m256i first = _mm256_set1_epi16(static_cast<short>(needle[0]));
+    const __m256i last = _mm256_set1_epi16(static_cast<short>(needle[length - 1]));
+    const __m256i lowA = _mm256_set1_epi16('A' - 1);
+    const __m256i highZ = _mm256_set1_epi16('Z' + 1);
+    const __m256i caseBit = _mm256_set1_epi16(0x20);
+    qsizetype i = 0;
+    for (; i + length - 1 + 16 <= size; i += 16) {
+        __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + length - 1));
+        if (fold) {
+            head = _mm256_or_si256(head, _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi16(head, lowA),
+                                                                           _mm256_cmpgt_epi16(highZ, head)), caseBit));
+            tail = _mm256_or_si256(tail, _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi16(tail, lowA),
+                                                                           _mm256_cmpgt_epi16(highZ, tail)), caseBit));
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi16(head, first), _mm256_cmpeq_epi16(tail, last))));
+        while (mask) {
+            int bit = qCountTrailingZeroBits(mask);
+            if (matchesAt(text + i + bit / 2, needle, length, fold)) {
+                return true;
+            }
+            mask &= ~(3u << bit);
+        }
+    }
+    return findSse2(text + i, size - i, needle, length, fold);
+}
+#endif
+
+SubstringSearch::Kernel selectKernel() {
+#ifdef SUBSTRING_SEARCH_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return findAvx2;
+    }
+#endif
+#ifdef SUBSTRING_SEARCH_SSE2
+    return findSse2;
+#else
+    return findScalar;
+#endif
+}
+
+SubstringSearch::Kernel kernel() {
+    static const SubstringSearch::Kernel selected = selectKernel();
+    return selected;
+}
+
+bool isAscii(const QString& text) {
+    const ushort* units = text.utf16();
+    ushort bits = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        bits |= units[i];
+    }
+    return bits < 0x80;
+}
+
+} // namespace
+
+SubstringSearch::SubstringSearch(const QString& needle, Qt::CaseSensitivity sensitivity)
+    : m_needle(needle), m_sensitivity(sensitivity), m_vectorized(true), m_kernel(kernel()) {
+    if (sensitivity == Qt::CaseInsensitive) {
+        m_vectorized = isAscii(needle);
+        if (m_vectorized) {
+            m_needle = needle.toLower();
+        }
+    }
+}
+
+bool SubstringSearch::contains(const QString& text) const {
+    const qsizetype length = m_needle.size();
+    if (length == 0) {
+        return true;
+    }
+    if (!m_vectorized) {
+        return text.contains(m_needle, m_sensitivity);
+    }
+    if (length > text.size()) {
+        return false;
+    }
+    const bool fold = m_sensitivity == Qt::CaseInsensitive;
+    if (m_kernel(text.utf16(), text.size(), m_needle.utf16(), length, fold)) {
+        return true;
+    }
+    // Outside ASCII some units fold onto ASCII letters (KELVIN SIGN to k), which only Qt knows
+    return fold && !isAscii(text) && text.contains(m_needle, Qt::CaseInsensitive);
+}
+
+const char* SubstringSearch::kernelName() {
+#ifdef SUBSTRING_SEARCH_AVX2
+    if (kernel() == findAvx2) {
+        return "avx2";
+    }
+#endif
+#ifdef SUBSTRING_SEARCH_SSE2
+    if (kernel() == findSse2) {
+        return "sse2";
+    }
+#endif
+    return "scalar";
+}
@@ -0,0 +1,27 @@
+#ifndef SUBSTRING_SEARCH_H
+#define SUBSTRING_SEARCH_H
+
+#include <QString>
+
+// Substring test prepared once per needle for the text scans. Candidate positions come from
+// comparing the first and last UTF-16 unit of the needle against a block of text at once
+// (AVX2 or SSE2, picked at run time), and only those are compared in full. Results are the
+// same as QString::contains() with the same case sensitivity.
+class SubstringSearch {
+public:
+    SubstringSearch(const QString& needle, Qt::CaseSensitivity sensitivity = Qt::CaseSensitive);
+
+    bool contains(const QString& text) const;
+
+    static const char* kernelName(); // "avx2", "sse2" or "scalar"
+
+    using Kernel = bool (*)(const ushort* text, qsizetype size, const ushort* needle, qsizetype length, bool fold);
+
+private:
+    QString m_needle;  // A-Z lowered for an ASCII case-insensitive search
+    Qt::CaseSensitivity m_sensitivity;
+    bool m_vectorized; // False for case-insensitive needles outside ASCII, which need Qt's folding
+    Kernel m_kernel;
+};
+
+#endif // SUBSTRING_SEARCH_H
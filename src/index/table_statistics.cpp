@@ -0,0 +1,69 @@
+#include "table_statistics.h"
+#include <algorithm>
+
+TableStatistics::TableStatistics(const ArtifactTable& table) : m_table(table) {}
+
+size_t TableStatistics::rows() const {
+    return m_table.artifactCount();
+}
+
+size_t TableStatistics::distinctValues(ArtifactField field) const {
+    const BitmapIndex* index = m_table.bitmapIndex(field);
+    return index ? index->distinctValues() : 0;
+}
+
+std::vector<std::pair<QString, size_t>> TableStatistics::valueHistogram(ArtifactField field) const {
+    const BitmapIndex* index = m_table.bitmapIndex(field);
+    return index ? index->valueCounts() : std::vector<std::pair<QString, size_t>>();
+}
+
+bool TableStatistics::countValues(ArtifactField field, const QString& needle, TextMatch match,
+                                  Qt::CaseSensitivity sensitivity, size_t& count) const {
+    const BitmapIndex* index = m_table.bitmapIndex(field);
+    if (!index) {
+        return false;
+    }
+    count = match == TextMatch::Equals ? index->countEqualTo(needle, sensitivity)
+                                       : index->countContaining(needle, sensitivity);
+    return true;
+}
+
+bool TableStatistics::trigramBound(ArtifactField field, const QString& needle, size_t& bound,
+                                   size_t& postingWork) const {
+    const TrigramIndex* index = m_table.trigramIndex(field);
+    if (!index || !TrigramIndex::canServe(needle)) {
+        return false;
+    }
+    bound = index->candidateBound(needle, &postingWork);
+    return true;
+}
+
+size_t TableStatistics::countDateRange(const QDate& startDate, const QDate& endDate) const {
+    return m_table.dateIndex().countInRange(ArtifactTable::toJulianDay(startDate),
+                                            ArtifactTable::toJulianDay(endDate));
+}
+
+std::vector<TableStatistics::DateBucket> TableStatistics::dateHistogram(size_t bucketCount) const {
+    const DateIndex& dates = m_table.dateIndex();
+    // Invalid dates sort first and have no place on the calendar
+    size_t first = dates.countInRange(ArtifactTable::InvalidJulianDay, ArtifactTable::InvalidJulianDay);
+    size_t dated = dates.size() - first;
+    std::vector<DateBucket> buckets;
+    if (dated == 0 || bucketCount == 0) {
+        return buckets;
+    }
+
+    // Cut at the quantiles, then move each cut past the run of equal days it falls into
+    // so that a day never straddles two buckets
+    size_t begin = first;
+    for (size_t i = 1; i <= bucketCount && begin < dates.size(); ++i) {
+        size_t end = std::max(begin + 1, first + dated * i / bucketCount);
+        while (end < dates.size() && dates.dayAt(end) == dates.dayAt(end - 1)) {
+            ++end;
+        }
+        buckets.push_back({QDate::fromJulianDay(dates.dayAt(begin)), QDate::fromJulianDay(dates.dayAt(end - 1)),
+                           end - begin});
+        begin = end;
+    }
+    return buckets;
+}
@@ -0,0 +1,48 @@
+#ifndef TABLE_STATISTICS_H
+#define TABLE_STATISTICS_H
+
+#include "artifact_table.h"
+#include "artifact_batch.h"
+#include <QString>
+#include <QDate>
+#include <vector>
+#include <utility>
+
+// Per-field statistics for the query planner. They are read from the indexes the table
+// already maintains incrementally, so they are never stale: exact value histograms for the
+// value-indexed fields, posting list sizes for the trigram-indexed ones and the sorted date
+// index as the date distribution. The view borrows the table, which must outlive it.
+class TableStatistics {
+public:
+    // One bucket of an equi-depth date histogram
+    struct DateBucket {
+        QDate first;
+        QDate last;
+        size_t rows;
+    };
+
+    explicit TableStatistics(const ArtifactTable& table);
+
+    size_t rows() const;
+
+    // Distinct values of a value-indexed field; 0 for the other fields
+    size_t distinctValues(ArtifactField field) const;
+    // Rows per distinct value, most frequent first; empty for fields without a value index
+    std::vector<std::pair<QString, size_t>> valueHistogram(ArtifactField field) const;
+    // Exact match counts from the value index; false when the field has none
+    bool countValues(ArtifactField field, const QString& needle, TextMatch match,
+                     Qt::CaseSensitivity sensitivity, size_t& count) const;
+    // Upper bound on the rows containing needle, from the trigram index; false when the field
+    // has none or the needle cannot use it. postingWork receives the posting entries read.
+    bool trigramBound(ArtifactField field, const QString& needle, size_t& bound, size_t& postingWork) const;
+
+    // Exact, from the date index
+    size_t countDateRange(const QDate& startDate, const QDate& endDate) const;
+    // At most bucketCount buckets holding about the same number of dated rows each
+    std::vector<DateBucket> dateHistogram(size_t bucketCount) const;
+
+private:
+    const ArtifactTable& m_table;
+};
+
+#endif // TABLE_STATISTICS_H
@@ -0,0 +1,152 @@
+#include "trigram_index.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+bool hasSurrogates(const QString& text) {
+    for (QChar c : text) {
+        if (c.isSurrogate()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::vector<quint64> TrigramIndex::trigramsOf(const QString& text) {
+    std::vector<quint64> trigrams;
+    if (text.size() < 3) {
+        return trigrams;
+    }
+    trigrams.reserve(text.size() - 2);
+    // Three folded UTF-16 code units packed into the low 48 bits
+    quint64 window = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        window = ((window << 16) | text[i].toCaseFolded().unicode()) & 0xFFFFFFFFFFFFull;
+        if (i >= 2) {
+            trigrams.push_back(window);
+        }
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void TrigramIndex::insert(ArtifactHandle handle, const QString& text) {
+    for (quint64 trigram : trigramsOf(text)) {
+        std::vector<ArtifactHandle>& postings = m_postings[trigram];
+        // Handles are issued in ascending order, so this is almost always an append
+        if (postings.empty() || postings.back() < handle) {
+            postings.push_back(handle);
+        } else {
+            auto it = std::lower_bound(postings.begin(), postings.end(), handle);
+            if (it == postings.end() || *it != handle) {
+                postings.insert(it, handle);
+            }
+        }
+    }
+}
+
+void TrigramIndex::remove(ArtifactHandle handle, const QString& text) {
+    for (quint64 trigram : trigramsOf(text)) {
+        auto entry = m_postings.find(trigram);
+        if (entry == m_postings.end()) {
+            continue;
+        }
+        std::vector<ArtifactHandle>& postings = entry.value();
+        auto it = std::lower_bound(postings.begin(), postings.end(), handle);
+        if (it != postings.end() && *it == handle) {
+            postings.erase(it);
+        }
+        if (postings.empty()) {
+            m_postings.erase(entry);
+        }
+    }
+}
+
+void TrigramIndex::clear() {
+    m_postings.clear();
+}
+
+bool TrigramIndex::canServe(const QString& needle) {
+    // Case-insensitive matching folds surrogate pairs as a whole, trigrams fold code units
+    return needle.size() >= 3 && !hasSurrogates(needle);
+}
+
+std::vector<ArtifactHandle> TrigramIndex::candidates(const QString& needle) const {
+    std::vector<const std::vector<ArtifactHandle>*> lists;
+    for (quint64 trigram : trigramsOf(needle)) {
+        auto entry = m_postings.constFind(trigram);
+        if (entry == m_postings.constEnd()) {
+            return {}; // A trigram nobody has: no candidates at all
+        }
+        lists.push_back(&entry.value());
+    }
+    if (lists.empty()) {
+        return {};
+    }
+
+    // Intersect starting from the shortest list so the working set only shrinks
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+    std::vector<ArtifactHandle> result = *lists.front();
+    std::vector<ArtifactHandle> next;
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        next.clear();
+        std::set_intersection(result.begin(), result.end(), lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(next));
+        result.swap(next);
+    }
+    return result;
+}
+
+size_t TrigramIndex::candidateBound(const QString& needle, size_t* postingWork) const {
+    size_t bound = std::numeric_limits<size_t>::max();
+    size_t work = 0;
+    for (quint64 trigram : trigramsOf(needle)) {
+        auto entry = m_postings.constFind(trigram);
+        size_t length = entry == m_postings.constEnd() ? 0 : entry.value().size();
+        bound = std::min(bound, length);
+        work += length;
+    }
+    if (postingWork) {
+        *postingWork = work;
+    }
+    return bound == std::numeric_limits<size_t>::max() ? 0 : bound;
+}
+
+bool TrigramIndex::canServeApproximate(const QString& needle, int maxEdits) {
+    return canServe(needle) && trigramsOf(needle).size() > 3 * static_cast<size_t>(std::max(maxEdits, 0));
+}
+
+std::vector<ArtifactHandle> TrigramIndex::approximateCandidates(const QString& needle, int maxEdits) const {
+    const std::vector<quint64> trigrams = trigramsOf(needle);
+    const size_t required = trigrams.size() - 3 * static_cast<size_t>(std::max(maxEdits, 0));
+    // Count each handle over the posting lists; a sorted merge keeps the result ascending
+    std::vector<ArtifactHandle> all;
+    for (quint64 trigram : trigrams) {
+        auto entry = m_postings.constFind(trigram);
+        if (entry != m_postings.constEnd()) {
+            all.insert(all.end(), entry.value().begin(), entry.value().end());
+        }
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<ArtifactHandle> result;
+    for (size_t i = 0; i < all.size();) {
+        size_t end = i;
+        while (end < all.size() && all[end] == all[i]) {
+            ++end;
+        }
+        if (end - i >= required) {
+            result.push_back(all[i]);
+        }
+        i = end;
+    }
+    return result;
+}
+
+size_t TrigramIndex::trigramCount() const {
+    return static_cast<size_t>(m_postings.size());
+}
@@ -0,0 +1,42 @@
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include "../domain/artifact.h"
+#include <QHash>
+#include <QString>
+#include <vector>
+
+// Inverted index from case-folded trigrams of one text field to the handles whose text contains them.
+// A substring query intersects the posting lists of its trigrams; the result is a superset of the
+// real matches (for either case sensitivity) that the caller still has to verify.
+class TrigramIndex {
+public:
+    void insert(ArtifactHandle handle, const QString& text);
+    void remove(ArtifactHandle handle, const QString& text); // text must be the one inserted
+    void clear();
+
+    // Needles shorter than a trigram (or with surrogate pairs) cannot be served and need a scan
+    static bool canServe(const QString& needle);
+    // Handles that contain every trigram of needle, ascending. Requires canServe(needle).
+    std::vector<ArtifactHandle> candidates(const QString& needle) const;
+    // Upper bound on candidates(needle).size(): the shortest posting list of its trigrams.
+    // postingWork, when given, receives the total length of those lists. Requires canServe(needle).
+    size_t candidateBound(const QString& needle, size_t* postingWork = nullptr) const;
+
+    // Approximate matches within maxEdits: each edit destroys at most three of the needle's
+    // distinct trigrams, so a match keeps all but 3 * maxEdits of them. That only prunes while
+    // the needle has more distinct trigrams than that.
+    static bool canServeApproximate(const QString& needle, int maxEdits);
+    // Handles holding enough of the needle's trigrams to match within maxEdits, ascending.
+    // Requires canServeApproximate(needle, maxEdits).
+    std::vector<ArtifactHandle> approximateCandidates(const QString& needle, int maxEdits) const;
+
+    size_t trigramCount() const;
+
+private:
+    static std::vector<quint64> trigramsOf(const QString& text); // Sorted, unique
+
+    QHash<quint64, std::vector<ArtifactHandle>> m_postings; // Each list sorted ascending
+};
+
+#endif // TRIGRAM_INDEX_H
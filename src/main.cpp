@@ -12,24 +12,37 @@
 class InMemoryRepository : public Repository {
 public:
     void addArtifact(const ArcheologicalArtifact& artifact) override {
+        ArcheologicalArtifact stored = artifact;
+        stored.setHandle(m_idTable.intern(artifact.getId()));
         // Prevent duplicates by ID for this simple repo
         for (size_t i = 0; i < artifacts.size(); ++i) {
-            if (artifacts[i].getId() == artifact.getId()) {
-                artifacts[i] = artifact; // Update if ID exists
+            if (artifacts[i].getHandle() == stored.getHandle()) {
+                ArtifactChangeSet change = ArtifactChangeSet::updated(artifacts[i], stored);
+                artifacts[i] = stored; // Update if ID exists
+                notifyObservers(change);
                 return;
             }
         }
-        artifacts.push_back(artifact);
+        artifacts.push_back(stored);
+        notifyObservers(ArtifactChangeSet::added(stored));
     }
     void removeArtifact(const QString& artifactId) override {
-        artifacts.erase(std::remove_if(artifacts.begin(), artifacts.end(),
-                                       [&](const ArcheologicalArtifact& a){ return a.getId() == artifactId; }),
-                        artifacts.end());
+        auto it = std::find_if(artifacts.begin(), artifacts.end(),
+                               [&](const ArcheologicalArtifact& a){ return a.getId() == artifactId; });
+        if (it != artifacts.end()) {
+            ArtifactChangeSet change = ArtifactChangeSet::removed(*it);
+            artifacts.erase(it);
+            notifyObservers(change);
+        }
     }
     void updateArtifact(const ArcheologicalArtifact& artifact) override {
         for (auto& existingArtifact : artifacts) {
             if (existingArtifact.getId() == artifact.getId()) {
-                existingArtifact = artifact;
+                ArtifactChangeSet change = ArtifactChangeSet::updated(existingArtifact, artifact);
+                change.apply(existingArtifact);
+                if (!change.isEmpty()) {
+                    notifyObservers(change);
+                }
                 return;
             }
         }
@@ -74,5 +87,8 @@ int main(int argc, char *argv[])
     MainWindow w(&controller);
     w.show();
 
-    return a.exec();
+    int result = a.exec();
+    // Next start reads the description index instead of rebuilding it
+    controller.saveSearchIndex();
+    return result;
 }
@@ -0,0 +1,98 @@
+#ifndef ARTIFACT_CODEC_H
+#define ARTIFACT_CODEC_H
+
+#include "../domain/artifact_schema.h"
+#include "../domain/iso_date.h"
+#include <QString>
+#include <QStringList>
+#include <QDate>
+#include <QJsonObject>
+#include <QDataStream>
+#include <vector>
+
+// Encoders/decoders generated from ArtifactSchema::fields.
+// Each codec only knows how to handle the value types (QString, QDate, GeoPoint).
+namespace ArtifactCodec {
+
+// Text form of a single value, shared by CSV and JSON
+inline QString toText(const QString& value) { return value; }
+inline QString toText(const QDate& value) { return IsoDate::format(value); }
+inline QString toText(const GeoPoint& value) { return value.toString(); }
+
+inline void fromText(const QString& text, QString& value) { value = text; }
+inline void fromText(const QString& text, QDate& value) { value = IsoDate::parse(text); }
+inline void fromText(const QString& text, GeoPoint& value) { value = GeoPoint::fromString(text); }
+
+// CSV: one column per field, in schema order
+inline QString csvHeader() {
+    QStringList headers;
+    ArtifactSchema::forEachField([&headers](const auto& descriptor) {
+        headers << QString::fromLatin1(descriptor.csvHeader);
+    });
+    return headers.join(",");
+}
+
+template <typename Escape>
+QString encodeCsv(const ArcheologicalArtifact& artifact, Escape&& escape) {
+    QStringList columns;
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        columns << escape(toText((artifact.*descriptor.get)()));
+    });
+    return columns.join(",");
+}
+
+// Returns false when the row lacks a required column; missing optional ones read as empty
+template <typename Unescape>
+bool decodeCsv(const std::vector<QString>& columns, ArcheologicalArtifact& artifact, Unescape&& unescape) {
+    if (columns.size() < ArtifactSchema::requiredFieldCount) {
+        return false;
+    }
+    ArtifactSchema::forEachFieldIndexed([&](size_t index, const auto& descriptor) {
+        typename std::decay_t<decltype(descriptor)>::ValueType value;
+        fromText(index < columns.size() ? unescape(columns[index]) : QString(), value);
+        (artifact.*descriptor.set)(value);
+    });
+    artifact.clearDirtyFields();
+    return true;
+}
+
+// JSON: one key per field
+inline QJsonObject encodeJson(const ArcheologicalArtifact& artifact) {
+    QJsonObject obj;
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        obj[QString::fromLatin1(descriptor.jsonKey)] = toText((artifact.*descriptor.get)());
+    });
+    return obj;
+}
+
+inline ArcheologicalArtifact decodeJson(const QJsonObject& obj) {
+    ArcheologicalArtifact artifact;
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        typename std::decay_t<decltype(descriptor)>::ValueType value;
+        fromText(obj[QString::fromLatin1(descriptor.jsonKey)].toString(), value);
+        (artifact.*descriptor.set)(value);
+    });
+    artifact.clearDirtyFields();
+    return artifact;
+}
+
+// Binary: QDataStream serialization of each field in schema order
+inline void encodeBinary(QDataStream& stream, const ArcheologicalArtifact& artifact) {
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        stream << (artifact.*descriptor.get)();
+    });
+}
+
+inline bool decodeBinary(QDataStream& stream, ArcheologicalArtifact& artifact) {
+    ArtifactSchema::forEachField([&](const auto& descriptor) {
+        typename std::decay_t<decltype(descriptor)>::ValueType value;
+        stream >> value;
+        (artifact.*descriptor.set)(value);
+    });
+    artifact.clearDirtyFields();
+    return stream.status() == QDataStream::Ok;
+}
+
+} // namespace ArtifactCodec
+
+#endif // ARTIFACT_CODEC_H
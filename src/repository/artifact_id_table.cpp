@@ -0,0 +1,37 @@
+#include "artifact_id_table.h"
+
+ArtifactHandle ArtifactIdTable::intern(const QString& id) {
+    auto it = m_handles.constFind(id);
+    if (it != m_handles.constEnd()) {
+        return it.value();
+    }
+
+    m_ids.push_back(id);
+    ArtifactHandle handle = static_cast<ArtifactHandle>(m_ids.size());
+    m_handles.insert(id, handle);
+    return handle;
+}
+
+ArtifactHandle ArtifactIdTable::handleForId(const QString& id) const {
+    return m_handles.value(id, InvalidArtifactHandle);
+}
+
+QString ArtifactIdTable::idForHandle(ArtifactHandle handle) const {
+    if (handle == InvalidArtifactHandle || handle > m_ids.size()) {
+        return QString();
+    }
+    return m_ids[handle - 1];
+}
+
+bool ArtifactIdTable::contains(const QString& id) const {
+    return m_handles.contains(id);
+}
+
+size_t ArtifactIdTable::size() const {
+    return m_ids.size();
+}
+
+void ArtifactIdTable::clear() {
+    m_handles.clear();
+    m_ids.clear();
+}
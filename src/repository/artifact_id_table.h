@@ -0,0 +1,27 @@
+#ifndef ARTIFACT_ID_TABLE_H
+#define ARTIFACT_ID_TABLE_H
+
+#include "../domain/artifact.h"
+#include <QString>
+#include <QHash>
+#include <vector>
+
+// Bidirectional ID <-> handle table.
+// Handles are dense (1..size()) and never reused, so an ID that is removed and
+// added again (e.g. by undo) keeps the handle it had before.
+class ArtifactIdTable {
+public:
+    ArtifactHandle intern(const QString& id); // Returns the existing handle or assigns a new one
+    ArtifactHandle handleForId(const QString& id) const; // InvalidArtifactHandle if unknown
+    QString idForHandle(ArtifactHandle handle) const; // Empty string if unknown
+
+    bool contains(const QString& id) const;
+    size_t size() const;
+    void clear();
+
+private:
+    QHash<QString, ArtifactHandle> m_handles;
+    std::vector<QString> m_ids; // m_ids[handle - 1] is the ID of that handle
+};
+
+#endif // ARTIFACT_ID_TABLE_H
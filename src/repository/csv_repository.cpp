@@ -1,4 +1,5 @@
 #include "csv_repository.h"
+#include "artifact_codec.h"
 #include <QFile>
 #include <QTextStream>
 #include <QStringList>
@@ -13,40 +14,59 @@ CsvRepository::CsvRepository(const QString& filePath) : m_filePath(filePath) {
 void CsvRepository::addArtifact(const ArcheologicalArtifact& artifact) {
     loadFromFile();
     
+    ArtifactHandle handle = m_idTable.intern(artifact.getId());
+    
     // Check for duplicate IDs
     for (const auto& existingArtifact : m_artifacts) {
-        if (existingArtifact.getId() == artifact.getId()) {
+        if (existingArtifact.getHandle() == handle) {
             throw std::runtime_error("Artifact with ID '" + artifact.getId().toStdString() + "' already exists.");
         }
     }
     
     m_artifacts.push_back(artifact);
+    m_artifacts.back().setHandle(handle);
+    m_artifacts.back().clearDirtyFields();
     saveToFile();
+    notifyObservers(ArtifactChangeSet::added(m_artifacts.back()));
 }
 
 void CsvRepository::removeArtifact(const QString& artifactId) {
     loadFromFile();
     
-    auto it = std::remove_if(m_artifacts.begin(), m_artifacts.end(),
-                            [&artifactId](const ArcheologicalArtifact& artifact) {
-                                return artifact.getId() == artifactId;
-                            });
+    ArtifactHandle handle = m_idTable.handleForId(artifactId);
+    auto it = std::find_if(m_artifacts.begin(), m_artifacts.end(),
+                          [handle](const ArcheologicalArtifact& artifact) {
+                              return artifact.getHandle() == handle;
+                          });
     
     if (it == m_artifacts.end()) {
         throw std::runtime_error("Artifact with ID '" + artifactId.toStdString() + "' not found.");
     }
     
-    m_artifacts.erase(it, m_artifacts.end());
+    ArtifactChangeSet change = ArtifactChangeSet::removed(*it);
+    m_artifacts.erase(it);
     saveToFile();
+    notifyObservers(change);
 }
 
 void CsvRepository::updateArtifact(const ArcheologicalArtifact& artifact) {
     loadFromFile();
     
+    ArtifactHandle handle = m_idTable.handleForId(artifact.getId());
     for (auto& existingArtifact : m_artifacts) {
-        if (existingArtifact.getId() == artifact.getId()) {
-            existingArtifact = artifact;
+        if (existingArtifact.getHandle() == handle) {
+            // An artifact read back from this repository knows which fields it touched
+            ArtifactFieldMask mask = (artifact.getHandle() == handle && artifact.isDirty())
+                                         ? artifact.dirtyFields() : AllArtifactFields;
+            ArtifactChangeSet change = ArtifactChangeSet::updated(existingArtifact, artifact, mask);
+            if (change.isEmpty()) {
+                return; // Nothing changed, skip the rewrite
+            }
+            
+            change.apply(existingArtifact);
+            existingArtifact.clearDirtyFields();
             saveToFile();
+            notifyObservers(change);
             return;
         }
     }
@@ -57,8 +77,9 @@ void CsvRepository::updateArtifact(const ArcheologicalArtifact& artifact) {
 ArcheologicalArtifact CsvRepository::findArtifactById(const QString& artifactId) const {
     loadFromFile(); // This call will now be valid
     
+    ArtifactHandle handle = m_idTable.handleForId(artifactId);
     for (const auto& artifact : m_artifacts) {
-        if (artifact.getId() == artifactId) {
+        if (artifact.getHandle() == handle) {
             return artifact;
         }
     }
@@ -66,6 +87,18 @@ ArcheologicalArtifact CsvRepository::findArtifactById(const QString& artifactId)
     throw std::runtime_error("Artifact with ID '" + artifactId.toStdString() + "' not found.");
 }
 
+ArcheologicalArtifact CsvRepository::findArtifactByHandle(ArtifactHandle handle) const {
+    loadFromFile();
+    
+    for (const auto& artifact : m_artifacts) {
+        if (artifact.getHandle() == handle) {
+            return artifact;
+        }
+    }
+    
+    throw std::runtime_error("Artifact with ID '" + idForHandle(handle).toStdString() + "' not found.");
+}
+
 std::vector<ArcheologicalArtifact> CsvRepository::getAllArtifacts() const {
     loadFromFile(); // This call will also be valid if loadFromFile is const
     return m_artifacts;
@@ -96,15 +129,10 @@ void CsvRepository::loadFromFile() const { // Add const here
         
         try {
             std::vector<QString> fields = parseCSVLine(line);
-            if (fields.size() >= 6) {
-                QString id = unescapeCSVField(fields[0]);
-                QString name = unescapeCSVField(fields[1]);
-                QString description = unescapeCSVField(fields[2]);
-                QString material = unescapeCSVField(fields[3]);
-                QDate discoveryDate = QDate::fromString(unescapeCSVField(fields[4]), Qt::ISODate);
-                QString location = unescapeCSVField(fields[5]);
-                
-                m_artifacts.emplace_back(id, name, description, material, discoveryDate, location);
+            ArcheologicalArtifact artifact;
+            if (ArtifactCodec::decodeCsv(fields, artifact, [this](const QString& field) { return unescapeCSVField(field); })) {
+                artifact.setHandle(m_idTable.intern(artifact.getId()));
+                m_artifacts.push_back(artifact);
             }
         } catch (const std::exception& e) {
             qDebug() << "Error parsing CSV line:" << line << " - " << e.what();
@@ -124,7 +152,7 @@ void CsvRepository::saveToFile() const {
     QTextStream stream(&file);
     
     // Write header
-    stream << "ID,Name,Description,Material,DiscoveryDate,Location\n";
+    stream << ArtifactCodec::csvHeader() << "\n";
     
     // Write artifacts
     for (const auto& artifact : m_artifacts) {
@@ -181,13 +209,5 @@ std::vector<QString> CsvRepository::parseCSVLine(const QString& line) const {
 }
 
 QString CsvRepository::formatCSVLine(const ArcheologicalArtifact& artifact) const {
-    QStringList fields;
-    fields << escapeCSVField(artifact.getId());
-    fields << escapeCSVField(artifact.getName());
-    fields << escapeCSVField(artifact.getDescription());
-    fields << escapeCSVField(artifact.getMaterial());
-    fields << escapeCSVField(artifact.getDiscoveryDate().toString(Qt::ISODate));
-    fields << escapeCSVField(artifact.getLocation());
-    
-    return fields.join(",");
-}
+    return ArtifactCodec::encodeCsv(artifact, [this](const QString& field) { return escapeCSVField(field); });
+}
\ No newline at end of file
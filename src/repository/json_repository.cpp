@@ -1,4 +1,5 @@
 #include "json_repository.h"
+#include "artifact_codec.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -14,40 +15,59 @@ JsonRepository::JsonRepository(const QString& filePath) : m_filePath(filePath) {
 void JsonRepository::addArtifact(const ArcheologicalArtifact& artifact) {
     loadFromFile();
     
+    ArtifactHandle handle = m_idTable.intern(artifact.getId());
+    
     // Check for duplicate IDs
     for (const auto& existingArtifact : m_artifacts) {
-        if (existingArtifact.getId() == artifact.getId()) {
+        if (existingArtifact.getHandle() == handle) {
             throw std::runtime_error("Artifact with ID '" + artifact.getId().toStdString() + "' already exists.");
         }
     }
     
     m_artifacts.push_back(artifact);
+    m_artifacts.back().setHandle(handle);
+    m_artifacts.back().clearDirtyFields();
     saveToFile();
+    notifyObservers(ArtifactChangeSet::added(m_artifacts.back()));
 }
 
 void JsonRepository::removeArtifact(const QString& artifactId) {
     loadFromFile();
     
-    auto it = std::remove_if(m_artifacts.begin(), m_artifacts.end(),
-                            [&artifactId](const ArcheologicalArtifact& artifact) {
-                                return artifact.getId() == artifactId;
-                            });
+    ArtifactHandle handle = m_idTable.handleForId(artifactId);
+    auto it = std::find_if(m_artifacts.begin(), m_artifacts.end(),
+                          [handle](const ArcheologicalArtifact& artifact) {
+                              return artifact.getHandle() == handle;
+                          });
     
     if (it == m_artifacts.end()) {
         throw std::runtime_error("Artifact with ID '" + artifactId.toStdString() + "' not found.");
     }
     
-    m_artifacts.erase(it, m_artifacts.end());
+    ArtifactChangeSet change = ArtifactChangeSet::removed(*it);
+    m_artifacts.erase(it);
     saveToFile();
+    notifyObservers(change);
 }
 
 void JsonRepository::updateArtifact(const ArcheologicalArtifact& artifact) {
     loadFromFile();
     
+    ArtifactHandle handle = m_idTable.handleForId(artifact.getId());
     for (auto& existingArtifact : m_artifacts) {
-        if (existingArtifact.getId() == artifact.getId()) {
-            existingArtifact = artifact;
+        if (existingArtifact.getHandle() == handle) {
+            // An artifact read back from this repository knows which fields it touched
+            ArtifactFieldMask mask = (artifact.getHandle() == handle && artifact.isDirty())
+                                         ? artifact.dirtyFields() : AllArtifactFields;
+            ArtifactChangeSet change = ArtifactChangeSet::updated(existingArtifact, artifact, mask);
+            if (change.isEmpty()) {
+                return; // Nothing changed, skip the rewrite
+            }
+            
+            change.apply(existingArtifact);
+            existingArtifact.clearDirtyFields();
             saveToFile();
+            notifyObservers(change);
             return;
         }
     }
@@ -58,8 +78,9 @@ void JsonRepository::updateArtifact(const ArcheologicalArtifact& artifact) {
 ArcheologicalArtifact JsonRepository::findArtifactById(const QString& artifactId) const {
     loadFromFile();
     
+    ArtifactHandle handle = m_idTable.handleForId(artifactId);
     for (const auto& artifact : m_artifacts) {
-        if (artifact.getId() == artifactId) {
+        if (artifact.getHandle() == handle) {
             return artifact;
         }
     }
@@ -67,6 +88,18 @@ ArcheologicalArtifact JsonRepository::findArtifactById(const QString& artifactId
     throw std::runtime_error("Artifact with ID '" + artifactId.toStdString() + "' not found.");
 }
 
+ArcheologicalArtifact JsonRepository::findArtifactByHandle(ArtifactHandle handle) const {
+    loadFromFile();
+    
+    for (const auto& artifact : m_artifacts) {
+        if (artifact.getHandle() == handle) {
+            return artifact;
+        }
+    }
+    
+    throw std::runtime_error("Artifact with ID '" + idForHandle(handle).toStdString() + "' not found.");
+}
+
 std::vector<ArcheologicalArtifact> JsonRepository::getAllArtifacts() const {
     loadFromFile();
     return m_artifacts;
@@ -109,6 +142,7 @@ void JsonRepository::loadFromFile() const {
         if (value.isObject()) {
             try {
                 ArcheologicalArtifact artifact = jsonToArtifact(value.toObject());
+                artifact.setHandle(m_idTable.intern(artifact.getId()));
                 m_artifacts.push_back(artifact);
             } catch (const std::exception& e) {
                 qDebug() << "Error parsing JSON artifact:" << e.what();
@@ -143,23 +177,9 @@ void JsonRepository::saveToFile() const {
 }
 
 QJsonObject JsonRepository::artifactToJson(const ArcheologicalArtifact& artifact) const {
-    QJsonObject obj;
-    obj["id"] = artifact.getId();
-    obj["name"] = artifact.getName();
-    obj["description"] = artifact.getDescription();
-    obj["material"] = artifact.getMaterial();
-    obj["discoveryDate"] = artifact.getDiscoveryDate().toString(Qt::ISODate);
-    obj["location"] = artifact.getLocation();
-    return obj;
+    return ArtifactCodec::encodeJson(artifact);
 }
 
 ArcheologicalArtifact JsonRepository::jsonToArtifact(const QJsonObject& jsonObj) const {
-    QString id = jsonObj["id"].toString();
-    QString name = jsonObj["name"].toString();
-    QString description = jsonObj["description"].toString();
-    QString material = jsonObj["material"].toString();
-    QDate discoveryDate = QDate::fromString(jsonObj["discoveryDate"].toString(), Qt::ISODate);
-    QString location = jsonObj["location"].toString();
-    
-    return ArcheologicalArtifact(id, name, description, material, discoveryDate, location);
+    return ArtifactCodec::decodeJson(jsonObj);
 }
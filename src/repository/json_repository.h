@@ -17,6 +17,8 @@ public:
     void updateArtifact(const ArcheologicalArtifact& artifact) override;
     ArcheologicalArtifact findArtifactById(const QString& artifactId) const override;
     std::vector<ArcheologicalArtifact> getAllArtifacts() const override;
+    ArcheologicalArtifact findArtifactByHandle(ArtifactHandle handle) const override;
+    QString storagePath() const override { return m_filePath; }
 
 private:
     QString m_filePath;
@@ -6,6 +6,16 @@
 #include <memory> // For std::unique_ptr if needed for return types, or smart pointers in implementations
 #include <QString>
 #include "../domain/artifact.h" // Path to your ArcheologicalArtifact header
+#include "../domain/artifact_change.h"
+#include "artifact_id_table.h"
+#include <algorithm>
+
+// Receives a change set after every successful repository mutation
+class RepositoryObserver {
+public:
+    virtual ~RepositoryObserver() = default;
+    virtual void onArtifactChanged(const ArtifactChangeSet& change) = 0;
+};
 
 class Repository {
 public:
@@ -18,6 +28,35 @@ public:
     virtual std::vector<ArcheologicalArtifact> getAllArtifacts() const = 0;
     // You might also need methods like:
     // virtual bool artifactExists(const QString& artifactId) const = 0;
+
+    // Handle lookups. Implementations intern every ID they store, so these stay valid
+    // (and stable) for the lifetime of the repository object.
+    virtual ArcheologicalArtifact findArtifactByHandle(ArtifactHandle handle) const {
+        return findArtifactById(idForHandle(handle));
+    }
+    ArtifactHandle handleForId(const QString& artifactId) const { return m_idTable.handleForId(artifactId); }
+    QString idForHandle(ArtifactHandle handle) const { return m_idTable.idForHandle(handle); }
+
+    // File the artifacts are stored in, so that derived data can be kept beside it; empty if none
+    virtual QString storagePath() const { return QString(); }
+
+    // Observers are not owned and must unregister before they are destroyed
+    void addObserver(RepositoryObserver* observer) { m_observers.push_back(observer); }
+    void removeObserver(RepositoryObserver* observer) {
+        m_observers.erase(std::remove(m_observers.begin(), m_observers.end(), observer), m_observers.end());
+    }
+
+protected:
+    void notifyObservers(const ArtifactChangeSet& change) const {
+        for (RepositoryObserver* observer : m_observers) {
+            observer->onArtifactChanged(change);
+        }
+    }
+
+    mutable ArtifactIdTable m_idTable; // mutable: filled by the lazy const loaders
+
+private:
+    std::vector<RepositoryObserver*> m_observers;
 };
 
-#endif // REPOSITORY_H
\ No newline at end of file
+#endif // REPOSITORY_H
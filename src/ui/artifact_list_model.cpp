@@ -0,0 +1,69 @@
+#include "artifact_list_model.h"
+
+ArtifactListModel::ArtifactListModel(LiveView& view, QObject* parent)
+    : QAbstractListModel(parent), m_view(view) {
+    m_view.setListener(this);
+}
+
+ArtifactListModel::~ArtifactListModel() {
+    m_view.setListener(nullptr);
+}
+
+int ArtifactListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return HeaderRows + static_cast<int>(m_view.size());
+}
+
+QVariant ArtifactListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (index.row() == 0) {
+        return QString("+ Create New Artifact");
+    }
+    if (index.row() == 1) {
+        return QString("-------------------");
+    }
+    const ArcheologicalArtifact& artifact = m_view.artifact(static_cast<size_t>(index.row() - HeaderRows));
+    return QString("%1: %2").arg(artifact.getId()).arg(artifact.getName());
+}
+
+ArtifactHandle ArtifactListModel::handleForRow(int row) const {
+    if (row < HeaderRows || row >= rowCount()) {
+        return InvalidArtifactHandle;
+    }
+    return m_view.handle(static_cast<size_t>(row - HeaderRows));
+}
+
+void ArtifactListModel::beginInsert(size_t position) {
+    int row = HeaderRows + static_cast<int>(position);
+    beginInsertRows(QModelIndex(), row, row);
+}
+
+void ArtifactListModel::endInsert() {
+    endInsertRows();
+}
+
+void ArtifactListModel::beginRemove(size_t position) {
+    int row = HeaderRows + static_cast<int>(position);
+    beginRemoveRows(QModelIndex(), row, row);
+}
+
+void ArtifactListModel::endRemove() {
+    endRemoveRows();
+}
+
+void ArtifactListModel::rowChanged(size_t position) {
+    QModelIndex changed = index(HeaderRows + static_cast<int>(position));
+    emit dataChanged(changed, changed);
+}
+
+void ArtifactListModel::beginReset() {
+    beginResetModel();
+}
+
+void ArtifactListModel::endReset() {
+    endResetModel();
+}
@@ -0,0 +1,37 @@
+#ifndef ARTIFACT_LIST_MODEL_H
+#define ARTIFACT_LIST_MODEL_H
+
+#include <QAbstractListModel>
+#include "../controller/live_view.h"
+
+// List model over a LiveView for the artifacts list: the "+ Create New Artifact" row and a
+// separator, then one "ID: Name" row per artifact. Edits to the view arrive as row
+// insertions, removals and dataChanged instead of a full reset of the list.
+class ArtifactListModel : public QAbstractListModel, public LiveViewListener {
+    Q_OBJECT
+
+public:
+    static constexpr int HeaderRows = 2;
+
+    // Listens to the view until destroyed; the view must outlive the model
+    explicit ArtifactListModel(LiveView& view, QObject* parent = nullptr);
+    ~ArtifactListModel() override;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    ArtifactHandle handleForRow(int row) const; // InvalidArtifactHandle for the header rows
+
+    void beginInsert(size_t position) override;
+    void endInsert() override;
+    void beginRemove(size_t position) override;
+    void endRemove() override;
+    void rowChanged(size_t position) override;
+    void beginReset() override;
+    void endReset() override;
+
+private:
+    LiveView& m_view;
+};
+
+#endif // ARTIFACT_LIST_MODEL_H
@@ -7,17 +7,59 @@
 #include <QListWidget>    // Add this
 #include <QPushButton>    // Add this
 #include <QLabel>         // Add this
+#include <QLocale>
+#include <stdexcept>
+
+namespace {
+
+// Comma-separated decimal numbers typed into the filter box, exactly count of them
+std::vector<double> parseNumbers(const QString& text, int count) {
+    const QStringList parts = text.split(',');
+    std::vector<double> numbers;
+    for (const QString& part : parts) {
+        bool ok = false;
+        numbers.push_back(part.trimmed().toDouble(&ok));
+        if (!ok) {
+            numbers.clear();
+            break;
+        }
+    }
+    if (static_cast<int>(numbers.size()) != count) {
+        throw std::invalid_argument(QString("Expected %1 comma-separated numbers.").arg(count).toStdString());
+    }
+    return numbers;
+}
+
+// Filters over the coordinates: "radius" takes "latitude, longitude, km" and "box" takes
+// "south, west, north, east"; throws std::invalid_argument for anything else
+std::unique_ptr<FilterStrategy> makeSpatialFilter(const QString& type, const QString& text) {
+    if (type == "radius") {
+        std::vector<double> values = parseNumbers(text, 3);
+        return std::make_unique<RadiusFilter>(GeoPoint(values[0], values[1]), values[2]);
+    }
+    std::vector<double> values = parseNumbers(text, 4);
+    return std::make_unique<BoundingBoxFilter>(GeoBox(values[0], values[1], values[2], values[3]));
+}
+
+QString formatDegrees(double degrees) {
+    return QString::number(degrees, 'g', QLocale::FloatingPointShortest);
+}
+
+} // namespace
 
 MainWindow::MainWindow(ArtifactController* controller, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , m_controller(controller)
-    , m_artifactsModel(new QStringListModel(this))
+    , m_artifactsModel(nullptr)
     , m_filterTypeComboBox(nullptr)      // Initialize to nullptr
     , m_filterLogicComboBox(nullptr)     // Initialize to nullptr
     , m_startDateEdit(nullptr)           // Initialize to nullptr
     , m_endDateEdit(nullptr)             // Initialize to nullptr
     , m_activeFilters(nullptr)           // Initialize to nullptr
+    , m_facets(nullptr)
+    , m_filterCompleter(nullptr)
+    , m_suggestions(nullptr)
     , m_compositeFilter(nullptr)         // Initialize to nullptr
 {
     ui->setupUi(this);
@@ -27,11 +69,24 @@ MainWindow::MainWindow(ArtifactController* controller, QWidget *parent)
         return;
     }
     
+    m_liveView = m_controller->createLiveView();
+    m_liveView->setMemberListener(&m_facetCounts);
+    m_artifactsModel = new ArtifactListModel(*m_liveView, this);
     ui->artifactsListView->setModel(m_artifactsModel);
     
     // Setup filter UI AFTER ui->setupUi()
     setupFilterUI();
     
+    // The counts follow each edit on their own; redrawing them waits for the event loop, so a
+    // burst of changes redraws once
+    m_facetTimer.setSingleShot(true);
+    m_facetTimer.setInterval(0);
+    connect(&m_facetTimer, &QTimer::timeout, this, &MainWindow::updateFacets);
+    connect(m_artifactsModel, &QAbstractItemModel::modelReset, &m_facetTimer, QOverload<>::of(&QTimer::start));
+    connect(m_artifactsModel, &QAbstractItemModel::rowsInserted, &m_facetTimer, QOverload<>::of(&QTimer::start));
+    connect(m_artifactsModel, &QAbstractItemModel::rowsRemoved, &m_facetTimer, QOverload<>::of(&QTimer::start));
+    connect(m_artifactsModel, &QAbstractItemModel::dataChanged, &m_facetTimer, QOverload<>::of(&QTimer::start));
+    
     // Populate initial list
     populateArtifactsList();
 }
@@ -39,27 +94,20 @@ MainWindow::MainWindow(ArtifactController* controller, QWidget *parent)
 MainWindow::~MainWindow()
 {
     delete ui;
-    // m_artifactsModel is a child of MainWindow, so it will be deleted automatically.
+    // The model listens to m_liveView, so it goes first
+    delete m_artifactsModel;
+    m_liveView.reset();
     // m_controller is not owned by MainWindow, so it's not deleted here.
 }
 
 void MainWindow::populateArtifactsList() {
-    if (!m_controller) return;
+    if (!m_liveView) return;
 
-    QStringList artifactDisplayList;
-    
-    // Add special "New Artifact" item at the top
-    artifactDisplayList.append("+ Create New Artifact");
-    
-    // Add a visual separator
-    artifactDisplayList.append("-------------------");
-    
-    std::vector<ArcheologicalArtifact> artifacts = m_controller->getAllArtifacts();
-    for (const auto& artifact : artifacts) {
-        // Display ID and Name, or customize as needed
-        artifactDisplayList.append(QString("%1: %2").arg(artifact.getId()).arg(artifact.getName()));
-    }
-    m_artifactsModel->setStringList(artifactDisplayList);
+    m_liveView->setFilter(nullptr);
+}
+
+ArtifactHandle MainWindow::handleForRow(int row) const {
+    return m_artifactsModel ? m_artifactsModel->handleForRow(row) : InvalidArtifactHandle;
 }
 
 void MainWindow::clearInputFields() {
@@ -69,6 +117,8 @@ void MainWindow::clearInputFields() {
     ui->lineEdit_Material->clear();
     ui->dateEdit_DiscoveryDate->setDate(QDate::currentDate()); // Reset to current date or a default
     ui->lineEdit_Location->clear();
+    ui->lineEdit_Latitude->clear();
+    ui->lineEdit_Longitude->clear();
 }
 
 ArcheologicalArtifact MainWindow::getArtifactFromFields() const {
@@ -78,7 +128,17 @@ ArcheologicalArtifact MainWindow::getArtifactFromFields() const {
     QString material = ui->lineEdit_Material->text();
     QDate discoveryDate = ui->dateEdit_DiscoveryDate->date();
     QString location = ui->lineEdit_Location->text();
-    return ArcheologicalArtifact(id, name, description, material, discoveryDate, location);
+    // Both blank means not surveyed; anything else has to be a valid position
+    GeoPoint coordinates;
+    QString latitude = ui->lineEdit_Latitude->text().trimmed();
+    QString longitude = ui->lineEdit_Longitude->text().trimmed();
+    if (!latitude.isEmpty() || !longitude.isEmpty()) {
+        coordinates = GeoPoint::fromString(latitude + ',' + longitude);
+        if (!coordinates.isValid()) {
+            throw std::invalid_argument("Latitude must lie in [-90, 90] and longitude in [-180, 180].");
+        }
+    }
+    return ArcheologicalArtifact(id, name, description, material, discoveryDate, location, coordinates);
 }
 
 void MainWindow::populateFieldsFromArtifact(const ArcheologicalArtifact& artifact) {
@@ -88,6 +148,9 @@ void MainWindow::populateFieldsFromArtifact(const ArcheologicalArtifact& artifac
     ui->lineEdit_Material->setText(artifact.getMaterial());
     ui->dateEdit_DiscoveryDate->setDate(artifact.getDiscoveryDate());
     ui->lineEdit_Location->setText(artifact.getLocation());
+    const GeoPoint& coordinates = artifact.getCoordinates();
+    ui->lineEdit_Latitude->setText(coordinates.isValid() ? formatDegrees(coordinates.latitude()) : QString());
+    ui->lineEdit_Longitude->setText(coordinates.isValid() ? formatDegrees(coordinates.longitude()) : QString());
 }
 
 void MainWindow::on_pushButton_Add_clicked()
@@ -101,8 +164,8 @@ void MainWindow::on_pushButton_Add_clicked()
         }
         // TODO: Add more robust validation
         m_controller->addArtifact(artifact.getId(), artifact.getName(), artifact.getDescription(),
-                                  artifact.getMaterial(), artifact.getDiscoveryDate(), artifact.getLocation());
-        populateArtifactsList();
+                                  artifact.getMaterial(), artifact.getDiscoveryDate(), artifact.getLocation(),
+                                  artifact.getCoordinates());
         clearInputFields();
         QMessageBox::information(this, "Success", "Artifact added.");
     } catch (const std::exception& e) {
@@ -128,10 +191,8 @@ void MainWindow::on_pushButton_Update_clicked()
         return;
     }
     
-    // Assuming single selection, and the displayed text contains the ID first.
-    // This is a bit fragile; a better way is to store full objects or IDs in the model.
-    QString selectedText = m_artifactsModel->data(selectedIndexes.first(), Qt::DisplayRole).toString();
-    QString originalId = selectedText.split(":").first().trimmed(); // Extract ID
+    // Each row remembers the handle of the artifact it shows
+    QString originalId = m_controller->idForHandle(handleForRow(row));
 
     if (originalId.isEmpty()) {
          QMessageBox::warning(this, "Error", "Could not determine the original ID of the selected artifact.");
@@ -150,8 +211,8 @@ void MainWindow::on_pushButton_Update_clicked()
         // If the ID can change, the controller needs the originalId.
         m_controller->updateArtifact(originalId, // Pass original ID if your controller needs it
                                      updatedArtifact.getId(), updatedArtifact.getName(), updatedArtifact.getDescription(),
-                                     updatedArtifact.getMaterial(), updatedArtifact.getDiscoveryDate(), updatedArtifact.getLocation());
-        populateArtifactsList();
+                                     updatedArtifact.getMaterial(), updatedArtifact.getDiscoveryDate(), updatedArtifact.getLocation(),
+                                     updatedArtifact.getCoordinates());
         clearInputFields();
         QMessageBox::information(this, "Success", "Artifact updated.");
     } catch (const std::exception& e) {
@@ -176,9 +237,7 @@ void MainWindow::on_pushButton_Remove_clicked()
         return;
     }
     
-    // Fragile way to get ID, similar to update.
-    QString selectedText = m_artifactsModel->data(selectedIndexes.first(), Qt::DisplayRole).toString();
-    QString artifactId = selectedText.split(":").first().trimmed();
+    QString artifactId = m_controller->idForHandle(handleForRow(row));
 
     if (artifactId.isEmpty()) {
         QMessageBox::warning(this, "Error", "Could not determine the ID of the selected artifact.");
@@ -191,7 +250,6 @@ void MainWindow::on_pushButton_Remove_clicked()
     if (reply == QMessageBox::Yes) {
         try {
             m_controller->removeArtifact(artifactId);
-            populateArtifactsList();
             clearInputFields();
             QMessageBox::information(this, "Success", "Artifact removed.");
         } catch (const std::exception& e) {
@@ -221,12 +279,12 @@ void MainWindow::on_artifactsListView_clicked(const QModelIndex &index)
     }
 
     // Original code for handling artifact selection
-    QString artifactId = selectedText.split(":").first().trimmed();
+    ArtifactHandle handle = handleForRow(row);
 
-    if (artifactId.isEmpty()) return;
+    if (handle == InvalidArtifactHandle) return;
 
     try {
-        ArcheologicalArtifact artifact = m_controller->getArtifactById(artifactId);
+        ArcheologicalArtifact artifact = m_controller->getArtifactByHandle(handle);
         populateFieldsFromArtifact(artifact);
     } catch (const std::exception& e) {
         QMessageBox::warning(this, "Error", QString("Could not retrieve artifact details: %1").arg(e.what()));
@@ -241,7 +299,6 @@ void MainWindow::on_pushButton_Undo_clicked()
     
     if (m_controller->canUndo()) {
         m_controller->undo();
-        populateArtifactsList();
         QMessageBox::information(this, "Undo", "Last action undone.");
     } else {
         QMessageBox::information(this, "Undo", "Nothing to undo.");
@@ -254,13 +311,31 @@ void MainWindow::on_pushButton_Redo_clicked()
     
     if (m_controller->canRedo()) {
         m_controller->redo();
-        populateArtifactsList();
         QMessageBox::information(this, "Redo", "Last undone action redone.");
     } else {
         QMessageBox::information(this, "Redo", "Nothing to redo.");
     }
 }
 
+void MainWindow::on_pushButton_FindDuplicates_clicked()
+{
+    if (!m_controller) return;
+    
+    // The summary goes in the text, the groups and their pairs behind "Show Details"
+    NearDuplicateReport report = m_controller->findNearDuplicates();
+    QMessageBox box(this);
+    box.setWindowTitle("Find Duplicates");
+    box.setIcon(QMessageBox::Information);
+    if (report.pairs.empty()) {
+        box.setText("No near-duplicate artifacts found.");
+    } else {
+        const QString text = report.toText();
+        box.setText(text.section('\n', 0, 0));
+        box.setDetailedText(text.section('\n', 2));
+    }
+    box.exec();
+}
+
 void MainWindow::on_pushButton_ApplyFilter_clicked()
 {
     if (!m_controller) return;
@@ -293,6 +368,11 @@ void MainWindow::on_pushButton_ApplyFilter_clicked()
             filter = std::make_unique<NameFilter>(filterText, false);
             displayText = QString("Name: contains '%1'").arg(filterText);
         }
+        else if (filterType == "fuzzy") {
+            int edits = FuzzyNameFilter::suggestedEdits(filterText);
+            filter = std::make_unique<FuzzyNameFilter>(filterText, edits);
+            displayText = QString("Name: like '%1' (up to %2 edits)").arg(filterText).arg(edits);
+        }
         else if (filterType == "id") {
             filter = std::make_unique<IdFilter>(filterText, false);
             displayText = QString("ID: contains '%1'").arg(filterText);
@@ -305,6 +385,40 @@ void MainWindow::on_pushButton_ApplyFilter_clicked()
             filter = std::make_unique<LocationFilter>(filterText, false);
             displayText = QString("Location: contains '%1'").arg(filterText);
         }
+        else if (filterType == "description") {
+            filter = std::make_unique<DescriptionFilter>(filterText, false);
+            displayText = QString("Description: contains '%1'").arg(filterText);
+        }
+        else if (filterType == "words") {
+            filter = std::make_unique<DescriptionSearch>(filterText);
+            displayText = QString("Description: has words %1").arg(filterText);
+        }
+        else if (filterType == "regex-name" || filterType == "regex-description") {
+            ArtifactField field = filterType == "regex-name" ? ArtifactField::Name : ArtifactField::Description;
+            try {
+                filter = std::make_unique<RegexFilter>(field, filterText, false);
+            } catch (const std::invalid_argument& e) {
+                QMessageBox::warning(this, "Invalid Pattern", e.what());
+                return;
+            }
+            displayText = QString("%1: matches /%2/")
+                              .arg(field == ArtifactField::Name ? "Name" : "Description").arg(filterText);
+        }
+        else if (filterType == "radius" || filterType == "box") {
+            try {
+                filter = makeSpatialFilter(filterType, filterText);
+            } catch (const std::invalid_argument& e) {
+                QMessageBox::warning(this, "Invalid Coordinates", e.what());
+                return;
+            }
+            if (auto radius = dynamic_cast<const RadiusFilter*>(filter.get())) {
+                displayText = QString("Coordinates: within %1 km of %2, %3").arg(radius->radiusKm())
+                                  .arg(formatDegrees(radius->center().latitude()))
+                                  .arg(formatDegrees(radius->center().longitude()));
+            } else {
+                displayText = QString("Coordinates: in box %1").arg(filterText);
+            }
+        }
         
         if (filter) {
             addActiveFilter(std::move(filter), displayText);
@@ -317,16 +431,35 @@ void MainWindow::setupFilterUI() {
     if (!m_filterTypeComboBox) {
         m_filterTypeComboBox = new QComboBox(this);
         m_filterTypeComboBox->addItem("Name", "name");
+        m_filterTypeComboBox->addItem("Name (approximate)", "fuzzy");
+        m_filterTypeComboBox->addItem("Name (regex)", "regex-name");
         m_filterTypeComboBox->addItem("ID", "id");
         m_filterTypeComboBox->addItem("Material", "material");
         m_filterTypeComboBox->addItem("Location", "location");
+        m_filterTypeComboBox->addItem("Description", "description");
+        m_filterTypeComboBox->addItem("Description (words)", "words");
+        m_filterTypeComboBox->addItem("Description (regex)", "regex-description");
         m_filterTypeComboBox->addItem("Date Range", "date");
+        m_filterTypeComboBox->addItem("Within Distance (lat, lon, km)", "radius");
+        m_filterTypeComboBox->addItem("Bounding Box (S, W, N, E)", "box");
         
         if (ui->horizontalLayout_Filter) {
             ui->horizontalLayout_Filter->insertWidget(0, m_filterTypeComboBox);
         }
     }
 
+    // Suggest the most frequent values as the criteria are typed. The trie already narrows them
+    // to the prefix, so the completer shows its model as is.
+    if (!m_filterCompleter && ui->lineEdit_FilterCriteria) {
+        m_suggestions = new QStringListModel(this);
+        m_filterCompleter = new QCompleter(this);
+        m_filterCompleter->setModel(m_suggestions);
+        m_filterCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        m_filterCompleter->setCaseSensitivity(Qt::CaseInsensitive);
+        ui->lineEdit_FilterCriteria->setCompleter(m_filterCompleter);
+        connect(ui->lineEdit_FilterCriteria, &QLineEdit::textEdited, this, &MainWindow::onFilterTextEdited);
+    }
+
     // Create filter logic combo box
     if (!m_filterLogicComboBox) {
         m_filterLogicComboBox = new QComboBox(this);
@@ -378,6 +511,17 @@ void MainWindow::setupFilterUI() {
         }
     }
 
+    // Create the facet counts of the current filter
+    if (!m_facets) {
+        m_facets = new QListWidget(this);
+        m_facets->setSelectionMode(QAbstractItemView::NoSelection);
+        
+        if (ui->verticalLayout_Controls) {
+            ui->verticalLayout_Controls->addWidget(new QLabel("Summary:", this));
+            ui->verticalLayout_Controls->addWidget(m_facets);
+        }
+    }
+
     // Connect signals AFTER widgets are created
     connect(m_filterTypeComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), 
             this, &MainWindow::onFilterTypeChanged);
@@ -404,6 +548,29 @@ void MainWindow::onFilterTypeChanged(int index) {
     }
     m_startDateEdit->setVisible(isDateRange);
     m_endDateEdit->setVisible(isDateRange);
+    if (m_suggestions) {
+        m_suggestions->setStringList(QStringList()); // They belonged to the previous field
+    }
+}
+
+void MainWindow::onFilterTextEdited(const QString& text) {
+    if (!m_controller || !m_suggestions || !m_filterTypeComboBox) return;
+    
+    QString type = m_filterTypeComboBox->currentData().toString();
+    ArtifactField field;
+    if (type == "name" || type == "fuzzy") {
+        field = ArtifactField::Name;
+    } else if (type == "material") {
+        field = ArtifactField::Material;
+    } else if (type == "location") {
+        field = ArtifactField::Location;
+    } else {
+        m_suggestions->setStringList(QStringList()); // No suggestions for IDs, descriptions, dates or coordinates
+        return;
+    }
+    
+    m_suggestions->setStringList(text.isEmpty() ? QStringList() : m_controller->suggestValues(field, text.trimmed()));
+    m_filterCompleter->complete();
 }
 
 void MainWindow::resetFilters() {
@@ -470,21 +637,47 @@ void MainWindow::applyCurrentFilter() {
         return;
     }
     
-    QStringList displayList;
-    
-    // Always keep the "New Artifact" option at the top
-    displayList.append("+ Create New Artifact");
-    displayList.append("-------------------");
-    
-    ArtifactFilter filter(m_compositeFilter->clone());
-    std::vector<ArcheologicalArtifact> artifacts = m_controller->getAllArtifacts();
-    auto filteredArtifacts = filter.filter(artifacts);
-    
-    // Update display with filtered artifacts
-    for (const auto& artifact : filteredArtifacts) {
-        displayList.append(QString("%1: %2").arg(artifact.getId()).arg(artifact.getName()));
+    // The live view keeps the result current as artifacts change; the "New Artifact" rows stay on top
+    m_liveView->setFilter(m_compositeFilter->clone(), FilterExecution::Parallel);
+    if (m_activeFilters) {
+        m_activeFilters->setToolTip(m_controller->explainFilter(*m_compositeFilter));
     }
-    m_artifactsModel->setStringList(displayList);
+}
+
+void MainWindow::updateFacets() {
+    if (!m_controller || !m_facets) return;
+    
+    const size_t shown = 8; // Most frequent values per facet; the rest are summed up as "other"
+    Aggregation summary = m_facetCounts.aggregation();
+    m_facets->clear();
+    QString range = summary.earliest.isValid()
+        ? QString(", %1 to %2").arg(summary.earliest.toString("yyyy-MM-dd")).arg(summary.latest.toString("yyyy-MM-dd"))
+        : QString();
+    m_facets->addItem(QString("%1 artifacts%2").arg(summary.rows).arg(range));
+    
+    auto addFacet = [this](const QString& title, const std::vector<std::pair<QString, size_t>>& counts, size_t limit) {
+        if (counts.empty()) return;
+        m_facets->addItem(title);
+        size_t other = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (i < limit) {
+                m_facets->addItem(QString("    %1 (%2)").arg(counts[i].first.isEmpty() ? "(none)" : counts[i].first)
+                                                       .arg(counts[i].second));
+            } else {
+                other += counts[i].second;
+            }
+        }
+        if (other) {
+            m_facets->addItem(QString("    other (%1)").arg(other));
+        }
+    };
+    addFacet("Material", summary.counts(ArtifactField::Material), shown);
+    addFacet("Location", summary.counts(ArtifactField::Location), shown);
+    std::vector<std::pair<QString, size_t>> decades;
+    for (const auto& [year, count] : summary.dateCounts) {
+        decades.emplace_back(QString("%1s").arg(year), count);
+    }
+    addFacet("Decade", decades, decades.size()); // In order, so all of them
 }
 
 void MainWindow::onRemoveFilterClicked() {
@@ -541,6 +734,9 @@ void MainWindow::rebuildCompositeFilterFromUI() {
             if (filterType == "name") {
                 filter = std::make_unique<NameFilter>(text, false);
             }
+            else if (filterType == "fuzzy") {
+                filter = std::make_unique<FuzzyNameFilter>(text, FuzzyNameFilter::suggestedEdits(text));
+            }
             else if (filterType == "id") {
                 filter = std::make_unique<IdFilter>(text, false);
             }
@@ -550,6 +746,21 @@ void MainWindow::rebuildCompositeFilterFromUI() {
             else if (filterType == "location") {
                 filter = std::make_unique<LocationFilter>(text, false);
             }
+            else if (filterType == "description") {
+                filter = std::make_unique<DescriptionFilter>(text, false);
+            }
+            else if (filterType == "words") {
+                filter = std::make_unique<DescriptionSearch>(text);
+            }
+            else if (filterType == "regex-name") {
+                filter = std::make_unique<RegexFilter>(ArtifactField::Name, text, false); // Checked when added
+            }
+            else if (filterType == "regex-description") {
+                filter = std::make_unique<RegexFilter>(ArtifactField::Description, text, false);
+            }
+            else if (filterType == "radius" || filterType == "box") {
+                filter = makeSpatialFilter(filterType, text); // Checked when added
+            }
         }
         
         // Add to composite filter if successfully created
@@ -2,11 +2,15 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QStringListModel> // For QListView example
+#include "artifact_list_model.h"
 #include "../controller/artifact_controller.h" // Include your controller
+#include "../controller/facet_counts.h"
 #include <QComboBox>
 #include <QDateEdit>
 #include <QListWidget>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QTimer>
 #include "../controller/filter.h" 
 #include <memory> // For std::unique_ptr
 
@@ -33,16 +37,19 @@ private slots:
     void on_pushButton_Undo_clicked();
     void on_pushButton_Redo_clicked();
     void on_pushButton_ApplyFilter_clicked();
+    void on_pushButton_FindDuplicates_clicked();
     void on_artifactsListView_clicked(const QModelIndex &index); // To populate fields when an item is clicked
     void onFilterTypeChanged(int index);
     void onRemoveFilterClicked();
     void resetFilters();
     void onFilterLogicChanged();
+    void onFilterTextEdited(const QString& text);
 
 private:
     Ui::MainWindow *ui;
     ArtifactController* m_controller; // Pointer to the controller
-    QStringListModel* m_artifactsModel; // Example model for QListView
+    std::unique_ptr<LiveView> m_liveView; // Current filter result, kept up to date by the controller's changes
+    ArtifactListModel* m_artifactsModel;  // Rows of m_liveView for the QListView
     
     // Filter UI components
     QComboBox* m_filterTypeComboBox;
@@ -50,15 +57,22 @@ private:
     QDateEdit* m_startDateEdit;
     QDateEdit* m_endDateEdit;
     QListWidget* m_activeFilters;
+    QListWidget* m_facets; // Counts per material, location and decade of the artifacts shown
+    FacetCounts m_facetCounts; // Behind m_facets, kept current by m_liveView
+    QTimer m_facetTimer;       // Redraws m_facets once per burst of row edits
+    QCompleter* m_filterCompleter;     // Type-ahead for the filter criteria
+    QStringListModel* m_suggestions;   // Its current completions, from the controller's tries
     std::unique_ptr<FilterStrategy> m_compositeFilter;  // Change from AndFilter to FilterStrategy
     
     void setupFilterUI();
     void populateArtifactsList();
+    ArtifactHandle handleForRow(int row) const;
     void populateFieldsFromArtifact(const ArcheologicalArtifact& artifact);
     void clearInputFields();
     ArcheologicalArtifact getArtifactFromFields() const; // Helper to get data from input fields
     void addActiveFilter(std::unique_ptr<FilterStrategy> filter, const QString& displayText);
     void applyCurrentFilter();
     void rebuildCompositeFilterFromUI(); // Add this helper method
+    void updateFacets();
 };
 #endif // MAINWINDOW_H
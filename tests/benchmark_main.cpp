@@ -0,0 +1,571 @@
+// Micro-benchmarks for the hot paths of the inventory.
+// Each section prints the old code path next to the new one.
+#include "../src/domain/artifact.h"
+#include "../src/domain/iso_date.h"
+#include "../src/repository/csv_repository.h"
+#include "../src/controller/artifact_controller.h"
+#include "../src/controller/filter.h"
+#include "../src/controller/filter_program.h"
+#include "../src/index/substring_search.h"
+#include "../src/index/minhash_index.h"
+#include <QDate>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRegularExpression>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const char* kMaterials[] = {"Bronze", "Clay", "Iron", "Flint", "Gold", "Bone", "Glass", "Silver"};
+const char* kLocations[] = {"Rome", "Athens", "Sparta", "Carthage", "Troy", "Knossos", "Mycenae", "Delphi"};
+const char* kNames[] = {"Amphora", "Sword", "Spear", "Shield", "Coin", "Pot", "Ring", "Figurine"};
+
+// Deterministic pseudo-random artifacts so runs are comparable
+std::vector<ArcheologicalArtifact> makeArtifacts(int count) {
+    std::vector<ArcheologicalArtifact> artifacts;
+    artifacts.reserve(count);
+    quint32 seed = 12345;
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 8) & 0xFFFFFF; };
+    for (int i = 0; i < count; ++i) {
+        QString name = QString("%1 %2").arg(kNames[next() % 8]).arg(i);
+        QString description = QString("Excavated %1 fragment from layer %2 with catalogue note %3")
+                                  .arg(kMaterials[next() % 8]).arg(next() % 40).arg(next());
+        QDate date = QDate(1, 1, 1).addDays(next() % 700000);
+        GeoPoint coordinates((next() % 180000) / 1000.0 - 90.0, (next() % 360000) / 1000.0 - 180.0);
+        artifacts.emplace_back(QString("A%1").arg(i), name, description, kMaterials[next() % 8], date,
+                               kLocations[next() % 8], coordinates);
+    }
+    return artifacts;
+}
+
+void report(const char* label, qint64 nanos, int rows) {
+    double ms = nanos / 1e6;
+    double rowsPerSecond = nanos > 0 ? rows * 1e9 / nanos : 0.0;
+    std::printf("  %-44s %10.3f ms  %12.0f rows/s\n", label, ms, rowsPerSecond);
+}
+
+template <typename Fn>
+qint64 time(Fn&& fn) {
+    QElapsedTimer timer;
+    timer.start();
+    fn();
+    return timer.nsecsElapsed();
+}
+
+void benchmarkDates(const std::vector<ArcheologicalArtifact>& artifacts) {
+    std::printf("ISO date parse/format (%d dates)\n", static_cast<int>(artifacts.size()));
+    std::vector<QString> texts;
+    texts.reserve(artifacts.size());
+    for (const auto& artifact : artifacts) {
+        texts.push_back(artifact.getDiscoveryDate().toString(Qt::ISODate));
+    }
+
+    qint64 checksum = 0;
+    report("QDate::fromString", time([&] {
+        for (const auto& text : texts) checksum += QDate::fromString(text, Qt::ISODate).day();
+    }), static_cast<int>(texts.size()));
+    report("IsoDate::parse", time([&] {
+        for (const auto& text : texts) checksum += IsoDate::parse(text).day();
+    }), static_cast<int>(texts.size()));
+    report("QDate::toString", time([&] {
+        for (const auto& artifact : artifacts) checksum += artifact.getDiscoveryDate().toString(Qt::ISODate).size();
+    }), static_cast<int>(artifacts.size()));
+    report("IsoDate::format", time([&] {
+        for (const auto& artifact : artifacts) checksum += IsoDate::format(artifact.getDiscoveryDate()).size();
+    }), static_cast<int>(artifacts.size()));
+    std::printf("  (checksum %lld)\n", static_cast<long long>(checksum));
+}
+
+void benchmarkLoad(const QString& path, int rows) {
+    std::printf("CSV load (%d rows)\n", rows);
+    report("CsvRepository load", time([&] {
+        CsvRepository repo(path);
+    }), rows);
+}
+
+void benchmarkDateRange(const ArtifactController& controller, int rows) {
+    std::printf("Date range filter (%d rows)\n", rows);
+    QDate start(500, 1, 1);
+    QDate end(1200, 12, 31);
+    size_t before = 0;
+    size_t after = 0;
+    report("ArtifactFilter + DateRangeFilter", time([&] {
+        ArtifactFilter filter(std::make_unique<DateRangeFilter>(start, end));
+        before = filter.filter(controller.getAllArtifacts()).size();
+    }), rows);
+    report("filterArtifactsByDateRange (day column)", time([&] {
+        after = controller.filterArtifactsByDateRange(start, end).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu\n", before, after);
+    
+    // One year out of ~1900: the ordered date index answers this from a slice
+    QDate narrowStart(900, 1, 1);
+    QDate narrowEnd(900, 12, 31);
+    report("narrow range, ArtifactFilter", time([&] {
+        ArtifactFilter filter(std::make_unique<DateRangeFilter>(narrowStart, narrowEnd));
+        before = filter.filter(controller.getAllArtifacts()).size();
+    }), rows);
+    report("narrow range, filterArtifactsByDateRange", time([&] {
+        after = controller.filterArtifactsByDateRange(narrowStart, narrowEnd).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu\n", before, after);
+}
+
+std::unique_ptr<FilterStrategy> makeMixedFilter() {
+    auto either = std::make_unique<OrFilter>();
+    either->addFilter(std::make_unique<MaterialFilter>("bronze", false));
+    either->addFilter(std::make_unique<LocationFilter>("Rome", true));
+    auto both = std::make_unique<AndFilter>();
+    both->addFilter(std::make_unique<DateRangeFilter>(QDate(500, 1, 1), QDate(1200, 12, 31)));
+    both->addFilter(std::move(either));
+    return both;
+}
+
+void benchmarkBatch(const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Mixed AND/OR filter (%d rows)\n", rows);
+    std::unique_ptr<FilterStrategy> filter = makeMixedFilter();
+    size_t perRow = 0;
+    size_t compiled = 0;
+    size_t batched = 0;
+    report("FilterStrategy::matches per row", time([&] {
+        for (const auto& artifact : artifacts) perRow += filter->matches(artifact);
+    }), rows);
+    report("FilterProgram::matches per row", time([&] {
+        FilterProgram program = FilterProgram::compile(*filter);
+        for (const auto& artifact : artifacts) compiled += program.matches(artifact);
+    }), rows);
+    report("FilterStrategy::matchBatch", time([&] {
+        ArtifactBatch batch(artifacts);
+        batched = filter->matchBatch(batch).count();
+    }), rows);
+    std::printf("  matches: %zu / %zu / %zu\n", perRow, compiled, batched);
+}
+
+void benchmarkParallel(const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Description substring filter (%d rows)\n", rows);
+    size_t serialMatches = 0;
+    size_t parallelMatches = 0;
+    report("ArtifactFilter serial", time([&] {
+        ArtifactFilter filter(std::make_unique<DescriptionFilter>("note 12", false));
+        serialMatches = filter.filter(artifacts).size();
+    }), rows);
+    report("ArtifactFilter parallel", time([&] {
+        ArtifactFilter filter(std::make_unique<DescriptionFilter>("note 12", false), FilterExecution::Parallel);
+        parallelMatches = filter.filter(artifacts).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu\n", serialMatches, parallelMatches);
+}
+
+void benchmarkSubstring(const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Substring kernel (%s) vs QString::contains (%d rows)\n", SubstringSearch::kernelName(), rows);
+    struct Case {
+        const char* label;
+        const QString& (ArcheologicalArtifact::*text)() const;
+        const char* needle;
+        Qt::CaseSensitivity sensitivity;
+    };
+    const Case cases[] = {
+        {"name, case-sensitive", &ArcheologicalArtifact::getName, "Coin 7", Qt::CaseSensitive},
+        {"name, case-insensitive", &ArcheologicalArtifact::getName, "COIN 7", Qt::CaseInsensitive},
+        {"description, case-sensitive", &ArcheologicalArtifact::getDescription, "note 42", Qt::CaseSensitive},
+        {"description, case-insensitive", &ArcheologicalArtifact::getDescription, "NOTE 42", Qt::CaseInsensitive},
+    };
+    for (const Case& test : cases) {
+        std::printf(" %s\n", test.label);
+        const QString needle = test.needle;
+        size_t generic = 0;
+        size_t kernel = 0;
+        report("QString::contains", time([&] {
+            for (const auto& artifact : artifacts) {
+                generic += (artifact.*test.text)().contains(needle, test.sensitivity);
+            }
+        }), rows);
+        report("SubstringSearch", time([&] {
+            const SubstringSearch search(needle, test.sensitivity);
+            for (const auto& artifact : artifacts) {
+                kernel += search.contains((artifact.*test.text)());
+            }
+        }), rows);
+        std::printf("  matches: %zu / %zu\n", generic, kernel);
+    }
+}
+
+void benchmarkTrigram(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Name substring filter (%d rows)\n", rows);
+    size_t scanned = 0;
+    size_t indexed = 0;
+    report("ArtifactFilter scan", time([&] {
+        ArtifactFilter filter(std::make_unique<NameFilter>("ring 42", false));
+        scanned = filter.filter(artifacts).size();
+    }), rows);
+    report("filterArtifactsByName (trigram index)", time([&] {
+        indexed = controller.filterArtifactsByName("ring 42", false).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu\n", scanned, indexed);
+}
+
+void benchmarkFuzzy(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Approximate name filter (%d rows)\n", rows);
+    size_t scanned = 0;
+    size_t folded = 0;
+    size_t pruned = 0;
+    report("'amfora' within 2, ArtifactFilter scan", time([&] {
+        ArtifactFilter filter(std::make_unique<FuzzyNameFilter>("amfora", 2));
+        scanned = filter.filter(artifacts).size();
+    }), rows);
+    report("'amfora' within 2, folded column", time([&] {
+        folded = controller.filterArtifacts(std::make_unique<FuzzyNameFilter>("amfora", 2)).size();
+    }), rows);
+    report("'figurine 1234' within 1, trigram pruned", time([&] {
+        pruned = controller.filterArtifacts(std::make_unique<FuzzyNameFilter>("figurine 1234", 1)).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu, pruned: %zu\n", scanned, folded, pruned);
+}
+
+void benchmarkRegex(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    const QString pattern = "gold fragment from layer 3[0-9] with catalogue note 12";
+    std::printf("Case-insensitive description regex with literal runs (%d rows)\n", rows);
+    size_t scanned = 0;
+    size_t prefiltered = 0;
+    report("QRegularExpression per row", time([&] {
+        QRegularExpression expression(pattern, QRegularExpression::CaseInsensitiveOption);
+        scanned = 0;
+        for (const auto& artifact : artifacts) {
+            if (expression.match(artifact.getDescription()).hasMatch()) {
+                ++scanned;
+            }
+        }
+    }), rows);
+    report("RegexFilter (literal prefilter)", time([&] {
+        prefiltered = controller.filterArtifacts(
+            std::make_unique<RegexFilter>(ArtifactField::Description, pattern)).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu\n", scanned, prefiltered);
+}
+
+void benchmarkSpatial(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    const GeoPoint center(41.9, 12.5);
+    std::printf("Coordinates within 500 km, and the 20 nearest (%d rows)\n", rows);
+    size_t scanned = 0;
+    size_t indexed = 0;
+    size_t nearest = 0;
+    report("RadiusFilter, haversine per row", time([&] {
+        ArtifactFilter filter(std::make_unique<RadiusFilter>(center, 500.0));
+        scanned = filter.filter(artifacts).size();
+    }), rows);
+    report("filterArtifacts (R-tree)", time([&] {
+        indexed = controller.filterArtifacts(std::make_unique<RadiusFilter>(center, 500.0)).size();
+    }), rows);
+    report("nearestArtifacts, k = 20", time([&] {
+        nearest = controller.nearestArtifacts(center, 20).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu, nearest: %zu\n", scanned, indexed, nearest);
+}
+
+void benchmarkNearDuplicates(int rows) {
+    // Free-text entries over a skewed vocabulary, every 50th a copy of an earlier one with a
+    // word changed. The shared template of makeArtifacts() would make every pair look alike.
+    std::printf("Near-duplicate names and descriptions at 80%% (%d rows)\n", rows);
+    quint32 seed = 4242;
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 8) & 0xFFFF; };
+    auto word = [&next]() { return QString("w%1").arg(next() % 3000 * (next() % 3000) / 3000); };
+    std::vector<ArcheologicalArtifact> entries;
+    entries.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        QStringList description;
+        if (i % 50 == 49) {
+            description = entries[next() % i].getDescription().split(' ');
+            description[static_cast<qsizetype>(next() % description.size())] = word();
+        } else {
+            for (int w = 0; w < 16; ++w) {
+                description << word();
+            }
+        }
+        entries.emplace_back(QString("N%1").arg(i), "Find", description.join(' '), "Clay", QDate(1000, 1, 1), "Rome");
+        entries.back().setHandle(static_cast<ArtifactHandle>(i + 1));
+    }
+    const int sample = std::min(rows, 2000); // Comparing all pairs of every row would take hours
+    size_t compared = 0;
+    report("all pairs, exact Jaccard (first 2000 rows)", time([&] {
+        std::vector<std::vector<quint64>> shingles;
+        for (int i = 0; i < sample; ++i) {
+            shingles.push_back(MinHashIndex::shingles(ArtifactTable::nearDuplicateText(entries[i])));
+        }
+        compared = 0;
+        for (int i = 0; i < sample; ++i) {
+            for (int j = i + 1; j < sample; ++j) {
+                compared += MinHashIndex::jaccard(shingles[i], shingles[j]) >= 0.8;
+            }
+        }
+    }), sample);
+    ArtifactTable table;
+    table.rebuild(entries);
+    report("MinHash signatures and LSH buckets", time([&] { table.nearDuplicateIndex(); }), rows);
+    NearDuplicateReport found;
+    report("DuplicateDetector (LSH bands, all rows)", time([&] {
+        found = DuplicateDetector(table).detect(0.8);
+    }), rows);
+    std::printf("  pairs: %zu in the sample, %zu overall from %zu candidates\n", compared, found.pairs.size(),
+                found.candidatePairs);
+}
+
+void benchmarkFullText(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Description words 'bronze layer 12' (%d rows)\n", rows);
+    size_t scanned = 0;
+    size_t indexed = 0;
+    size_t ranked = 0;
+    report("DescriptionSearch, tokenizing each row", time([&] {
+        ArtifactFilter filter(std::make_unique<DescriptionSearch>("bronze layer 12"));
+        scanned = filter.filter(artifacts).size();
+    }), rows);
+    report("filterArtifacts (full-text index)", time([&] {
+        indexed = controller.filterArtifacts(std::make_unique<DescriptionSearch>("bronze layer 12")).size();
+    }), rows);
+    report("searchDescriptions, top 20 by BM25", time([&] {
+        ranked = controller.searchDescriptions("fragment layer 12", 20).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu, ranked: %zu\n", scanned, indexed, ranked);
+}
+
+void benchmarkTopK(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Material 'Bronze' sorted by name, first 50 (%d rows)\n", rows);
+    QueryOptions options;
+    options.sortKeys = {{ArtifactField::Name, SortDirection::Ascending}};
+    options.limit = 50;
+    QString copied;
+    QString partial;
+    QString cached;
+    report("filterArtifacts, then std::sort", time([&] {
+        std::vector<ArcheologicalArtifact> all =
+            controller.filterArtifacts(std::make_unique<MaterialFilter>("Bronze", true, TextMatch::Equals)).materialize();
+        std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) {
+            return a.getName().compare(b.getName(), Qt::CaseInsensitive) < 0;
+        });
+        copied = all.front().getName();
+    }), rows);
+    report("filterArtifacts with options (partial sort)", time([&] {
+        partial = controller.filterArtifacts(std::make_unique<MaterialFilter>("Bronze", true, TextMatch::Equals), options)[0].getName();
+    }), rows);
+    // The second request builds the order; later ones only read it
+    controller.filterArtifacts(std::make_unique<MaterialFilter>("Bronze", true, TextMatch::Equals), options);
+    report("filterArtifacts with options (cached order)", time([&] {
+        cached = controller.filterArtifacts(std::make_unique<MaterialFilter>("Bronze", true, TextMatch::Equals), options)[0].getName();
+    }), rows);
+    std::printf("  first: %s / %s / %s\n", copied.toStdString().c_str(), partial.toStdString().c_str(),
+                cached.toStdString().c_str());
+}
+
+void benchmarkAggregation(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Facets: material, location, decade and date range (%d rows)\n", rows);
+    size_t scanned = 0;
+    size_t serial = 0;
+    size_t parallel = 0;
+    report("one scan per facet", time([&] {
+        QHash<QString, size_t> materials;
+        QHash<QString, size_t> locations;
+        QHash<int, size_t> decades;
+        QDate earliest;
+        for (const auto& artifact : artifacts) {
+            ++materials[artifact.getMaterial()];
+        }
+        for (const auto& artifact : artifacts) {
+            ++locations[artifact.getLocation()];
+        }
+        for (const auto& artifact : artifacts) {
+            ++decades[artifact.getDiscoveryDate().year() / 10 * 10];
+        }
+        for (const auto& artifact : artifacts) {
+            if (!earliest.isValid() || artifact.getDiscoveryDate() < earliest) {
+                earliest = artifact.getDiscoveryDate();
+            }
+        }
+        scanned = static_cast<size_t>(materials.size() + locations.size() + decades.size());
+    }), rows);
+    report("aggregateArtifacts, serial", time([&] {
+        Aggregation summary = controller.aggregateArtifacts(nullptr, AggregationRequest(), FilterExecution::Serial);
+        serial = summary.counts(ArtifactField::Material).size() + summary.counts(ArtifactField::Location).size() +
+                 summary.dateCounts.size();
+    }), rows);
+    report("aggregateArtifacts, parallel", time([&] {
+        Aggregation summary = controller.aggregateArtifacts(nullptr);
+        parallel = summary.counts(ArtifactField::Material).size() + summary.counts(ArtifactField::Location).size() +
+                   summary.dateCounts.size();
+    }), rows);
+    std::printf("  groups: %zu / %zu / %zu\n", scanned, serial, parallel);
+}
+
+void benchmarkSuggestions(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    const int repeats = 1000;
+    std::printf("Top 10 name completions of 'amph', %d times (%d rows)\n", repeats, rows);
+    size_t scanned = 0;
+    size_t completed = 0;
+    report("count names with the prefix, then sort", time([&] {
+        QHash<QString, size_t> counts;
+        for (const auto& artifact : artifacts) {
+            if (artifact.getName().startsWith("amph", Qt::CaseInsensitive)) {
+                ++counts[artifact.getName()];
+            }
+        }
+        std::vector<std::pair<size_t, QString>> ranked;
+        for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+            ranked.emplace_back(it.value(), it.key());
+        }
+        std::partial_sort(ranked.begin(), ranked.begin() + std::min<size_t>(10, ranked.size()), ranked.end(),
+                          [](const auto& a, const auto& b) { return a.first > b.first; });
+        scanned = std::min<size_t>(10, ranked.size());
+    }), rows);
+    report("suggestValues (radix trie), per call", time([&] {
+        for (int i = 0; i < repeats; ++i) {
+            completed = static_cast<size_t>(controller.suggestValues(ArtifactField::Name, "amph").size());
+        }
+    }) / repeats, rows);
+    std::printf("  completions: %zu / %zu\n", scanned, completed);
+}
+
+void benchmarkBitmapIndex(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("Material equality OR, location equality AND (%d rows)\n", rows);
+    auto makeFilter = [] {
+        auto materials = std::make_unique<OrFilter>();
+        materials->addFilter(std::make_unique<MaterialFilter>("Bronze", true, TextMatch::Equals));
+        materials->addFilter(std::make_unique<MaterialFilter>("Gold", true, TextMatch::Equals));
+        auto both = std::make_unique<AndFilter>();
+        both->addFilter(std::move(materials));
+        both->addFilter(std::make_unique<LocationFilter>("Rome", true, TextMatch::Equals));
+        return both;
+    };
+    size_t scanned = 0;
+    size_t indexed = 0;
+    size_t counted = 0;
+    report("ArtifactFilter scan", time([&] {
+        ArtifactFilter filter(makeFilter());
+        scanned = filter.filter(artifacts).size();
+    }), rows);
+    report("filterArtifacts (value bitmaps)", time([&] {
+        indexed = controller.filterArtifacts(makeFilter()).size();
+    }), rows);
+    report("countArtifacts (value bitmaps)", time([&] {
+        counted = controller.countArtifacts(makeFilter());
+    }), rows);
+    std::printf("  matches: %zu / %zu / %zu\n", scanned, indexed, counted);
+}
+
+void benchmarkPlanner(const ArtifactController& controller, const std::vector<ArcheologicalArtifact>& artifacts) {
+    const int rows = static_cast<int>(artifacts.size());
+    std::printf("AND added costliest first: description, name, location (%d rows)\n", rows);
+    auto makeFilter = [] {
+        auto filter = std::make_unique<AndFilter>();
+        filter->addFilter(std::make_unique<DescriptionFilter>("layer 1"));
+        filter->addFilter(std::make_unique<NameFilter>("Sword"));
+        filter->addFilter(std::make_unique<LocationFilter>("Troy", true, TextMatch::Equals));
+        return filter;
+    };
+    size_t inOrder = 0;
+    size_t planned = 0;
+    report("matchBatch in user order", time([&] {
+        inOrder = makeFilter()->matchBatch(ArtifactBatch(artifacts)).count();
+    }), rows);
+    report("filterArtifacts (planned)", time([&] {
+        planned = controller.filterArtifacts(makeFilter()).size();
+    }), rows);
+    std::printf("  matches: %zu / %zu\n", inOrder, planned);
+    
+    // The same tree again, and once more with its children swapped and the case changed
+    auto swapped = [] {
+        auto filter = std::make_unique<AndFilter>();
+        filter->addFilter(std::make_unique<LocationFilter>("Troy", true, TextMatch::Equals));
+        filter->addFilter(std::make_unique<NameFilter>("SWORD"));
+        filter->addFilter(std::make_unique<DescriptionFilter>("Layer 1"));
+        return filter;
+    };
+    report("filterArtifacts (result cache)", time([&] {
+        planned = controller.filterArtifacts(makeFilter()).size();
+    }), rows);
+    report("filterArtifacts (canonical hit)", time([&] {
+        planned = controller.filterArtifacts(swapped()).size();
+    }), rows);
+    std::printf("  matches: %zu\n%s\n", planned, controller.explainFilter(*swapped()).toStdString().c_str());
+}
+
+void benchmarkFolded(ArtifactController& controller, int rows) {
+    std::printf("Case-insensitive description filter (%d rows)\n", rows);
+    // Different needles of the same shape, so the result cache cannot answer the second run
+    size_t folded = 0;
+    size_t unfolded = 0;
+    report("filterArtifacts (folded columns)", time([&] {
+        folded = controller.filterArtifacts(std::make_unique<DescriptionFilter>("LAYER 12 WITH")).size();
+    }), rows);
+    size_t bytes = controller.foldedColumnBytes();
+    controller.setFoldedFields(0);
+    report("filterArtifacts (case-insensitive compare)", time([&] {
+        unfolded = controller.filterArtifacts(std::make_unique<DescriptionFilter>("LAYER 13 WITH")).size();
+    }), rows);
+    controller.setFoldedFields(ArtifactTable::DefaultFoldedFields);
+    std::printf("  matches: %zu / %zu, folded columns: %.1f MiB\n", folded, unfolded, bytes / 1048576.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? std::atoi(argv[1]) : 200000;
+    std::vector<ArcheologicalArtifact> artifacts = makeArtifacts(rows);
+
+    QTemporaryFile file;
+    if (!file.open()) {
+        std::fprintf(stderr, "Cannot create temporary file\n");
+        return 1;
+    }
+    QString path = file.fileName();
+    file.close();
+    {
+        // Write the file directly; adding through a repository would rewrite it once per row
+        QFile out(path);
+        out.open(QIODevice::WriteOnly | QIODevice::Text);
+        QTextStream stream(&out);
+        stream << "ID,Name,Description,Material,DiscoveryDate,Location,Coordinates\n";
+        for (const auto& artifact : artifacts) {
+            stream << artifact.getId() << ',' << artifact.getName() << ',' << artifact.getDescription() << ','
+                   << artifact.getMaterial() << ',' << artifact.getDiscoveryDate().toString(Qt::ISODate) << ','
+                   << artifact.getLocation() << ",\"" << artifact.getCoordinates().toString() << "\"\n";
+        }
+    }
+
+    benchmarkDates(artifacts);
+    benchmarkLoad(path, rows);
+    benchmarkBatch(artifacts);
+    benchmarkParallel(artifacts);
+    benchmarkSubstring(artifacts);
+
+    ArtifactController controller(std::make_unique<CsvRepository>(path));
+    benchmarkDateRange(controller, rows);
+    benchmarkTrigram(controller, artifacts);
+    benchmarkFuzzy(controller, artifacts);
+    benchmarkRegex(controller, artifacts);
+    benchmarkSpatial(controller, artifacts);
+    benchmarkNearDuplicates(rows);
+    benchmarkFullText(controller, artifacts);
+    benchmarkTopK(controller, artifacts);
+    benchmarkAggregation(controller, artifacts);
+    benchmarkSuggestions(controller, artifacts);
+    benchmarkBitmapIndex(controller, artifacts);
+    benchmarkPlanner(controller, artifacts);
+    benchmarkFolded(controller, rows);
+    return 0;
+}
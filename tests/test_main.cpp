@@ -2,10 +2,28 @@
 #include "../src/domain/artifact.h"
 #include "../src/repository/csv_repository.h"
 #include "../src/repository/json_repository.h"
+#include "../src/repository/artifact_codec.h"
+#include "../src/domain/iso_date.h"
 #include "../src/controller/artifact_controller.h"
 #include "../src/controller/filter.h"
+#include "../src/controller/filter_program.h"
+#include "../src/controller/query_planner.h"
+#include "../src/controller/live_view.h"
+#include "../src/controller/aggregation_engine.h"
+#include "../src/controller/facet_counts.h"
+#include "../src/index/trigram_index.h"
+#include "../src/index/date_index.h"
+#include "../src/index/roaring_bitmap.h"
+#include "../src/index/table_statistics.h"
+#include "../src/index/substring_search.h"
+#include "../src/index/radix_trie.h"
+#include "../src/index/regex_search.h"
+#include "../src/index/rtree.h"
+#include "../src/index/minhash_index.h"
 #include <QDate>
 #include <QTemporaryFile>
+#include <algorithm>
+#include <map>
 #include <memory>
 
 // Test fixture for Artifact tests
@@ -38,6 +56,88 @@ TEST_F(ArtifactTest, TestArtifactSetters) {
     EXPECT_EQ(artifact.getMaterial(), "Iron");
 }
 
+// Test that the schema-generated codecs round-trip every field
+TEST_F(ArtifactTest, TestSchemaCodecs) {
+    EXPECT_EQ(ArtifactCodec::csvHeader(), "ID,Name,Description,Material,DiscoveryDate,Location,Coordinates");
+    
+    ArcheologicalArtifact fromJson = ArtifactCodec::decodeJson(ArtifactCodec::encodeJson(artifact));
+    EXPECT_EQ(fromJson.differingFields(artifact), 0u);
+    EXPECT_FALSE(fromJson.isDirty());
+    
+    QByteArray buffer;
+    {
+        QDataStream out(&buffer, QIODevice::WriteOnly);
+        ArtifactCodec::encodeBinary(out, artifact);
+    }
+    QDataStream in(buffer);
+    ArcheologicalArtifact fromBinary;
+    EXPECT_TRUE(ArtifactCodec::decodeBinary(in, fromBinary));
+    EXPECT_EQ(fromBinary.differingFields(artifact), 0u);
+    
+    // Generic field access goes through the same table
+    EXPECT_EQ(artifact.getField(ArtifactField::DiscoveryDate).toDate(), QDate(2023, 5, 15));
+    artifact.setField(ArtifactField::Location, QString("Other Site"));
+    EXPECT_EQ(artifact.getLocation(), "Other Site");
+}
+
+// Test the optional coordinates field and its codecs
+TEST_F(ArtifactTest, TestCoordinates) {
+    EXPECT_FALSE(artifact.getCoordinates().isValid());
+    EXPECT_FALSE(GeoPoint(91.0, 0.0).isValid());
+    EXPECT_FALSE(GeoPoint(0.0, -180.5).isValid());
+    EXPECT_EQ(GeoPoint::fromString("41.8902, 12.4922"), GeoPoint(41.8902, 12.4922));
+    EXPECT_EQ(GeoPoint::fromString(GeoPoint(-33.1, 0.1).toString()), GeoPoint(-33.1, 0.1));
+    EXPECT_FALSE(GeoPoint::fromString("41.89").isValid());
+    EXPECT_TRUE(GeoPoint().toString().isEmpty());
+    EXPECT_NEAR(GeoPoint(48.8566, 2.3522).distanceKm(GeoPoint(51.5074, -0.1278)), 343.6, 0.5); // Paris to London
+    EXPECT_NEAR(GeoPoint(0.0, 179.5).distanceKm(GeoPoint(0.0, -179.5)), 111.2, 0.1);
+    EXPECT_TRUE(GeoBox(-10.0, 170.0, 10.0, -170.0).contains(GeoPoint(0.0, -175.0)));
+    EXPECT_FALSE(GeoBox(-10.0, 170.0, 10.0, -170.0).contains(GeoPoint(0.0, 0.0)));
+    
+    // Rows written before the column existed still load, without coordinates
+    auto identity = [](const QString& text) { return text; };
+    ArcheologicalArtifact fromCsv;
+    std::vector<QString> columns = {"OLD1", "Lamp", "Oil lamp", "Clay", "1999-04-02", "Ostia"};
+    EXPECT_TRUE(ArtifactCodec::decodeCsv(columns, fromCsv, identity));
+    EXPECT_EQ(fromCsv.getLocation(), "Ostia");
+    EXPECT_FALSE(fromCsv.getCoordinates().isValid());
+    columns.pop_back();
+    EXPECT_FALSE(ArtifactCodec::decodeCsv(columns, fromCsv, identity));
+    
+    artifact.setCoordinates(GeoPoint(37.9715, 23.7257));
+    EXPECT_EQ(artifact.dirtyFields() & fieldBit(ArtifactField::Coordinates), fieldBit(ArtifactField::Coordinates));
+    EXPECT_TRUE(ArtifactCodec::encodeCsv(artifact, identity).endsWith(",Test Site,37.9715,23.7257"));
+    columns = {"NEW1", "Stele", "", "Marble", "2001-01-01", "Athens", "37.9715,23.7257"};
+    EXPECT_TRUE(ArtifactCodec::decodeCsv(columns, fromCsv, identity));
+    EXPECT_EQ(fromCsv.getCoordinates(), artifact.getCoordinates());
+    EXPECT_EQ(ArtifactCodec::decodeJson(ArtifactCodec::encodeJson(artifact)).getCoordinates(), artifact.getCoordinates());
+    QByteArray buffer;
+    {
+        QDataStream out(&buffer, QIODevice::WriteOnly);
+        ArtifactCodec::encodeBinary(out, artifact);
+    }
+    QDataStream in(buffer);
+    ArcheologicalArtifact fromBinary;
+    EXPECT_TRUE(ArtifactCodec::decodeBinary(in, fromBinary));
+    EXPECT_EQ(fromBinary.differingFields(artifact), 0u);
+    
+    artifact.setField(ArtifactField::Coordinates, QVariant::fromValue(GeoPoint(1.5, 2.5)));
+    EXPECT_EQ(artifact.getField(ArtifactField::Coordinates).value<GeoPoint>(), GeoPoint(1.5, 2.5));
+}
+
+// Test the hand-rolled ISO date parser and formatter against QDate
+TEST_F(ArtifactTest, TestIsoDate) {
+    EXPECT_EQ(IsoDate::parse(QString("2023-05-15")), QDate(2023, 5, 15));
+    EXPECT_EQ(IsoDate::parse(QString("0800-03-10")), QDate(800, 3, 10));
+    EXPECT_FALSE(IsoDate::parse(QString("2023-02-30")).isValid());
+    EXPECT_FALSE(IsoDate::parse(QString("not a date")).isValid());
+    EXPECT_FALSE(IsoDate::parse(QString()).isValid());
+    
+    EXPECT_EQ(IsoDate::format(QDate(800, 3, 10)), QDate(800, 3, 10).toString(Qt::ISODate));
+    EXPECT_EQ(IsoDate::format(QDate(2023, 12, 1)), "2023-12-01");
+    EXPECT_TRUE(IsoDate::format(QDate()).isEmpty());
+}
+
 // Test fixture for Repository tests
 class RepositoryTest : public ::testing::Test {
 protected:
@@ -132,6 +232,87 @@ TEST_F(RepositoryTest, TestJsonRepository) {
     }
 }
 
+// Test that repository handles are stable and map both ways
+TEST_F(RepositoryTest, TestArtifactHandles) {
+    QTemporaryFile tempFile;
+    ASSERT_TRUE(tempFile.open());
+    QString tempPath = tempFile.fileName();
+    tempFile.close();
+    
+    CsvRepository repo(tempPath);
+    repo.addArtifact(artifact1);
+    repo.addArtifact(artifact2);
+    
+    ArtifactHandle handle1 = repo.handleForId("ID001");
+    ArtifactHandle handle2 = repo.handleForId("ID002");
+    EXPECT_NE(handle1, InvalidArtifactHandle);
+    EXPECT_NE(handle1, handle2);
+    EXPECT_EQ(repo.idForHandle(handle2), "ID002");
+    EXPECT_EQ(repo.findArtifactByHandle(handle1).getName(), artifact1.getName());
+    EXPECT_EQ(repo.findArtifactById("ID001").getHandle(), handle1);
+    EXPECT_EQ(repo.handleForId("missing"), InvalidArtifactHandle);
+    
+    // Removing and re-adding keeps the handle; updates never change it
+    repo.removeArtifact("ID001");
+    EXPECT_THROW(repo.findArtifactByHandle(handle1), std::runtime_error);
+    repo.addArtifact(artifact1);
+    EXPECT_EQ(repo.handleForId("ID001"), handle1);
+    repo.updateArtifact(artifact2);
+    EXPECT_EQ(repo.findArtifactById("ID002").getHandle(), handle2);
+}
+
+// Records every change set a repository emits
+class RecordingObserver : public RepositoryObserver {
+public:
+    void onArtifactChanged(const ArtifactChangeSet& change) override { changes.push_back(change); }
+    std::vector<ArtifactChangeSet> changes;
+};
+
+// Test field-level change sets and dirty flags
+TEST_F(RepositoryTest, TestChangeSets) {
+    QTemporaryFile tempFile;
+    ASSERT_TRUE(tempFile.open());
+    QString tempPath = tempFile.fileName();
+    tempFile.close();
+    
+    CsvRepository repo(tempPath);
+    RecordingObserver observer;
+    repo.addObserver(&observer);
+    
+    repo.addArtifact(artifact1);
+    ASSERT_EQ(observer.changes.size(), 1);
+    EXPECT_EQ(observer.changes[0].kind(), ArtifactChangeSet::Kind::Added);
+    EXPECT_EQ(observer.changes[0].newValue(ArtifactField::Name).toString(), "Pottery Shard");
+    
+    // Only the touched field ends up in the change set
+    ArcheologicalArtifact stored = repo.findArtifactById("ID001");
+    EXPECT_FALSE(stored.isDirty());
+    stored.setMaterial("Terracotta");
+    EXPECT_EQ(stored.dirtyFields(), fieldBit(ArtifactField::Material));
+    repo.updateArtifact(stored);
+    ASSERT_EQ(observer.changes.size(), 2);
+    const ArtifactChangeSet& update = observer.changes[1];
+    EXPECT_EQ(update.kind(), ArtifactChangeSet::Kind::Updated);
+    EXPECT_EQ(update.fields(), fieldBit(ArtifactField::Material));
+    EXPECT_EQ(update.oldValue(ArtifactField::Material).toString(), "Clay");
+    EXPECT_EQ(update.newValue(ArtifactField::Material).toString(), "Terracotta");
+    
+    // Reverting the delta restores the original record
+    ArcheologicalArtifact reverted = repo.findArtifactById("ID001");
+    update.revert(reverted);
+    EXPECT_EQ(reverted.getMaterial(), "Clay");
+    
+    // An update that changes nothing emits nothing
+    repo.updateArtifact(repo.findArtifactById("ID001"));
+    EXPECT_EQ(observer.changes.size(), 2);
+    
+    repo.removeArtifact("ID001");
+    ASSERT_EQ(observer.changes.size(), 3);
+    EXPECT_EQ(observer.changes[2].kind(), ArtifactChangeSet::Kind::Removed);
+    EXPECT_EQ(observer.changes[2].oldValue(ArtifactField::Id).toString(), "ID001");
+    repo.removeObserver(&observer);
+}
+
 // Test fixture for Filter tests
 class FilterTest : public ::testing::Test {
 protected:
@@ -235,6 +416,213 @@ TEST_F(FilterTest, TestOrFilter) {
     }
 }
 
+// Test that a compiled program agrees with the tree it was compiled from
+TEST_F(FilterTest, TestFilterProgram) {
+    auto bronzeOrIron = std::make_unique<OrFilter>();
+    bronzeOrIron->addFilter(std::make_unique<MaterialFilter>("Bronze", false));
+    bronzeOrIron->addFilter(std::make_unique<NameFilter>("iron", false));
+    
+    AndFilter tree;
+    tree.addFilter(std::move(bronzeOrIron));
+    tree.addFilter(std::make_unique<DateRangeFilter>(QDate(1000, 1, 1), QDate(1400, 12, 31)));
+    
+    FilterProgram program = FilterProgram::compile(tree);
+    EXPECT_FALSE(program.isConstant());
+    EXPECT_EQ(program.instructionCount(), 3);
+    for (const auto& artifact : artifacts) {
+        EXPECT_EQ(program.matches(artifact), tree.matches(artifact)) << artifact.getId().toStdString();
+    }
+    
+    // Empty composites and empty needles fold away
+    AndFilter emptyAnd;
+    FilterProgram rejectAll = FilterProgram::compile(emptyAnd);
+    EXPECT_TRUE(rejectAll.isConstant());
+    EXPECT_FALSE(rejectAll.matches(artifacts[0]));
+    
+    OrFilter withEmptyName;
+    withEmptyName.addFilter(std::make_unique<MaterialFilter>("Gold", true));
+    withEmptyName.addFilter(std::make_unique<NameFilter>("", false));
+    FilterProgram acceptAll = FilterProgram::compile(withEmptyName);
+    EXPECT_TRUE(acceptAll.isConstant());
+    EXPECT_TRUE(acceptAll.matches(artifacts[2]));
+}
+
+// Test that batch evaluation sets exactly the rows matches() accepts
+TEST_F(FilterTest, TestMatchBatch) {
+    auto romeOrClay = std::make_unique<OrFilter>();
+    romeOrClay->addFilter(std::make_unique<LocationFilter>("rome", false));
+    romeOrClay->addFilter(std::make_unique<MaterialFilter>("Clay", true));
+    
+    AndFilter tree;
+    tree.addFilter(std::move(romeOrClay));
+    tree.addFilter(std::make_unique<DateRangeFilter>(QDate(1100, 1, 1), QDate(1600, 1, 1)));
+    
+    ArtifactBatch batch(artifacts);
+    RowBitmap rows = tree.matchBatch(batch);
+    ASSERT_EQ(rows.size(), artifacts.size());
+    for (size_t row = 0; row < artifacts.size(); ++row) {
+        EXPECT_EQ(rows.test(row), tree.matches(artifacts[row])) << row;
+    }
+    EXPECT_EQ(rows.count(), 3); // Bronze Sword, Clay Pot, Bronze Shield
+    
+    EXPECT_TRUE(AndFilter().matchBatch(batch).none());
+    EXPECT_TRUE(OrFilter().matchBatch(batch).none());
+}
+
+// Test that parallel filtering returns the serial result in the same order
+TEST_F(FilterTest, TestParallelFilter) {
+    std::vector<ArcheologicalArtifact> many;
+    for (int i = 0; i < 5000; ++i) {
+        const auto& base = artifacts[i % artifacts.size()];
+        many.emplace_back(QString("P%1").arg(i), base.getName(), QString("Layer %1").arg(i % 7),
+                          base.getMaterial(), base.getDiscoveryDate().addDays(i), base.getLocation());
+    }
+    
+    auto makeFilter = []() {
+        auto filter = std::make_unique<OrFilter>();
+        filter->addFilter(std::make_unique<MaterialFilter>("bronze", false));
+        filter->addFilter(std::make_unique<IdFilter>("7", true));
+        return filter;
+    };
+    
+    ArtifactFilter serial(makeFilter());
+    ArtifactFilter parallel(makeFilter(), FilterExecution::Parallel);
+    parallel.setParallelThreshold(1);
+    
+    auto expected = serial.filter(many);
+    auto actual = parallel.filter(many);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(actual[i].getId(), expected[i].getId());
+    }
+    
+    // A zero threshold still leaves empty input to the serial path
+    parallel.setParallelThreshold(0);
+    EXPECT_TRUE(parallel.filter(std::vector<ArcheologicalArtifact>()).empty());
+}
+
+TEST_F(FilterTest, TestSubstringSearch) {
+    // Needles at every offset of texts long enough for the vector loops and their scalar tails
+    QString text = "Bronze amphora with painted rim, found by the KILN gate in layer 12";
+    for (int length : {1, 2, 3, 7, 17}) {
+        for (int start = 0; start + length <= text.size(); start += 3) {
+            QString needle = text.mid(start, length);
+            EXPECT_TRUE(SubstringSearch(needle).contains(text)) << needle.toStdString();
+            EXPECT_TRUE(SubstringSearch(needle.toUpper(), Qt::CaseInsensitive).contains(text));
+            EXPECT_FALSE(SubstringSearch(needle + "#").contains(text));
+        }
+    }
+    EXPECT_FALSE(SubstringSearch("kiln").contains(text));
+    EXPECT_TRUE(SubstringSearch("kiln", Qt::CaseInsensitive).contains(text));
+    EXPECT_TRUE(SubstringSearch("").contains(""));
+    EXPECT_FALSE(SubstringSearch("longer than the text").contains("short"));
+    
+    // Non-ASCII text and needles agree with QString::contains
+    for (const QString& other : {QString("Café Gate"), QString("ÉCOLE"), QString("plain")}) {
+        for (const QString& needle : {QString("é"), QString("CAFÉ"), QString("gate"), QString("École")}) {
+            EXPECT_EQ(SubstringSearch(needle, Qt::CaseInsensitive).contains(other),
+                      other.contains(needle, Qt::CaseInsensitive));
+            EXPECT_EQ(SubstringSearch(needle).contains(other), other.contains(needle));
+        }
+    }
+}
+
+TEST_F(FilterTest, TestRegexFilter) {
+    // Only characters every match must contain become literals
+    EXPECT_EQ(RegexSearch::requiredLiterals("bronze (sword|spear)s?"), QStringList({"bronze "}));
+    EXPECT_EQ(RegexSearch::requiredLiterals("^layer \\d+ of [A-Z]+ gate$"), QStringList({"layer ", " of ", " gate"}));
+    EXPECT_EQ(RegexSearch::requiredLiterals("amphorae?\\.x{2}y{0,3}z+"), QStringList({"amphora", ".x", "z"}));
+    EXPECT_EQ(RegexSearch::requiredLiterals("\\x41bc\\k<n>ame\\Qa.b\\E"), QStringList({"bc", "amea.b"}));
+    // {,n} is {0,n} to recent PCRE2; braces read differently by other versions keep no literals
+    EXPECT_EQ(RegexSearch::requiredLiterals("ab{,2}c"), QStringList({"a", "c"}));
+    EXPECT_EQ(RegexSearch::requiredLiterals("ab{ 1,2}c{x"), QStringList({"a"}));
+    EXPECT_TRUE(RegexSearch::requiredLiterals("ab{x|y}").isEmpty()); // The alternation still counts
+    EXPECT_EQ(RegexSearch::requiredLiterals("xa{(b}c)?"), QStringList({"x"}));
+    EXPECT_TRUE(RegexSearch::requiredLiterals("sword|spear").isEmpty());
+    EXPECT_TRUE(RegexSearch::requiredLiterals("(?x) s w o r d").isEmpty());
+    EXPECT_EQ(RegexSearch("x{2}yy|z").literals(), QStringList());
+    EXPECT_EQ(RegexSearch("ab.(c)abcd").literals(), QStringList({"abcd", "ab"})); // Longest first
+    
+    // Over plain artifacts and over a table, with and without the trigram index, matches agree
+    for (size_t i = 0; i < artifacts.size(); ++i) {
+        artifacts[i].setHandle(static_cast<ArtifactHandle>(i)); // The table indexes by handle
+    }
+    ArtifactTable table;
+    table.rebuild(artifacts);
+    for (const QString& pattern : {QString("^bronze s"), QString("(pot|spear)$"), QString("on\\b"), QString("o.*e")}) {
+        RegexFilter filter(ArtifactField::Name, pattern);
+        QRegularExpression regex(pattern, QRegularExpression::CaseInsensitiveOption);
+        QStringList expected;
+        for (const auto& artifact : artifacts) {
+            if (regex.match(artifact.getName()).hasMatch()) {
+                expected << artifact.getId();
+            }
+            EXPECT_EQ(filter.matches(artifact), regex.match(artifact.getName()).hasMatch());
+        }
+        QStringList scanned;
+        QStringList indexed;
+        filter.matchBatch(ArtifactBatch(artifacts)).forEachSetBit([&](size_t row) { scanned << artifacts[row].getId(); });
+        filter.matchBatch(ArtifactBatch(table)).forEachSetBit([&](size_t row) { indexed << table.artifact(row).getId(); });
+        EXPECT_EQ(scanned, expected) << pattern.toStdString();
+        EXPECT_EQ(indexed, expected) << pattern.toStdString();
+    }
+    EXPECT_EQ(ArtifactFilter(std::make_unique<RegexFilter>(ArtifactField::Description, "weapon$", true)).filter(artifacts).size(), 2u);
+    EXPECT_TRUE(ArtifactFilter(std::make_unique<RegexFilter>(ArtifactField::Material, "^IRON", true)).filter(artifacts).empty());
+    ArcheologicalArtifact braces;
+    braces.setName("y}");
+    EXPECT_TRUE(RegexFilter(ArtifactField::Name, "ab{x|y}").matches(braces)); // ab{x or y}
+    EXPECT_THROW(RegexFilter(ArtifactField::Name, "bronze ("), std::invalid_argument);
+    EXPECT_THROW(RegexFilter(ArtifactField::DiscoveryDate, "1500"), std::invalid_argument);
+    EXPECT_TRUE(QueryPlanner(table).plan(RegexFilter(ArtifactField::Name, "sw.rd")).explain().contains("name imatches /sw.rd/"));
+}
+
+TEST_F(FilterTest, TestSpatialFilters) {
+    // Spread points over the globe, including both sides of the antimeridian
+    std::vector<ArcheologicalArtifact> sites;
+    for (int i = 0; i < 400; ++i) {
+        ArcheologicalArtifact site(QString("G%1").arg(i), "Site", "", "Stone", QDate(1000, 1, 1), "Field");
+        if (i % 7 != 0) { // Some artifacts have no coordinates
+            site.setCoordinates(GeoPoint((i * 37 % 179) - 89.0, (i * 71 % 359) - 179.0));
+        }
+        site.setHandle(static_cast<ArtifactHandle>(i));
+        sites.push_back(site);
+    }
+    ArtifactTable table;
+    table.rebuild(sites);
+    EXPECT_EQ(table.spatialIndex().size(), 342u);
+    
+    auto compare = [&](const FilterStrategy& filter) {
+        QStringList expected;
+        QStringList scanned;
+        QStringList indexed;
+        for (const auto& site : sites) {
+            if (filter.matches(site)) {
+                expected << site.getId();
+            }
+        }
+        filter.matchBatch(ArtifactBatch(sites)).forEachSetBit([&](size_t row) { scanned << sites[row].getId(); });
+        filter.matchBatch(ArtifactBatch(table)).forEachSetBit([&](size_t row) { indexed << table.artifact(row).getId(); });
+        EXPECT_FALSE(expected.isEmpty());
+        EXPECT_EQ(scanned, expected);
+        EXPECT_EQ(indexed, expected);
+    };
+    compare(BoundingBoxFilter(GeoBox(-30.0, -60.0, 45.0, 90.0)));
+    compare(BoundingBoxFilter(GeoBox(-60.0, 150.0, 60.0, -150.0))); // Crosses the antimeridian
+    compare(RadiusFilter(GeoPoint(10.0, 175.0), 2500.0));
+    compare(RadiusFilter(GeoPoint(89.0, 0.0), 1500.0));
+    
+    ArcheologicalArtifact nearby;
+    nearby.setCoordinates(GeoPoint(0.0, -179.9));
+    EXPECT_TRUE(RadiusFilter(GeoPoint(0.0, 179.9), 25.0).matches(nearby));
+    EXPECT_FALSE(RadiusFilter(GeoPoint(0.0, 179.9), 20.0).matches(nearby));
+    EXPECT_FALSE(BoundingBoxFilter(GeoBox(-90.0, -180.0, 90.0, 180.0)).matches(artifacts[0]));
+    EXPECT_THROW(BoundingBoxFilter(GeoBox(10.0, 0.0, -10.0, 5.0)), std::invalid_argument);
+    EXPECT_THROW(RadiusFilter(GeoPoint(), 10.0), std::invalid_argument);
+    EXPECT_THROW(RadiusFilter(GeoPoint(0.0, 0.0), -1.0), std::invalid_argument);
+    EXPECT_TRUE(QueryPlanner(table).plan(RadiusFilter(GeoPoint(41.9, 12.5), 25.0)).explain()
+                    .contains("coordinates within 25 km of (41.9, 12.5)"));
+}
+
 // Test fixture for Controller tests
 class ControllerTest : public ::testing::Test {
 protected:
@@ -345,9 +733,921 @@ TEST_F(ControllerTest, TestControllerFiltering) {
     auto locationFiltered = controller->filterArtifactsByLocation("Location 2", false);
     EXPECT_EQ(locationFiltered.size(), 1);
     EXPECT_EQ(locationFiltered[0].getId(), "ID002");
+    
+    // Test date range filtering, which scans the controller's day column
+    auto dateFiltered = controller->filterArtifactsByDateRange(QDate(2023, 2, 1), QDate(2023, 12, 31));
+    ASSERT_EQ(dateFiltered.size(), 1);
+    EXPECT_EQ(dateFiltered[0].getId(), "ID002");
+    
+    // The column follows updates and removals made through the controller
+    controller->updateArtifact("ID001", "ID001", artifact1.getName(), artifact1.getDescription(),
+                               artifact1.getMaterial(), QDate(2023, 6, 1), artifact1.getLocation());
+    EXPECT_EQ(controller->filterArtifactsByDateRange(QDate(2023, 2, 1), QDate(2023, 12, 31)).size(), 2);
+    controller->removeArtifact("ID002");
+    dateFiltered = controller->filterArtifactsByDateRange(QDate(2023, 2, 1), QDate(2023, 12, 31));
+    ASSERT_EQ(dateFiltered.size(), 1);
+    EXPECT_EQ(dateFiltered[0].getId(), "ID001");
 }
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
+
+// Test that the trigram indexes follow add/update/remove and still give exact results
+TEST_F(ControllerTest, TestTrigramIndexedFiltering) {
+    TrigramIndex index;
+    index.insert(1, "Bronze Sword");
+    index.insert(2, "Iron Sword");
+    index.insert(3, "Bronze Shield");
+    EXPECT_EQ(index.candidates("sWoRd"), (std::vector<ArtifactHandle>{1, 2}));
+    EXPECT_EQ(index.candidates("bronze s"), (std::vector<ArtifactHandle>{1, 3}));
+    EXPECT_TRUE(index.candidates("gold").empty());
+    index.remove(2, "Iron Sword");
+    EXPECT_EQ(index.candidates("sword"), (std::vector<ArtifactHandle>{1}));
+    EXPECT_FALSE(TrigramIndex::canServe("ir"));
+    
+    controller->addArtifact(artifact1.getId(), artifact1.getName(), artifact1.getDescription(),
+                            artifact1.getMaterial(), artifact1.getDiscoveryDate(), artifact1.getLocation());
+    controller->addArtifact(artifact2.getId(), artifact2.getName(), artifact2.getDescription(),
+                            artifact2.getMaterial(), artifact2.getDiscoveryDate(), artifact2.getLocation());
+    controller->addArtifact("ID003", "Votive Figurine", "Clay figure", "Terracotta", QDate(2023, 3, 1), "Delphi");
+    
+    EXPECT_EQ(controller->filterArtifactsByName("artifact", false).size(), 2);
+    EXPECT_EQ(controller->filterArtifactsByName("Artifact", true).size(), 2);
+    EXPECT_EQ(controller->filterArtifactsByName("artifact", true).size(), 0); // Candidates are still verified
+    EXPECT_EQ(controller->filterArtifactsByMaterial("cott", false).size(), 1);
+    EXPECT_EQ(controller->filterArtifactsByLocation("2", false).size(), 1); // Short needle falls back to a scan
+    
+    controller->updateArtifact("ID003", "ID003", "Bronze Figurine", "Clay figure", "Bronze", QDate(2023, 3, 1), "Delphi");
+    EXPECT_EQ(controller->filterArtifactsByMaterial("cott", false).size(), 0);
+    EXPECT_EQ(controller->filterArtifactsByMaterial("bronze", false).size(), 1);
+    EXPECT_EQ(controller->filterArtifactsByName("figurine", false).size(), 1);
+    
+    controller->removeArtifact("ID001");
+    auto remaining = controller->filterArtifactsByName("artifact", false);
+    ASSERT_EQ(remaining.size(), 1);
+    EXPECT_EQ(remaining[0].getId(), "ID002");
+    
+    controller->undo(); // Re-adds ID001 under its old handle
+    EXPECT_EQ(controller->filterArtifactsByName("artifact", false).size(), 2);
+}
+
+// Test the ordered date index and that narrow date ranges drive AND filters correctly
+TEST_F(ControllerTest, TestDateIndex) {
+    DateIndex index;
+    index.assign({{30, 3}, {10, 1}, {20, 2}, {20, 4}});
+    index.insert(15, 5);
+    index.remove(20, 2);
+    auto slice = index.range(12, 25);
+    ASSERT_EQ(slice.second - slice.first, 2);
+    EXPECT_EQ(slice.first[0].handle, 5u);
+    EXPECT_EQ(slice.first[1].handle, 4u);
+    EXPECT_EQ(index.countInRange(31, 40), 0);
+    EXPECT_EQ(index.countInRange(25, 12), 0);
+    
+    // Enough artifacts that a one-month range is narrow enough for the index path
+    for (int i = 0; i < 400; ++i) {
+        controller->addArtifact(QString("D%1").arg(i), QString("Item %1").arg(i), "", i % 2 ? "Bronze" : "Iron",
+                                QDate(2000, 1, 1).addDays(i), "Site");
+    }
+    EXPECT_EQ(controller->filterArtifactsByDateRange(QDate(2000, 2, 1), QDate(2000, 2, 29)).size(), 29);
+    
+    controller->updateArtifact("D40", "D40", "Item 40", "", "Iron", QDate(1999, 1, 1), "Site"); // Was 2000-02-10
+    controller->removeArtifact("D41");
+    EXPECT_EQ(controller->filterArtifactsByDateRange(QDate(2000, 2, 1), QDate(2000, 2, 29)).size(), 27);
+    EXPECT_EQ(controller->filterArtifactsByDateRange(QDate(1998, 12, 1), QDate(1999, 1, 31)).size(), 1);
+    
+    auto bronzeInFebruary = std::make_unique<AndFilter>();
+    bronzeInFebruary->addFilter(std::make_unique<MaterialFilter>("bronze", false));
+    bronzeInFebruary->addFilter(std::make_unique<DateRangeFilter>(QDate(2000, 2, 1), QDate(2000, 2, 29)));
+    auto result = controller->filterArtifacts(std::move(bronzeInFebruary));
+    EXPECT_EQ(result.size(), 14); // Odd i in 31..59 minus the removed D41
+    for (const auto& artifact : result) {
+        EXPECT_EQ(artifact.getMaterial(), "Bronze");
+    }
+}
+
+// Test roaring containers and that indexable AND/OR trees are answered from the value bitmaps
+TEST_F(ControllerTest, TestBitmapIndex) {
+    RoaringBitmap sparse;
+    RoaringBitmap dense;
+    for (quint32 value = 0; value < 10000; ++value) {
+        dense.add(value); // Crosses ArrayLimit and becomes a bitmap container
+    }
+    sparse.add(5);
+    sparse.add(9999);
+    sparse.add(70000); // Second container
+    EXPECT_EQ(dense.cardinality(), 10000);
+    EXPECT_EQ((dense & sparse).toVector(), (std::vector<quint32>{5, 9999}));
+    EXPECT_EQ((dense | sparse).cardinality(), 10001);
+    dense.remove(5);
+    EXPECT_FALSE(dense.contains(5));
+    EXPECT_TRUE(dense.contains(6));
+    
+    const char* materials[] = {"Bronze", "Iron", "Clay", "Gold"};
+    const char* locations[] = {"Rome", "Athens"};
+    for (int i = 0; i < 64; ++i) {
+        controller->addArtifact(QString("B%1").arg(i), QString("Item %1").arg(i), "", materials[i % 4],
+                                QDate(2000, 1, 1), locations[i % 2]);
+    }
+    
+    auto bronzeOrIron = [] {
+        auto filter = std::make_unique<OrFilter>();
+        filter->addFilter(std::make_unique<MaterialFilter>("bronze", false, TextMatch::Equals));
+        filter->addFilter(std::make_unique<MaterialFilter>("Iron", true, TextMatch::Equals));
+        return filter;
+    };
+    auto inRome = [&bronzeOrIron] {
+        auto filter = std::make_unique<AndFilter>();
+        filter->addFilter(bronzeOrIron());
+        filter->addFilter(std::make_unique<LocationFilter>("Rome", true, TextMatch::Equals));
+        return filter;
+    };
+    
+    ArtifactTable emptyTable;
+    RoaringBitmap handles;
+    EXPECT_TRUE(inRome()->selectIndexed(emptyTable, handles));
+    EXPECT_TRUE(handles.isEmpty());
+    EXPECT_FALSE(std::make_unique<NameFilter>("Item")->selectIndexed(emptyTable, handles));
+    EXPECT_EQ(controller->countArtifacts(bronzeOrIron()), 32);
+    EXPECT_EQ(controller->countArtifacts(inRome()), 16); // i % 4 == 0 are Bronze in Rome, i % 4 == 1 Iron in Athens
+    auto rome = controller->filterArtifacts(inRome());
+    ASSERT_EQ(rome.size(), 16);
+    for (const auto& artifact : rome) {
+        EXPECT_EQ(artifact.getMaterial(), "Bronze");
+        EXPECT_EQ(artifact.getLocation(), "Rome");
+    }
+    EXPECT_EQ(controller->countArtifacts(std::make_unique<MaterialFilter>("o", false)), 48); // Contains over distinct values
+    EXPECT_EQ(controller->countArtifacts(std::make_unique<MaterialFilter>("bronze", true, TextMatch::Equals)), 0);
+    
+    controller->updateArtifact("B0", "B0", "Item 0", "", "Gold", QDate(2000, 1, 1), "Rome");
+    controller->removeArtifact("B4");
+    EXPECT_EQ(controller->countArtifacts(inRome()), 14);
+    EXPECT_EQ(controller->filterArtifacts(inRome()).size(), 14);
+}
+
+TEST_F(ControllerTest, TestQueryPlanner) {
+    const char* materials[] = {"Bronze", "Iron", "Clay", "Gold"};
+    for (int i = 0; i < 200; ++i) {
+        controller->addArtifact(QString("Q%1").arg(i), QString("Item %1").arg(i), "", materials[i % 4],
+                                QDate(2000, 1, 1).addDays(i), i % 2 ? "Athens" : "Rome");
+    }
+    ArtifactTable table;
+    table.rebuild(controller->getAllArtifacts());
+    
+    TableStatistics statistics(table);
+    EXPECT_EQ(statistics.distinctValues(ArtifactField::Material), 4);
+    EXPECT_EQ(statistics.valueHistogram(ArtifactField::Location).front(), std::make_pair(QString("Athens"), size_t(100)));
+    EXPECT_EQ(statistics.countDateRange(QDate(2000, 1, 1), QDate(2000, 1, 10)), 10);
+    size_t bucketed = 0;
+    for (const auto& bucket : statistics.dateHistogram(8)) {
+        EXPECT_LE(bucket.first, bucket.last);
+        bucketed += bucket.rows;
+    }
+    EXPECT_EQ(bucketed, 200);
+    
+    // Added in the least helpful order: the name matches every row, the dates only three
+    AndFilter filter;
+    filter.addFilter(std::make_unique<NameFilter>("Item"));
+    filter.addFilter(std::make_unique<MaterialFilter>("Bronze", true, TextMatch::Equals));
+    filter.addFilter(std::make_unique<DateRangeFilter>(QDate(2000, 1, 1), QDate(2000, 1, 3)));
+    QueryPlan plan = QueryPlanner(table).plan(filter);
+    const auto& children = plan.root().children;
+    ASSERT_EQ(children.size(), 3);
+    EXPECT_EQ(children[0].kind, QueryPlan::Node::Kind::Date);
+    EXPECT_EQ(children[0].path, AccessPath::DateIndex);
+    EXPECT_EQ(children[1].kind, QueryPlan::Node::Kind::Text);
+    EXPECT_EQ(children[1].field, ArtifactField::Material);
+    EXPECT_EQ(children[2].field, ArtifactField::Name);
+    EXPECT_NEAR(plan.estimatedRows(), 0.75, 0.01);
+    EXPECT_TRUE(plan.explain().contains("date index"));
+    
+    RowBitmap rows = plan.execute(ArtifactBatch(table));
+    EXPECT_EQ(rows.count(), 1);
+    EXPECT_TRUE(rows.test(0));
+    EXPECT_EQ(controller->filterArtifacts(filter.clone()).size(), 1);
+    
+    // Wide ranges scan the day column; a fully indexable tree is answered from the bitmaps
+    OrFilter wide;
+    wide.addFilter(std::make_unique<DateRangeFilter>(QDate(2000, 1, 1), QDate(2000, 12, 31)));
+    wide.addFilter(std::make_unique<MaterialFilter>("Iron", true, TextMatch::Equals));
+    QueryPlan widePlan = QueryPlanner(table).plan(wide);
+    EXPECT_EQ(widePlan.root().children[0].path, AccessPath::Scan);
+    EXPECT_EQ(widePlan.execute(ArtifactBatch(table)).count(), wide.matchBatch(ArtifactBatch(table)).count());
+    AndFilter indexed;
+    indexed.addFilter(std::make_unique<MaterialFilter>("Clay", true, TextMatch::Equals));
+    indexed.addFilter(std::make_unique<LocationFilter>("Rome", true, TextMatch::Equals));
+    QueryPlan indexedPlan = QueryPlanner(table).plan(indexed);
+    EXPECT_EQ(indexedPlan.root().path, AccessPath::ValueBitmap);
+    EXPECT_EQ(indexedPlan.execute(ArtifactBatch(table)).count(), 50);
+}
+
+TEST_F(ControllerTest, TestFilterResultCache) {
+    const char* materials[] = {"Bronze", "Iron", "Clay", "Gold"};
+    for (int i = 0; i < 100; ++i) {
+        controller->addArtifact(QString("R%1").arg(i), QString("Item %1").arg(i % 10), "", materials[i % 4],
+                                QDate(2000, 1, 1).addDays(i), "Rome");
+    }
+    auto bronzeItems = [](const QString& material, const QString& name) {
+        auto filter = std::make_unique<AndFilter>();
+        filter->addFilter(std::make_unique<MaterialFilter>(material));
+        filter->addFilter(std::make_unique<NameFilter>(name));
+        return filter;
+    };
+    
+    // Child order, nesting and the case of case-insensitive terms do not change the key
+    ArtifactTable table;
+    table.rebuild(controller->getAllArtifacts());
+    auto nested = std::make_unique<AndFilter>();
+    nested->addFilter(std::make_unique<NameFilter>("ITEM 2"));
+    nested->addFilter(bronzeItems("bronze", "item 2"));
+    QString key = QueryPlanner(table).plan(*bronzeItems("Bronze", "Item 2")).root().key;
+    EXPECT_EQ(QueryPlanner(table).plan(*nested).root().key, key);
+    EXPECT_NE(QueryPlanner(table).plan(MaterialFilter("Bronze", true)).root().key,
+              QueryPlanner(table).plan(MaterialFilter("bronze", true)).root().key);
+    EXPECT_TRUE(QueryPlanner(table).plan(OrFilter()).root().key != QueryPlanner(table).plan(AndFilter()).root().key);
+    
+    auto first = controller->filterArtifacts(bronzeItems("Bronze", "Item 2"));
+    EXPECT_EQ(first.size(), 5); // i % 20 == 0 or 12, i.e. i % 4 == 0 and i % 10 == 2
+    size_t hits = controller->filterCache().hits();
+    auto again = controller->filterArtifacts(bronzeItems("BRONZE", "item 2"));
+    EXPECT_EQ(again.size(), first.size());
+    EXPECT_GT(controller->filterCache().hits(), hits);
+    
+    // A new conjunct reuses the child that ran over every row
+    auto wider = bronzeItems("Bronze", "Item 2");
+    wider->addFilter(std::make_unique<DateRangeFilter>(QDate(2000, 1, 1), QDate(2000, 1, 31)));
+    EXPECT_TRUE(controller->explainFilter(*wider).contains("result cache"));
+    EXPECT_EQ(controller->filterArtifacts(std::move(wider)).size(), 1); // Only R12 falls in January
+    
+    // Any change drops every entry
+    controller->updateArtifact("R12", "R12", "Item 2", "", "Gold", QDate(2000, 1, 13), "Rome");
+    EXPECT_FALSE(controller->explainFilter(*bronzeItems("Bronze", "Item 2")).contains("result cache"));
+    EXPECT_EQ(controller->filterArtifacts(bronzeItems("Bronze", "Item 2")).size(), 4);
+    
+    FilterResultCache lru(2);
+    lru.sync(table);
+    lru.insert("a", RowBitmap(table.size()));
+    lru.insert("b", RowBitmap(table.size()));
+    EXPECT_TRUE(lru.lookup("a"));
+    lru.insert("c", RowBitmap(table.size()));
+    EXPECT_EQ(lru.size(), 2);
+    EXPECT_FALSE(lru.lookup("b"));
+    EXPECT_TRUE(lru.lookup("a"));
+}
+
+TEST_F(ControllerTest, TestLiveView) {
+    // Records the row edits the view reports, as "+position", "-position" or "~position"
+    struct Recorder : LiveViewListener {
+        QStringList events;
+        void beginInsert(size_t position) override { events << QString("+%1").arg(position); }
+        void endInsert() override {}
+        void beginRemove(size_t position) override { events << QString("-%1").arg(position); }
+        void endRemove() override {}
+        void rowChanged(size_t position) override { events << QString("~%1").arg(position); }
+        void beginReset() override { events << "reset"; }
+        void endReset() override {}
+    };
+    auto ids = [](const LiveView& view) {
+        QStringList result;
+        for (size_t i = 0; i < view.size(); ++i) {
+            result << view.artifact(i).getId();
+        }
+        return result;
+    };
+    
+    controller->addArtifact("L1", "Axe", "", "Bronze", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("L2", "Pot", "", "Clay", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("L3", "Pin", "", "Bronze", QDate(2000, 1, 1), "Rome");
+    std::unique_ptr<LiveView> view = controller->createLiveView();
+    EXPECT_EQ(view->size(), 3);
+    Recorder recorder;
+    view->setListener(&recorder);
+    view->setFilter(std::make_unique<MaterialFilter>("bronze"));
+    EXPECT_EQ(ids(*view), QStringList({"L1", "L3"}));
+    
+    controller->addArtifact("L4", "Cup", "", "Clay", QDate(2000, 1, 1), "Rome");   // Not a match
+    controller->addArtifact("L5", "Bell", "", "Bronze", QDate(2000, 1, 1), "Rome"); // Appended
+    controller->updateArtifact("L2", "L2", "Pot", "", "Bronze", QDate(2000, 1, 1), "Rome"); // Now matches
+    controller->updateArtifact("L3", "L3", "Pin", "", "Iron", QDate(2000, 1, 1), "Rome");   // No longer
+    controller->updateArtifact("L1", "L1", "Adze", "", "Bronze", QDate(2000, 1, 1), "Rome"); // Still matches
+    controller->removeArtifact("L5");
+    EXPECT_EQ(recorder.events, QStringList({"reset", "+2", "+1", "-2", "~0", "-2"}));
+    EXPECT_EQ(ids(*view), QStringList({"L1", "L2"}));
+    EXPECT_EQ(view->artifact(0).getName(), "Adze");
+    EXPECT_EQ(view->positionOf(controller->handleForId("L2")), 1);
+    EXPECT_EQ(view->positionOf(controller->handleForId("L3")), -1);
+    controller->removeArtifact("L1"); // Placed from the row the table erased, ahead of L2
+    EXPECT_EQ(recorder.events.last(), "-0");
+    EXPECT_EQ(ids(*view), QStringList({"L2"}));
+    
+    // Undo goes through the same change sets; the view always agrees with a full refilter
+    controller->undo();
+    controller->undo();
+    QStringList expected;
+    for (const auto& artifact : controller->filterArtifacts(std::make_unique<MaterialFilter>("bronze"))) {
+        expected << artifact.getId();
+    }
+    EXPECT_EQ(ids(*view), expected);
+    view->setListener(nullptr);
+    
+    // Removals leave tombstones: other rows stay put, and nothing matches the blank rows
+    std::vector<ArcheologicalArtifact> artifacts;
+    for (int i = 0; i < 10; ++i) {
+        artifacts.emplace_back(QString("T%1").arg(i), "Find", "", i % 2 ? "Bronze" : "Clay", QDate(2000, 1, 1), "Rome");
+        artifacts.back().setHandle(static_cast<ArtifactHandle>(i + 1));
+    }
+    ArtifactTable table;
+    table.rebuild(artifacts);
+    for (int i : {2, 5, 6, 7}) {
+        table.onArtifactChanged(ArtifactChangeSet::removed(artifacts[i]));
+    }
+    EXPECT_EQ(table.size(), 10u);
+    EXPECT_EQ(table.artifactCount(), 6u);
+    EXPECT_EQ(table.rowOf(artifacts[9].getHandle()), 9);
+    EXPECT_EQ(table.rowOf(artifacts[5].getHandle()), 5);
+    EXPECT_FALSE(table.isLive(5));
+    EXPECT_EQ(ArtifactFilter().select(ArtifactBatch(table)).count(), 6u);
+    EXPECT_EQ(ArtifactFilter(std::make_unique<NameFilter>("")).select(ArtifactBatch(table)).count(), 6u);
+    EXPECT_EQ(ArtifactFilter(std::make_unique<MaterialFilter>("bronze")).filter(ArtifactBatch(table)).size(), 3u);
+    // Once tombstones outnumber the artifacts, the next change compacts, keeping the order
+    table.onArtifactChanged(ArtifactChangeSet::removed(artifacts[0]));
+    table.onArtifactChanged(ArtifactChangeSet::removed(artifacts[1]));
+    EXPECT_EQ(table.size(), 10u);
+    table.onArtifactChanged(ArtifactChangeSet::added(artifacts[0]));
+    EXPECT_EQ(table.size(), 5u);
+    EXPECT_EQ(table.rowOf(artifacts[2].getHandle()), -1);
+    EXPECT_EQ(table.rowOf(artifacts[9].getHandle()), 3);
+    QStringList rows;
+    for (size_t row = 0; row < table.size(); ++row) {
+        rows << table.artifact(row).getId();
+    }
+    EXPECT_EQ(rows, QStringList({"T3", "T4", "T8", "T9", "T0"}));
+}
+
+TEST_F(ControllerTest, TestFoldedColumns) {
+    EXPECT_EQ(ArtifactTable::foldCase("Bronze Axe"), "bronze axe");
+    EXPECT_EQ(ArtifactTable::foldCase("already lower"), "already lower");
+    
+    controller->addArtifact("F1", "Bronze AXE", "Found near the GATE", "Bronze", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("F2", "axe head", "gate post", "bronze", QDate(2000, 1, 2), "ROME");
+    controller->addArtifact("F3", "Pot", "Café floor", "Clay", QDate(2000, 1, 3), "Athens");
+    auto ids = [this](std::unique_ptr<FilterStrategy> filter) {
+        QStringList result;
+        for (const auto& artifact : controller->filterArtifacts(std::move(filter))) {
+            result << artifact.getId();
+        }
+        return result;
+    };
+    auto scanned = [this](const FilterStrategy& filter) {
+        QStringList result;
+        for (const auto& artifact : controller->getAllArtifacts()) {
+            if (filter.matches(artifact)) {
+                result << artifact.getId();
+            }
+        }
+        return result;
+    };
+    auto check = [&] {
+        EXPECT_EQ(ids(std::make_unique<NameFilter>("aXe")), scanned(NameFilter("aXe")));
+        EXPECT_EQ(ids(std::make_unique<DescriptionFilter>("GATE")), scanned(DescriptionFilter("GATE")));
+        EXPECT_EQ(ids(std::make_unique<DescriptionFilter>("CAFÉ")), scanned(DescriptionFilter("CAFÉ")));
+        EXPECT_EQ(ids(std::make_unique<LocationFilter>("rome", false, TextMatch::Equals)),
+                  scanned(LocationFilter("rome", false, TextMatch::Equals)));
+        EXPECT_EQ(ids(std::make_unique<NameFilter>("AXE", true)), scanned(NameFilter("AXE", true)));
+    };
+    
+    check();
+    EXPECT_EQ(ids(std::make_unique<NameFilter>("aXe")), QStringList({"F1", "F2"}));
+    EXPECT_GT(controller->foldedColumnBytes(), 0u);
+    
+    // Updates refold only the changed fields, removals drop the row
+    controller->updateArtifact("F2", "F2", "Spear", "GATE post", "bronze", QDate(2000, 1, 2), "Athens");
+    controller->removeArtifact("F1");
+    check();
+    EXPECT_EQ(ids(std::make_unique<DescriptionFilter>("gate")), QStringList({"F2"}));
+    
+    // Without the shadow columns the same filters scan with case-insensitive comparisons
+    controller->setFoldedFields(0);
+    EXPECT_EQ(controller->foldedColumnBytes(), 0u);
+    check();
+    controller->setFoldedFields(ArtifactTable::DefaultFoldedFields);
+    controller->addArtifact("F4", "AXE", "", "Iron", QDate(2000, 1, 4), "Rome");
+    check();
+}
+
+TEST_F(ControllerTest, TestFuzzyNameFilter) {
+    ArcheologicalArtifact amphora("Z1", "Amphora", "", "Clay", QDate(2000, 1, 1), "Rome");
+    EXPECT_TRUE(FuzzyNameFilter("amfora", 2).matches(amphora));  // p -> f, drop h
+    EXPECT_FALSE(FuzzyNameFilter("amfora", 1).matches(amphora));
+    EXPECT_TRUE(FuzzyNameFilter("PHOR", 0).matches(amphora));    // Zero edits is a case-insensitive contains
+    EXPECT_TRUE(FuzzyNameFilter("x", 1).matches(amphora));       // The whole pattern may be deleted
+    EXPECT_EQ(FuzzyNameFilter::suggestedEdits("pot"), 0);
+    EXPECT_EQ(FuzzyNameFilter::suggestedEdits("amfora"), 2);
+    
+    const QStringList names = {"Amphora", "Amphorae fragment", "Black-figure amphora", "Anfora", "Oil lamp",
+                               "Bronze mirror", "Bronse miror", "Figurine of a horse"};
+    int next = 0;
+    for (const QString& name : names) {
+        controller->addArtifact(QString("Z%1").arg(next++), name, "", "Clay", QDate(2000, 1, 1), "Rome");
+    }
+    auto ids = [this](std::unique_ptr<FilterStrategy> filter) {
+        QStringList result;
+        for (const auto& artifact : controller->filterArtifacts(std::move(filter))) {
+            result << artifact.getName();
+        }
+        return result;
+    };
+    auto scanned = [this](const FilterStrategy& filter) {
+        QStringList result;
+        for (const auto& artifact : controller->getAllArtifacts()) {
+            if (filter.matches(artifact)) {
+                result << artifact.getName();
+            }
+        }
+        return result;
+    };
+    
+    // Long patterns with few edits are pruned by the trigram index; results must not change
+    EXPECT_TRUE(TrigramIndex::canServeApproximate("bronze mirror", 1));
+    EXPECT_FALSE(TrigramIndex::canServeApproximate("amfora", 2));
+    EXPECT_EQ(ids(std::make_unique<FuzzyNameFilter>("bronze mirror", 2)), QStringList({"Bronze mirror", "Bronse miror"}));
+    for (const QString& pattern : {QString("amfora"), QString("bronze mirror"), QString("horse"), QString("lamb")}) {
+        for (int edits = 0; edits <= 3; ++edits) {
+            EXPECT_EQ(ids(std::make_unique<FuzzyNameFilter>(pattern, edits)), scanned(FuzzyNameFilter(pattern, edits)))
+                << pattern.toStdString() << " within " << edits;
+        }
+    }
+    
+    // Slots into the composites like any other strategy, and repeats come from the cache
+    auto makeFilter = [] {
+        auto filter = std::make_unique<AndFilter>();
+        filter->addFilter(std::make_unique<FuzzyNameFilter>("amfora", 2));
+        filter->addFilter(std::make_unique<NameFilter>("black", false));
+        return filter;
+    };
+    EXPECT_EQ(ids(makeFilter()), QStringList({"Black-figure amphora"}));
+    EXPECT_TRUE(controller->explainFilter(*makeFilter()).contains("result cache"));
+    EXPECT_TRUE(controller->explainFilter(FuzzyNameFilter("amfora", 2)).contains("name like 'amfora'"));
+}
+
+TEST_F(ControllerTest, TestDescriptionSearch) {
+    EXPECT_EQ(FullTextIndex::tokenize("Black-glaze KYLIX, 4th c."), QStringList({"black", "glaze", "kylix", "4th", "c"}));
+    FullTextQuery query = FullTextQuery::parse("rim \"black glaze\"");
+    ASSERT_EQ(query.phrases.size(), 2u);
+    EXPECT_EQ(query.phrases[1], QStringList({"black", "glaze"}));
+    
+    controller->addArtifact("D1", "Kylix", "Black glaze kylix with a chipped rim", "Clay", QDate(2000, 1, 1), "Athens");
+    controller->addArtifact("D2", "Krater", "Red figure krater, black rim, traces of glaze on the foot of the vessel",
+                            "Clay", QDate(2000, 1, 2), "Athens");
+    controller->addArtifact("D3", "Lamp", "Oil lamp, rim rim rim", "Clay", QDate(2000, 1, 3), "Rome");
+    controller->addArtifact("D4", "Coin", "Bronze coin", "Bronze", QDate(2000, 1, 4), "Rome");
+    auto ids = [](const auto& artifacts) {
+        QStringList result;
+        for (const auto& artifact : artifacts) {
+            result << artifact.getId();
+        }
+        return result;
+    };
+    
+    // Ranked by BM25: repeated words and short descriptions score higher; the limit keeps the best
+    EXPECT_EQ(ids(controller->searchDescriptions("rim")), QStringList({"D3", "D1", "D2"}));
+    EXPECT_EQ(ids(controller->searchDescriptions("rim", 1)), QStringList({"D3"}));
+    EXPECT_EQ(ids(controller->searchDescriptions("GLAZE black")), QStringList({"D1", "D2"}));
+    EXPECT_EQ(ids(controller->searchDescriptions("\"black glaze\"")), QStringList({"D1"}));
+    EXPECT_TRUE(controller->searchDescriptions("amphora").empty());
+    EXPECT_TRUE(controller->searchDescriptions("").empty());
+    
+    // As a filter it agrees with matching each description on its own
+    for (const QString& text : {QString("rim"), QString("\"black glaze\""), QString("black rim"), QString("coin")}) {
+        QStringList scanned;
+        for (const auto& artifact : controller->getAllArtifacts()) {
+            if (DescriptionSearch(text).matches(artifact)) {
+                scanned << artifact.getId();
+            }
+        }
+        EXPECT_EQ(ids(controller->filterArtifacts(std::make_unique<DescriptionSearch>(text))), scanned);
+    }
+    
+    // The index follows updates and removals; the shorter description now ranks first
+    controller->updateArtifact("D4", "D4", "Coin", "Bronze coin with a worn rim", "Bronze", QDate(2000, 1, 4), "Rome");
+    controller->removeArtifact("D3");
+    EXPECT_EQ(ids(controller->searchDescriptions("rim")), QStringList({"D4", "D1", "D2"}));
+    EXPECT_TRUE(controller->searchDescriptions("lamp").empty());
+    
+    // Saved beside the repository file, it is loaded only while the artifacts are unchanged
+    ASSERT_TRUE(controller->saveSearchIndex());
+    std::vector<ArcheologicalArtifact> artifacts = controller->getAllArtifacts();
+    ArtifactTable table;
+    EXPECT_TRUE(table.rebuild(artifacts, controller->searchIndexPath()));
+    EXPECT_EQ(table.fullTextIndex().matching(FullTextQuery::parse("rim")).size(), 3u);
+    {
+        ArtifactController reopened(std::make_unique<CsvRepository>(tempPath));
+        EXPECT_EQ(ids(reopened.searchDescriptions("rim")), QStringList({"D4", "D1", "D2"}));
+    }
+    artifacts.back().setDescription("Bronze coin");
+    EXPECT_FALSE(table.rebuild(artifacts, controller->searchIndexPath()));
+    EXPECT_EQ(table.fullTextIndex().matching(FullTextQuery::parse("rim")).size(), 2u);
+    QFile::remove(controller->searchIndexPath());
+}
+
+TEST_F(ControllerTest, TestQueryOptions) {
+    const char* materials[] = {"Bronze", "clay", "Clay", "Gold"};
+    for (int i = 0; i < 40; ++i) {
+        controller->addArtifact(QString("Q%1").arg(i, 2, 10, QChar('0')), QString("Item %1").arg(i % 7), "",
+                                materials[i % 4], QDate(2000, 1, 1).addDays((i * 13) % 10), "Site");
+    }
+    auto ids = [](const auto& artifacts, size_t first = 0, size_t count = 100) {
+        QStringList result;
+        for (size_t i = first; i < artifacts.size() && i < first + count; ++i) {
+            result << artifacts[i].getId();
+        }
+        return result;
+    };
+    
+    // Material ignoring case, then by case; newest first within a material; ties in table order
+    QueryOptions options;
+    options.sortKeys = {{ArtifactField::Material, SortDirection::Ascending},
+                        {ArtifactField::DiscoveryDate, SortDirection::Descending}};
+    std::vector<ArcheologicalArtifact> expected = controller->getAllArtifacts();
+    std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+        int material = a.getMaterial().compare(b.getMaterial(), Qt::CaseInsensitive);
+        if (!material) {
+            material = a.getMaterial().compare(b.getMaterial());
+        }
+        return material ? material < 0 : a.getDiscoveryDate() > b.getDiscoveryDate();
+    });
+    EXPECT_EQ(ids(controller->filterArtifacts(nullptr, options)), ids(expected));
+    
+    // Pages of the same order, from the partial sort and then from the cached order
+    options.offset = 5;
+    options.limit = 7;
+    QStringList page = ids(expected, 5, 7);
+    EXPECT_EQ(ids(controller->filterArtifacts(nullptr, options)), page);
+    EXPECT_EQ(ids(controller->filterArtifacts(nullptr, options)), page);
+    options.offset = 38;
+    EXPECT_EQ(ids(controller->filterArtifacts(nullptr, options)), ids(expected, 38));
+    options.offset = 40;
+    EXPECT_TRUE(controller->filterArtifacts(nullptr, options).empty());
+    
+    // With a filter and without keys: the matches in table order
+    QueryOptions unsorted;
+    unsorted.offset = 1;
+    unsorted.limit = 3;
+    EXPECT_EQ(ids(controller->filterArtifacts(std::make_unique<MaterialFilter>("Gold"), unsorted)),
+              QStringList({"Q07", "Q11", "Q15"}));
+    
+    // The full order is kept from the second request on and dropped when the table changes
+    std::vector<ArcheologicalArtifact> artifacts = controller->getAllArtifacts();
+    ArtifactTable table;
+    table.rebuild(artifacts);
+    SortOrderCache cache;
+    cache.sync(table);
+    EXPECT_EQ(cache.order(options.sortKeys), nullptr);
+    const SortOrderCache::Order* order = cache.order(options.sortKeys);
+    ASSERT_NE(order, nullptr);
+    EXPECT_EQ(table.artifact(order->rows.front()).getId(), expected.front().getId());
+    EXPECT_EQ(order->ranks[order->rows[3]], 3u);
+    EXPECT_EQ(cache.size(), 1u);
+    artifacts.push_back(artifact1);
+    table.rebuild(artifacts);
+    cache.sync(table);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.order(options.sortKeys), nullptr);
+}
+
+TEST_F(ControllerTest, TestResultSet) {
+    controller->addArtifact(artifact1.getId(), artifact1.getName(), artifact1.getDescription(), artifact1.getMaterial(),
+                            artifact1.getDiscoveryDate(), artifact1.getLocation());
+    controller->addArtifact(artifact2.getId(), artifact2.getName(), artifact2.getDescription(), artifact2.getMaterial(),
+                            artifact2.getDiscoveryDate(), artifact2.getLocation());
+    
+    ArtifactResultSet result = controller->filterArtifactsByName("test artifact", false);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result.handle(0), controller->handleForId("ID001"));
+    EXPECT_EQ(result.handle(1), controller->handleForId("ID002"));
+    std::vector<ArcheologicalArtifact> copies = result.materialize();
+    ASSERT_EQ(copies.size(), 2u);
+    EXPECT_EQ(copies[1].getDescription(), "Description 2");
+    
+    // Entries read the artifacts as they are now; the copies keep what they were
+    controller->updateArtifact("ID002", "ID002", "Renamed", "Description 2", "Material 2", QDate(2023, 2, 20), "Location 2");
+    EXPECT_EQ(result[1].getName(), "Renamed");
+    EXPECT_EQ(copies[1].getName(), "Test Artifact 2");
+    controller->removeArtifact("ID001");
+    EXPECT_THROW(result[0], std::runtime_error);
+    EXPECT_EQ(result[1].getId(), "ID002");
+    
+    QStringList names;
+    for (const auto& artifact : controller->filterArtifacts(nullptr)) {
+        names << artifact.getName();
+    }
+    EXPECT_EQ(names, QStringList({"Renamed"}));
+    EXPECT_TRUE(controller->filterArtifactsByLocation("Location 1").empty());
+}
+
+TEST_F(ControllerTest, TestAggregation) {
+    // Enough rows for several workers; the serial pass is the reference
+    const char* materials[] = {"Bronze", "Clay", "Gold"};
+    const char* locations[] = {"Rome", "Athens", "Troy", "Knossos", "Delphi"};
+    std::vector<ArcheologicalArtifact> artifacts;
+    for (int i = 0; i < 20000; ++i) {
+        QDate date = i % 97 == 0 ? QDate() : QDate(1900 + i % 113, 1 + i % 12, 1);
+        artifacts.emplace_back(QString("G%1").arg(i), "Item", "", materials[i % 3], date, locations[i % 5]);
+    }
+    ArtifactTable table;
+    table.rebuild(artifacts);
+    RowBitmap rows(table.size(), true);
+    for (size_t row = 0; row < table.size(); row += 7) {
+        rows.reset(row);
+    }
+    
+    AggregationEngine engine(table);
+    Aggregation parallel = engine.aggregate(rows);
+    Aggregation serial = engine.aggregate(rows, AggregationRequest(), FilterExecution::Serial);
+    std::map<QString, size_t> bronzeOrRome;
+    std::map<int, size_t> decades;
+    size_t undated = 0;
+    QDate earliest;
+    QDate latest;
+    rows.forEachSetBit([&](size_t row) {
+        const ArcheologicalArtifact& artifact = table.artifact(row);
+        ++bronzeOrRome[artifact.getMaterial()];
+        ++bronzeOrRome[artifact.getLocation()];
+        if (artifact.getDiscoveryDate().isValid()) {
+            ++decades[artifact.getDiscoveryDate().year() / 10 * 10];
+            const QDate date = artifact.getDiscoveryDate();
+            earliest = earliest.isValid() ? std::min(earliest, date) : date;
+            latest = std::max(latest, date);
+        } else {
+            ++undated;
+        }
+    });
+    for (const Aggregation* aggregation : {&parallel, &serial}) {
+        EXPECT_EQ(aggregation->rows, rows.count());
+        EXPECT_EQ(aggregation->undated, undated);
+        ASSERT_EQ(aggregation->counts(ArtifactField::Material).size(), 3u);
+        EXPECT_EQ(aggregation->counts(ArtifactField::Material)[0].second, bronzeOrRome[aggregation->counts(ArtifactField::Material)[0].first]);
+        for (const auto& [value, count] : aggregation->counts(ArtifactField::Location)) {
+            EXPECT_EQ(count, bronzeOrRome[value]);
+        }
+        EXPECT_TRUE(aggregation->counts(ArtifactField::Name).empty());
+        ASSERT_EQ(aggregation->dateCounts.size(), decades.size());
+        EXPECT_EQ(aggregation->dateCounts.front(), std::make_pair(1900, decades[1900]));
+        EXPECT_EQ(aggregation->earliest, earliest);
+        EXPECT_EQ(aggregation->latest, latest);
+    }
+    EXPECT_EQ(parallel.counts(ArtifactField::Location), serial.counts(ArtifactField::Location));
+    EXPECT_EQ(parallel.dateCounts, serial.dateCounts);
+    
+    // Through the controller: restricted to the filter, grouped by year
+    controller->addArtifact("A1", "Bowl", "", "Clay", QDate(1990, 5, 1), "Rome");
+    controller->addArtifact("A2", "Cup", "", "Clay", QDate(1990, 7, 1), "Athens");
+    controller->addArtifact("A3", "Coin", "", "Bronze", QDate(1994, 1, 1), "Rome");
+    AggregationRequest byYear;
+    byYear.groupBy = fieldBit(ArtifactField::Location) | fieldBit(ArtifactField::DiscoveryDate);
+    byYear.dateBucket = DateBucket::Year;
+    Aggregation clay = controller->aggregateArtifacts(std::make_unique<MaterialFilter>("clay"), byYear);
+    EXPECT_EQ(clay.rows, 2u);
+    EXPECT_TRUE(clay.counts(ArtifactField::Material).empty());
+    using Counts = std::vector<std::pair<QString, size_t>>;
+    EXPECT_EQ(clay.counts(ArtifactField::Location), Counts({{"Athens", 1}, {"Rome", 1}}));
+    EXPECT_EQ(clay.dateCounts, (std::vector<std::pair<int, size_t>>{{1990, 2}}));
+    Aggregation all = controller->aggregateArtifacts(nullptr);
+    EXPECT_EQ(all.counts(ArtifactField::Location), Counts({{"Rome", 2}, {"Athens", 1}}));
+    EXPECT_EQ(all.latest, QDate(1994, 1, 1));
+    
+    // Facets of a live view follow its edits and agree with a fresh aggregation
+    std::unique_ptr<LiveView> view = controller->createLiveView();
+    FacetCounts facets(byYear);
+    view->setMemberListener(&facets);
+    view->setFilter(std::make_unique<MaterialFilter>("clay"));
+    EXPECT_EQ(facets.aggregation().dateCounts, clay.dateCounts);
+    controller->addArtifact("A4", "Jar", "", "Clay", QDate(1985, 2, 1), "Athens");
+    controller->updateArtifact("A1", "A1", "Bowl", "", "Clay", QDate(1990, 5, 1), "Athens"); // Stays, moves
+    controller->updateArtifact("A3", "A3", "Coin", "", "Clay", QDate(), "Rome");             // Enters undated
+    controller->removeArtifact("A2");
+    controller->undo();
+    controller->removeArtifact("A4"); // The earliest date goes with it
+    Aggregation live = facets.aggregation();
+    Aggregation fresh = controller->aggregateArtifacts(std::make_unique<MaterialFilter>("clay"), byYear);
+    EXPECT_EQ(live.rows, 3u);
+    EXPECT_EQ(live.rows, fresh.rows);
+    EXPECT_EQ(live.counts(ArtifactField::Location), Counts({{"Athens", 2}, {"Rome", 1}}));
+    EXPECT_EQ(live.counts(ArtifactField::Location), fresh.counts(ArtifactField::Location));
+    EXPECT_EQ(live.dateCounts, fresh.dateCounts);
+    EXPECT_EQ(live.undated, 1u);
+    EXPECT_EQ(live.earliest, fresh.earliest);
+    EXPECT_EQ(live.latest, QDate(1990, 7, 1));
+    view->setMemberListener(nullptr);
+}
+
+TEST_F(ControllerTest, TestSuggestions) {
+    RadixTrie trie;
+    for (const char* value : {"Bronze", "Bronze", "bronze", "Bone", "Bone", "Bone", "Brick", "Glass", "Bro"}) {
+        trie.insert(value);
+    }
+    using Completions = std::vector<std::pair<QString, size_t>>;
+    EXPECT_EQ(trie.size(), 5u); // Keys ignore case
+    EXPECT_EQ(trie.frequency("BRONZE"), 3u);
+    EXPECT_EQ(trie.complete("b", 3), Completions({{"Bone", 3}, {"Bronze", 3}, {"Brick", 1}}));
+    EXPECT_EQ(trie.complete("BRO", 5), Completions({{"Bronze", 3}, {"Bro", 1}}));
+    EXPECT_EQ(trie.complete("bronzes", 5), Completions());
+    EXPECT_EQ(trie.complete("", 1), Completions({{"Bone", 3}}));
+    
+    // Removals merge the edges back; the most frequent spelling is shown
+    trie.remove("Bronze");
+    trie.remove("Bronze");
+    trie.remove("Bro");
+    EXPECT_EQ(trie.complete("br", 5), Completions({{"Brick", 1}, {"bronze", 1}}));
+    trie.remove("Bone", 3);
+    EXPECT_EQ(trie.frequency("bone"), 0u);
+    EXPECT_EQ(trie.complete("b", 5), Completions({{"Brick", 1}, {"bronze", 1}}));
+    EXPECT_EQ(trie.size(), 3u);
+    
+    // The controller's tries follow every change
+    controller->addArtifact("S1", "Amphora", "", "Clay", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("S2", "Amulet", "", "Gold", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("S3", "Amphora", "", "Clay", QDate(2000, 1, 1), "Ravenna");
+    EXPECT_EQ(controller->suggestValues(ArtifactField::Name, "am"), QStringList({"Amphora", "Amulet"}));
+    EXPECT_EQ(controller->suggestValues(ArtifactField::Location, "R", 1), QStringList({"Rome"}));
+    EXPECT_TRUE(controller->suggestValues(ArtifactField::Description, "a").isEmpty());
+    controller->updateArtifact("S2", "S2", "Amulet", "", "Gold", QDate(2000, 1, 1), "Ravenna");
+    controller->removeArtifact("S1");
+    EXPECT_EQ(controller->suggestValues(ArtifactField::Location, "r"), QStringList({"Ravenna"}));
+    EXPECT_EQ(controller->suggestValues(ArtifactField::Name, "am"), QStringList({"Amphora", "Amulet"}));
+    controller->undo();
+    EXPECT_EQ(controller->suggestValues(ArtifactField::Location, "r"), QStringList({"Ravenna", "Rome"}));
+    EXPECT_EQ(controller->suggestValues(ArtifactField::Material, "c"), QStringList({"Clay"}));
+}
+
+TEST_F(ControllerTest, TestNearestArtifacts) {
+    controller->addArtifact("N1", "Colosseum", "", "Stone", QDate(2000, 1, 1), "Rome", GeoPoint(41.8902, 12.4922));
+    controller->addArtifact("N2", "Parthenon", "", "Marble", QDate(2000, 1, 1), "Athens", GeoPoint(37.9715, 23.7257));
+    controller->addArtifact("N3", "Pantheon", "", "Concrete", QDate(2000, 1, 1), "Rome", GeoPoint(41.8986, 12.4769));
+    controller->addArtifact("N4", "Tablet", "", "Clay", QDate(2000, 1, 1), "Unknown");
+    controller->addArtifact("N5", "Hadrian's Wall", "", "Stone", QDate(2000, 1, 1), "Britain", GeoPoint(55.0, -2.3));
+    auto ids = [](const ArtifactResultSet& result) {
+        QStringList list;
+        for (const auto& artifact : result) {
+            list << artifact.getId();
+        }
+        return list;
+    };
+    const GeoPoint forum(41.8925, 12.4853);
+    EXPECT_EQ(ids(controller->nearestArtifacts(forum, 3)), QStringList({"N1", "N3", "N2"}));
+    EXPECT_EQ(ids(controller->nearestArtifacts(forum, 10)), QStringList({"N1", "N3", "N2", "N5"}));
+    EXPECT_EQ(ids(controller->nearestArtifacts(forum, 10, 100.0)), QStringList({"N1", "N3"}));
+    EXPECT_TRUE(controller->nearestArtifacts(forum, 0).empty());
+    EXPECT_THROW(controller->nearestArtifacts(GeoPoint(), 1), std::invalid_argument);
+    EXPECT_EQ(controller->countArtifacts(std::make_unique<RadiusFilter>(forum, 5.0)), 2);
+    
+    // Updates and removals keep the index current, and so does undo
+    controller->updateArtifact("N2", "N2", "Parthenon", "", "Marble", QDate(2000, 1, 1), "Rome", GeoPoint(41.9, 12.49));
+    EXPECT_EQ(ids(controller->filterArtifacts(std::make_unique<RadiusFilter>(forum, 5.0))), QStringList({"N1", "N2", "N3"}));
+    controller->removeArtifact("N3");
+    EXPECT_EQ(ids(controller->nearestArtifacts(forum, 2)), QStringList({"N1", "N2"}));
+    controller->undo();
+    controller->undo();
+    EXPECT_EQ(ids(controller->nearestArtifacts(forum, 10, 100.0)), QStringList({"N1", "N3"}));
+    EXPECT_EQ(ids(controller->filterArtifacts(std::make_unique<BoundingBoxFilter>(GeoBox(35.0, 20.0, 40.0, 25.0)))),
+              QStringList({"N2"}));
+}
+
+TEST_F(ControllerTest, TestNearDuplicates) {
+    // Shingles are words and word pairs, so reordering keeps the words but loses the pairs
+    const auto sword = MinHashIndex::shingles("Bronze sword, ceremonial");
+    EXPECT_EQ(sword.size(), 5u);
+    EXPECT_EQ(MinHashIndex::shingles("BRONZE  Sword ceremonial"), sword);
+    EXPECT_DOUBLE_EQ(MinHashIndex::jaccard(sword, MinHashIndex::shingles("ceremonial bronze sword")), 4.0 / 6.0);
+    EXPECT_TRUE(MinHashIndex::shingles(" -- ").empty());
+    
+    // Over many documents, the verified pairs are exactly the brute-force ones the bands find,
+    // and the bands find nearly all of them
+    const char* words[] = {"bronze", "iron", "clay", "sword", "spear", "pot", "rim", "handle", "layer", "north",
+                           "south", "trench", "burnt", "painted", "broken", "fragment", "decorated", "votive"};
+    quint32 seed = 7;
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 8) & 0xFFFF; };
+    std::vector<QString> texts;
+    for (int i = 0; i < 300; ++i) {
+        QStringList text;
+        if (i % 3 == 2) { // A copy of the previous text with one word changed
+            text = texts.back().split(' ');
+            text[static_cast<qsizetype>(next() % text.size())] = words[next() % 18];
+        } else {
+            for (int w = 0; w < 12; ++w) {
+                text << words[next() % 18];
+            }
+        }
+        texts.push_back(text.join(' '));
+        controller->addArtifact(QString("D%1").arg(i), "Find", texts.back(), "Bronze", QDate(2000, 1, 1), "Rome");
+    }
+    size_t expected = 0;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        for (size_t j = i + 1; j < texts.size(); ++j) {
+            expected += MinHashIndex::jaccard(MinHashIndex::shingles("Find " + texts[i]),
+                                              MinHashIndex::shingles("Find " + texts[j])) >= 0.6;
+        }
+    }
+    NearDuplicateReport report = controller->findNearDuplicates(0.6);
+    EXPECT_EQ(report.comparedArtifacts, 300u);
+    EXPECT_LT(report.candidatePairs, 300u * 299u / 20u);
+    EXPECT_LE(report.pairs.size(), expected);
+    EXPECT_GE(report.pairs.size() * 10, expected * 9);
+    for (const NearDuplicatePair& pair : report.pairs) {
+        EXPECT_GE(pair.similarity, 0.6);
+    }
+    
+    // The signatures follow every change
+    for (int i = 0; i < 300; ++i) {
+        controller->removeArtifact(QString("D%1").arg(i));
+    }
+    EXPECT_TRUE(controller->findNearDuplicates().pairs.empty());
+    controller->addArtifact("A1", "Bronze sword", "Ceremonial bronze sword found in the north trench", "Bronze", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("A2", "Clay pot", "Painted clay pot with a broken rim", "Clay", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("A3", "Bronze sword", "Ceremonial bronze sword found in the north trench, layer", "Bronze", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("A4", "Sword, bronze", "Ceremonial bronze sword found in the north trench", "Bronze", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("A5", "Clay pot", "Unpainted clay pot", "Clay", QDate(2000, 1, 1), "Rome");
+    report = controller->findNearDuplicates();
+    EXPECT_EQ(report.groups, std::vector<QStringList>({QStringList({"A1", "A3", "A4"})}));
+    ASSERT_EQ(report.pairs.size(), 2u); // A3 and A4 differ too much from each other
+    EXPECT_EQ(report.pairs[0].secondId, "A3");
+    EXPECT_NEAR(report.pairs[0].similarity, 16.0 / 18.0, 1e-9);
+    EXPECT_TRUE(report.toText().contains("A1 ~ A4  83%"));
+    controller->updateArtifact("A5", "A5", "Clay pot", "Painted clay pot with a broken rim", "Clay", QDate(2000, 1, 1), "Rome");
+    controller->updateArtifact("A4", "A4", "Spear", "Iron spear head", "Iron", QDate(2000, 1, 1), "Rome");
+    report = controller->findNearDuplicates();
+    EXPECT_EQ(report.groups, std::vector<QStringList>({QStringList({"A1", "A3"}), QStringList({"A2", "A5"})}));
+    controller->undo();
+    EXPECT_EQ(controller->findNearDuplicates().groups.front(), QStringList({"A1", "A3", "A4"}));
+    ArtifactTable fresh; // Built in one go rather than kept current
+    fresh.rebuild(controller->getAllArtifacts());
+    EXPECT_EQ(DuplicateDetector(fresh).detect().groups, controller->findNearDuplicates().groups);
+    EXPECT_THROW(controller->findNearDuplicates(0.0), std::invalid_argument);
+    EXPECT_THROW(controller->findNearDuplicates(1.5), std::invalid_argument);
+}
+
+TEST_F(ControllerTest, TestHistoryBudget) {
+    EXPECT_EQ(controller->historyEntryLimit(), ArtifactController::DefaultHistoryEntries);
+    EXPECT_EQ(controller->historyMemoryLimit(), ArtifactController::DefaultHistoryBytes);
+    EXPECT_EQ(controller->historyMemoryUsage(), 0u);
+    
+    // An update keeps only the fields it changed, while a removal keeps the whole artifact
+    const QString longText = QString("Layer of burnt clay and charcoal. ").repeated(200);
+    controller->addArtifact("H1", "Hearth", longText, "Clay", QDate(2001, 5, 4), "Trench 1", GeoPoint(41.9, 12.5));
+    const size_t afterAdd = controller->historyMemoryUsage();
+    EXPECT_GT(afterAdd, static_cast<size_t>(longText.size()) * sizeof(QChar));
+    controller->updateArtifact("H1", "H1", "Hearth", longText, "Fired clay", QDate(2001, 5, 4), "Trench 1", GeoPoint(41.8, 12.5));
+    const size_t updateBytes = controller->historyMemoryUsage() - afterAdd;
+    EXPECT_LT(updateBytes, 1024u);
+    controller->undo();
+    ArcheologicalArtifact hearth = controller->getArtifactById("H1");
+    EXPECT_EQ(hearth.getMaterial(), "Clay");
+    EXPECT_EQ(hearth.getCoordinates(), GeoPoint(41.9, 12.5));
+    EXPECT_EQ(hearth.getDescription(), longText);
+    controller->redo();
+    hearth = controller->getArtifactById("H1");
+    EXPECT_EQ(hearth.getMaterial(), "Fired clay");
+    EXPECT_EQ(hearth.getCoordinates(), GeoPoint(41.8, 12.5));
+    EXPECT_EQ(controller->historyMemoryUsage(), afterAdd + updateBytes); // Moving commands costs nothing
+    controller->removeArtifact("H1");
+    EXPECT_GT(controller->historyMemoryUsage() - afterAdd - updateBytes, static_cast<size_t>(longText.size()) * sizeof(QChar));
+    
+    // An entry limit drops the oldest commands first
+    controller->clearHistory();
+    EXPECT_EQ(controller->historyMemoryUsage(), 0u);
+    controller->setHistoryLimits(3, 0);
+    for (int i = 0; i < 5; ++i) {
+        controller->addArtifact(QString("E%1").arg(i), "Find", "", "Bronze", QDate(2000, 1, 1), "Rome");
+    }
+    EXPECT_EQ(controller->historySize(), 3u);
+    while (controller->canUndo()) {
+        controller->undo();
+    }
+    EXPECT_EQ(controller->getAllArtifacts().size(), 2u); // E0 and E1 can no longer be undone
+    
+    // A byte limit does the same, but always keeps the last command
+    controller->clearHistory();
+    controller->setHistoryLimits(0, 1);
+    controller->removeArtifact("E0");
+    controller->removeArtifact("E1");
+    EXPECT_EQ(controller->historySize(), 1u);
+    EXPECT_GT(controller->historyMemoryUsage(), 1u);
+    controller->undo();
+    EXPECT_FALSE(controller->canUndo());
+    EXPECT_EQ(controller->getArtifactById("E1").getName(), "Find");
+    EXPECT_THROW(controller->getArtifactById("E0"), std::runtime_error);
+    
+    // Lowering the limits trims the history at once, redo steps included
+    controller->setHistoryLimits(0, 0);
+    controller->redo();
+    controller->addArtifact("E5", "Find", "", "Bronze", QDate(2000, 1, 1), "Rome");
+    controller->addArtifact("E6", "Find", "", "Bronze", QDate(2000, 1, 1), "Rome");
+    controller->undo();
+    EXPECT_EQ(controller->historySize(), 3u);
+    controller->setHistoryLimits(1, 0);
+    EXPECT_EQ(controller->historySize(), 1u);
+    EXPECT_TRUE(controller->canUndo());
+    EXPECT_FALSE(controller->canRedo());
+}